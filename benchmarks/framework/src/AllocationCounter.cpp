@@ -0,0 +1,66 @@
+///
+/// @file AllocationCounter.cpp
+///
+/// Implementation of the counter of heap allocations.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.h"
+
+namespace {
+
+/// Number of calls to operator new.
+std::atomic<uint64_t> allocations{ 0 };
+
+} // namespace
+
+// Replacement of the global allocation function.
+void* operator new(
+	std::size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* result = std::malloc(size == 0 ? 1 : size);
+
+	if (result == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return result;
+}
+
+// Replacement of the global deallocation function.
+void operator delete(
+	void* block) noexcept
+{
+	std::free(block);
+}
+
+// Replacement of the global sized deallocation function.
+void operator delete(
+	void*       block,
+	std::size_t size) noexcept
+{
+	(void) size; // Unused parameter.
+
+	std::free(block);
+}
+
+namespace synapse {
+namespace framework {
+
+// Get the number of heap allocations performed by the process.
+uint64_t allocationCount()
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,25 @@
+///
+/// @file AllocationCounter.h
+///
+/// Declaration of the counter of heap allocations.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <cstdint>
+
+namespace synapse {
+namespace framework {
+
+/// Get the number of heap allocations performed by the process.
+///
+/// The global operator new of the benchmark executable is replaced to count
+/// the allocations.
+///
+/// @return The number of calls to operator new since the start of the process.
+uint64_t allocationCount();
+
+} // namespace framework
+} // namespace synapse
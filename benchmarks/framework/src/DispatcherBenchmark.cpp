@@ -0,0 +1,182 @@
+///
+/// @file DispatcherBenchmark.cpp
+///
+/// Benchmark of the scaling of the dispatchers with their number of threads.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Dispatcher.h>
+#include <synapse/framework/IConsumer.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+/// Number of source ports (each one fed by its own thread).
+constexpr size_t PORT_COUNT{ 16 };
+
+/// Number of messages issued by a port during a measure.
+constexpr size_t MESSAGE_COUNT{ 20000 };
+
+/// Number of passes over the payload performed by the consumer for a message.
+constexpr size_t WORK_ROUNDS{ 16 };
+
+/// A typical NMEA 0183 sentence.
+const std::string SENTENCE("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+
+///
+/// Consumer that spends some time on each message (like a parsing fiber) and
+/// checks that the messages of a port are received in order.
+///
+class WorkConsumer :
+	public IConsumer
+{
+public:
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		uint8_t checksum{ 0 };
+
+		for (size_t round = 0; round < WORK_ROUNDS; ++round)
+		{
+			for (size_t index = 0; index < message->size(); ++index)
+			{
+				checksum = static_cast<uint8_t>((checksum << 1) ^ message->payload()[index]);
+			}
+		}
+		_checksum.fetch_xor(checksum, std::memory_order_relaxed);
+
+		// The messages of a port are consumed by a single worker.
+		auto& last = _sequences[message->metadata().origin - 1];
+
+		if (message->metadata().sequence != last + 1)
+		{
+			_disordered.fetch_add(1, std::memory_order_relaxed);
+		}
+		last = message->metadata().sequence;
+		_count.fetch_add(1, std::memory_order_release);
+	}
+
+	/// Get the number of messages consumed.
+	size_t count() const { return _count.load(std::memory_order_acquire); }
+
+	/// Get the number of messages consumed out of order.
+	size_t disordered() const { return _disordered.load(std::memory_order_relaxed); }
+
+private:
+
+	std::atomic<size_t>   _count{ 0 };
+	std::atomic<size_t>   _disordered{ 0 };
+	std::atomic<uint8_t>  _checksum{ 0 };
+	std::vector<uint32_t> _sequences = std::vector<uint32_t>(PORT_COUNT, 0);
+};
+
+/// Measure the throughput of a dispatcher.
+///
+/// @param threadCount The number of threads of the dispatcher.
+///
+/// @return The throughput (thousands of messages per second).
+double measure(
+	size_t threadCount)
+{
+	Dispatcher                       dispatcher("benchmark", threadCount);
+	WorkConsumer                     consumer;
+	std::list<std::unique_ptr<Port>> ports;
+	std::list<Port*>                 sources;
+
+	for (size_t index = 0; index < PORT_COUNT; ++index)
+	{
+		auto& port = ports.emplace_back(std::make_unique<Port>(fmt::format("port-{}", index), nullptr, static_cast<uint32_t>(index + 1)));
+
+		sources.push_back(port.get());
+	}
+
+	Route route(sources, { &consumer }, &dispatcher);
+
+	for (auto& port : ports)
+	{
+		port->attach(&route);
+	}
+
+	std::thread runner([&dispatcher] { dispatcher.run(); });
+	auto        start = std::chrono::steady_clock::now();
+
+	// Each port is fed by its own thread.
+	std::vector<std::thread> producers;
+
+	for (auto& port : ports)
+	{
+		producers.emplace_back([&port] {
+			for (size_t index = 0; index < MESSAGE_COUNT; ++index)
+			{
+				port->dispatch(Message::create(SENTENCE.size(), reinterpret_cast<const uint8_t*>(SENTENCE.data())));
+			}
+		});
+	}
+	for (auto& producer : producers)
+	{
+		producer.join();
+	}
+	while (consumer.count() < PORT_COUNT * MESSAGE_COUNT)
+	{
+		std::this_thread::yield();
+	}
+
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	dispatcher.shutdown();
+	runner.join();
+
+	EXPECT_EQ(consumer.disordered(), 0);
+
+	return static_cast<double>(PORT_COUNT * MESSAGE_COUNT) / elapsed / 1e3;
+}
+
+} // namespace
+
+TEST(DispatcherBenchmark, scaling)
+{
+	size_t maxThreadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+	fmt::print("{:>7} {:>16} {:>8}\n", "threads", "messages (k/s)", "speedup");
+
+	double reference = 0.0;
+
+	// Powers of two up to the number of cores, then the number of cores.
+	for (size_t threadCount = 1; threadCount <= maxThreadCount;
+		 threadCount = threadCount == maxThreadCount ? threadCount + 1 : std::min(threadCount * 2, maxThreadCount))
+	{
+		auto throughput = measure(threadCount);
+
+		if (threadCount == 1)
+		{
+			reference = throughput;
+		}
+
+		fmt::print("{:>7} {:>16.1f} {:>8.2f}\n", threadCount, throughput, throughput / reference);
+	}
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,244 @@
+///
+/// @file MessageBenchmark.cpp
+///
+/// Benchmark of the allocation and the sharing of messages.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Message.h>
+#include <synapse/framework/MessagePtr.h>
+
+#include "AllocationCounter.h"
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+/// Number of frames processed by a measure.
+constexpr size_t FRAME_COUNT{ 200000 };
+
+/// Number of copies of the message handle on the path of a frame (port,
+/// route, dispatcher request, sink queue).
+constexpr size_t HOP_COUNT{ 4 };
+
+/// A typical NMEA 0183 sentence.
+const std::string SENTENCE("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+
+/// The sentences received in one second from a typical sailing boat.
+const std::vector<std::string> SENTENCES = {
+	"$SDDBT,38.0,f,11.6,M,06.3,F*3E\r\n",
+	"$SDDPT,11.6,-1.0,99.0*7F\r\n",
+	"$HCHDG,331.3,00.0,E,00.0,E*40\r\n",
+	"$WIMWV,025.0,R,016.3,N,A*20\r\n",
+	"$VWVHW,129.0,T,129.0,M,07.7,N,14.3,K*52\r\n",
+	"$GPRMC,164517.59,A,4601.47709,N,00114.10553,W,0008.9,303.6,160316,0.0,W,A*05\r\n",
+	"$GPGGA,164517.59,4601.47709,N,00114.10553,W,1,05,0.0,5,M,50.0,M,,*61\r\n",
+	"$GPGSA,A,3,02,03,14,23,31,,,,,,,,5.5,0.0,6.7*34\r\n",
+	"$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n",
+	"!AIVDM,1,1,,A,18vAfjo1hvwqN6PJHD8jHQrT050l,0*08\r\n",
+	"!AIVDM,2,1,3,B,55P5TL01VIaAL@7WKO@mBplU@<PDhh000000001S;AJ::4A80?4i@E53,0*3E\r\n"
+};
+
+/// Number of sentences held by the queue of a sink before being processed.
+constexpr size_t QUEUE_DEPTH{ 256 };
+
+/// Number of times the mix of sentences is received by a measure.
+constexpr size_t ROUND_COUNT{ 20000 };
+
+/// Result of a measure.
+struct Measure
+{
+	/// Number of heap allocations per frame.
+	double allocations;
+
+	/// Duration per frame (nanoseconds).
+	double duration;
+};
+
+/// Measure the cost of creating a frame and forwarding it along a route.
+///
+/// @param create The function that creates a message handle.
+///
+/// @return The result of the measure.
+template <typename Handle, typename Create>
+Measure measure(
+	Create create)
+{
+	std::vector<Handle> queue;
+
+	queue.reserve(HOP_COUNT);
+
+	// Warm up the pool of messages.
+	for (size_t index = 0; index < 1000; ++index)
+	{
+		queue.push_back(create());
+		queue.clear();
+	}
+
+	auto allocations = allocationCount();
+	auto start       = std::chrono::steady_clock::now();
+
+	for (size_t frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		auto message = create();
+
+		for (size_t hop = 0; hop < HOP_COUNT; ++hop)
+		{
+			queue.push_back(message);
+		}
+		queue.clear();
+	}
+
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	return {
+		static_cast<double>(allocationCount() - allocations) / FRAME_COUNT,
+		static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / FRAME_COUNT
+	};
+}
+
+/// Measure the cost of framing the sentences received by a source and
+/// processing them in a sink.
+///
+/// @tparam Handle The type of the handle of the messages.
+/// @param frame The function that creates the message of a sentence from the
+/// message received by the source.
+///
+/// @return The result of the measure (per sentence).
+template <typename Handle, typename Frame>
+Measure measureMix(
+	Frame frame)
+{
+	std::string                            stream;
+	std::vector<std::pair<size_t, size_t>> ranges;
+
+	for (const auto& current : SENTENCES)
+	{
+		ranges.emplace_back(stream.size(), current.size());
+		stream += current;
+	}
+
+	std::vector<Handle> queue;
+	uint8_t             checksum{ 0 };
+
+	queue.reserve(QUEUE_DEPTH);
+
+	// Process the sentences queued in the sink.
+	auto process = [&queue, &checksum] {
+		for (const auto& message : queue)
+		{
+			for (size_t index = 0; index < message->size(); ++index)
+			{
+				checksum ^= message->payload()[index];
+			}
+		}
+		queue.clear();
+	};
+
+	// Receive the sentences several times.
+	auto receive = [&](size_t count) {
+		for (size_t round = 0; round < count; ++round)
+		{
+			auto received = Message::create(stream.size(), reinterpret_cast<const uint8_t*>(stream.data()));
+
+			for (const auto& [offset, size] : ranges)
+			{
+				queue.push_back(frame(received, offset, size));
+
+				if (queue.size() == QUEUE_DEPTH)
+				{
+					process();
+				}
+			}
+		}
+		process();
+	};
+
+	// Warm up the pool of messages.
+	receive(QUEUE_DEPTH);
+
+	auto allocations = allocationCount();
+	auto start       = std::chrono::steady_clock::now();
+
+	receive(ROUND_COUNT);
+
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	auto count   = ROUND_COUNT * SENTENCES.size();
+
+	// The payloads are read so that the measure includes the access to the
+	// content, each round contributes the same value to the checksum.
+	EXPECT_EQ(checksum, 0);
+
+	return {
+		static_cast<double>(allocationCount() - allocations) / count,
+		static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / count
+	};
+}
+
+} // namespace
+
+TEST(MessageBenchmark, allocationsPerFrame)
+{
+	auto payload = reinterpret_cast<const uint8_t*>(SENTENCE.data());
+
+	// The engine is multi-threaded, make sure that the reference counters of
+	// std::shared_ptr are not optimized for a single-threaded process.
+	std::thread([] {}).join();
+
+	auto legacy = measure<std::shared_ptr<Message>>([payload] {
+		return std::make_shared<Message>(SENTENCE.size(), payload);
+	});
+	auto intrusive = measure<MessagePtr>([payload] {
+		return Message::create(SENTENCE.size(), payload);
+	});
+
+	fmt::print("std::shared_ptr<Message>: {:.2f} allocations/frame, {:.1f} ns/frame\n", legacy.allocations, legacy.duration);
+	fmt::print("MessagePtr:               {:.2f} allocations/frame, {:.1f} ns/frame\n", intrusive.allocations, intrusive.duration);
+
+	// Header, reference counter and payload are stored in a single block of the pool.
+	EXPECT_EQ(intrusive.allocations, 0.0);
+	EXPECT_LT(intrusive.allocations, legacy.allocations);
+}
+
+TEST(MessageBenchmark, sentenceMix)
+{
+	std::thread([] {}).join();
+
+	auto legacy = measureMix<std::shared_ptr<Message>>([](const MessagePtr& received, size_t offset, size_t size) {
+		return std::make_shared<Message>(size, received->payload() + offset);
+	});
+	auto inlined = measureMix<MessagePtr>([](const MessagePtr& received, size_t offset, size_t size) {
+		return Message::create(size, received->payload() + offset);
+	});
+	auto sliced = measureMix<MessagePtr>([](const MessagePtr& received, size_t offset, size_t size) {
+		return Message::slice(received, offset, size);
+	});
+
+	fmt::print("sizeof(Message): {} bytes\n", sizeof(Message));
+	fmt::print("std::shared_ptr<Message>:       {:.2f} allocations/sentence, {:.1f} ns/sentence\n", legacy.allocations, legacy.duration);
+	fmt::print("Payloads with the header:       {:.2f} allocations/sentence, {:.1f} ns/sentence\n", inlined.allocations, inlined.duration);
+	fmt::print("Slices of the received message: {:.2f} allocations/sentence, {:.1f} ns/sentence\n", sliced.allocations, sliced.duration);
+
+	// A sentence stored with its header takes a single block of the pool, the
+	// previous layout allocates the object with its control block and takes
+	// a separate block for the payload.
+	EXPECT_EQ(inlined.allocations, 0.0);
+	EXPECT_LT(inlined.allocations, legacy.allocations);
+	EXPECT_LT(inlined.duration, legacy.duration);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,169 @@
+///
+/// @file MpscRingBenchmark.cpp
+///
+/// Benchmark of the queue of requests of the dispatchers under contention.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Dispatcher.h>
+#include <synapse/framework/MpscRing.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+/// Number of elements transferred by a measure.
+constexpr size_t ELEMENT_COUNT{ 400000 };
+
+///
+/// Queue protected by a mutex (previous implementation of the dispatcher).
+///
+class LockedQueue
+{
+public:
+
+	/// Add an element to the queue.
+	///
+	/// @param value The element to add.
+	void push(
+		size_t value)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_elements.push_back(value);
+		}
+		_cv.notify_one();
+	}
+
+	/// Remove the oldest element of the queue, wait if the queue is empty.
+	///
+	/// @return The removed element.
+	size_t pop()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_cv.wait(lock, [this] { return !_elements.empty(); });
+
+		auto result = _elements.front();
+		_elements.pop_front();
+
+		return result;
+	}
+
+private:
+
+	std::mutex              _mutex;
+	std::condition_variable _cv;
+	std::list<size_t>       _elements;
+};
+
+///
+/// Adapter of the ring to the interface of the locked queue.
+///
+class RingQueue
+{
+public:
+
+	/// Add an element to the queue.
+	///
+	/// @param value The element to add.
+	void push(
+		size_t value)
+	{
+		_ring.push(std::move(value));
+	}
+
+	/// Remove the oldest element of the queue, wait if the queue is empty.
+	///
+	/// @return The removed element.
+	size_t pop()
+	{
+		size_t result = 0;
+
+		while (!_ring.tryPop(result))
+		{
+			_ring.wait();
+		}
+
+		return result;
+	}
+
+private:
+
+	MpscRing<size_t> _ring{ Dispatcher::DEFAULT_CAPACITY };
+};
+
+/// Measure the throughput of a queue with several producers and one consumer.
+///
+/// @param producerCount The number of producer threads.
+///
+/// @return The throughput (millions of elements per second).
+template <typename Queue>
+double measure(
+	size_t producerCount)
+{
+	Queue                    queue;
+	std::vector<std::thread> producers;
+	size_t                   sum   = 0;
+	auto                     start = std::chrono::steady_clock::now();
+
+	for (size_t producer = 0; producer < producerCount; ++producer)
+	{
+		producers.emplace_back([&queue, producerCount] {
+			for (size_t index = 0; index < ELEMENT_COUNT / producerCount; ++index)
+			{
+				queue.push(index);
+			}
+		});
+	}
+
+	for (size_t index = 0; index < (ELEMENT_COUNT / producerCount) * producerCount; ++index)
+	{
+		sum += queue.pop();
+	}
+
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (auto& producer : producers)
+	{
+		producer.join();
+	}
+
+	// Each producer pushes the same sequence of values.
+	auto count = ELEMENT_COUNT / producerCount;
+
+	EXPECT_EQ(sum, producerCount * count * (count - 1) / 2);
+
+	return static_cast<double>(count * producerCount) / elapsed / 1e6;
+}
+
+} // namespace
+
+TEST(MpscRingBenchmark, contention)
+{
+	fmt::print("{:>9} {:>16} {:>16}\n", "producers", "mutex (M/s)", "ring (M/s)");
+
+	for (size_t producerCount : { 1, 2, 4, 8, 16 })
+	{
+		auto locked = measure<LockedQueue>(producerCount);
+		auto ring   = measure<RingQueue>(producerCount);
+
+		fmt::print("{:>9} {:>16.2f} {:>16.2f}\n", producerCount, locked, ring);
+	}
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,205 @@
+///
+/// @file StartupBenchmark.cpp
+///
+/// Benchmark of the scaling of the startup of the manager with the number of
+/// blocks.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <chrono>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+#include <synapse/framework/BaseBlock.h>
+#include <synapse/framework/Fiber.h>
+#include <synapse/framework/IConsumer.h>
+#include <synapse/framework/IManager.h>
+#include <synapse/framework/Manager.h>
+#include <synapse/framework/Source.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+/// Maximum ratio of the cost of a block in the configuration of 50k blocks to
+/// its cost in the one of 10k blocks (a quadratic startup gives 5).
+constexpr double MAX_COST_RATIO{ 2.0 };
+
+///
+/// Source that only declares its port (like a TCP source).
+///
+class SensorSource :
+	public Source
+{
+public:
+
+	SensorSource(
+		const std::string& name)
+		: Source(name) { }
+
+	void initialize(
+		const ConfigData& configData,
+		IManager*         manager) override
+	{
+		Source::initialize(configData, manager);
+		_port = manager->find(this, "default");
+	}
+
+	void shutdown() override { }
+
+	std::list<std::string> ports(const IBlock::ConfigData&) override { return { "default" }; }
+
+	void run() override { }
+
+private:
+
+	IPort* _port{ nullptr };
+};
+
+///
+/// Fiber that only declares its port (like a framer).
+///
+class SensorFramer :
+	public Fiber
+{
+public:
+
+	SensorFramer(
+		const std::string& name)
+		: Fiber(name) { }
+
+	void initialize(
+		const ConfigData& configData,
+		IManager*         manager) override
+	{
+		Fiber::initialize(configData, manager);
+		_port = manager->find(this, "default");
+	}
+
+	void shutdown() override { }
+
+	std::list<std::string> ports(const IBlock::ConfigData&) override { return { "default" }; }
+
+	void consume(
+		const MessagePtr&) override { }
+
+private:
+
+	IPort* _port{ nullptr };
+};
+
+///
+/// Consumer that drops the messages (like a logger).
+///
+class SensorLogger :
+	public BaseBlock,
+	public IConsumer
+{
+public:
+
+	SensorLogger(
+		const std::string& name)
+		: BaseBlock(name) { }
+
+	void shutdown() override { }
+
+	void consume(
+		const MessagePtr&) override { }
+};
+
+/// Generate a configuration with a source, a framer and a logger per sensor.
+///
+/// @param sensors The number of sensors.
+///
+/// @return The configuration.
+Manager::ConfigData generate(
+	size_t sensors)
+{
+	Manager::ConfigData config;
+
+	config["blocks"] = Manager::ConfigData::array();
+	config["routes"] = Manager::ConfigData::array();
+
+	for (size_t index = 0; index < sensors; ++index)
+	{
+		auto source = fmt::format("source-{}", index);
+		auto framer = fmt::format("framer-{}", index);
+		auto logger = fmt::format("logger-{}", index);
+
+		config["blocks"].push_back({ { "name", source }, { "className", "benchmark::SensorSource" }, { "config", { { "port", 10000 + index } } } });
+		config["blocks"].push_back({ { "name", framer }, { "className", "benchmark::SensorFramer" }, { "config", Manager::ConfigData::object() } });
+		config["blocks"].push_back({ { "name", logger }, { "className", "benchmark::SensorLogger" }, { "config", Manager::ConfigData::object() } });
+		config["routes"].push_back({ { "sources", { source + ".default" } }, { "destinations", { framer } } });
+		config["routes"].push_back({ { "sources", { framer } }, { "destinations", { logger } } });
+	}
+
+	return config;
+}
+
+/// Measure the startup of a configuration.
+///
+/// @param sensors The number of sensors.
+///
+/// @return The duration of the startup per block (microseconds).
+double measure(
+	size_t sensors)
+{
+	auto    config = generate(sensors);
+	Manager manager;
+
+	manager.registry().registerDescription({ "benchmark::SensorSource", [](const std::string& name) -> IBlock* { return new SensorSource(name); } });
+	manager.registry().registerDescription({ "benchmark::SensorFramer", [](const std::string& name) -> IBlock* { return new SensorFramer(name); } });
+	manager.registry().registerDescription({ "benchmark::SensorLogger", [](const std::string& name) -> IBlock* { return new SensorLogger(name); } });
+
+	auto start = std::chrono::steady_clock::now();
+
+	manager.initialize(config);
+
+	auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	// The manager destroys the blocks at the end of run() only: destroy them
+	// here so that they do not weigh on the next measures.
+	for (auto& block : config["blocks"])
+	{
+		manager.find(block["name"].get<std::string>())->destroy();
+	}
+
+	return elapsed / static_cast<double>(3 * sensors);
+}
+
+} // namespace
+
+TEST(StartupBenchmark, scaling)
+{
+	// The plan of the routes is not logged.
+	auto level = spdlog::get_level();
+
+	spdlog::set_level(spdlog::level::warn);
+
+	fmt::print("{:>7} {:>16}\n", "blocks", "per block (us)");
+
+	// A small configuration warms the allocators up, then the configurations
+	// of 10k and 50k blocks are compared.
+	std::vector<double> costs;
+
+	for (size_t sensors : { 1000, 10000 / 3, 50000 / 3 })
+	{
+		costs.push_back(measure(sensors));
+		fmt::print("{:>7} {:>16.2f}\n", 3 * sensors, costs.back());
+	}
+	spdlog::set_level(level);
+
+	// The cost of a block does not grow with the size of the configuration.
+	EXPECT_LT(costs[2] / costs[1], MAX_COST_RATIO);
+}
+
+} // namespace framework
+} // namespace synapse
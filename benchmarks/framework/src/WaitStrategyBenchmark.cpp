@@ -0,0 +1,225 @@
+///
+/// @file WaitStrategyBenchmark.cpp
+///
+/// Benchmark of the latency of the dispatchers and the sinks with the
+/// different wait strategies.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Dispatcher.h>
+#include <synapse/framework/IConsumer.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+#include <synapse/framework/Sink.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+/// Number of messages sent during a measure.
+constexpr size_t MESSAGE_COUNT{ 5000 };
+
+/// Time between two messages (the consumer is idle when a message arrives).
+constexpr std::chrono::microseconds GAP{ 50 };
+
+/// Get the current time.
+///
+/// @return The number of nanoseconds of the steady clock.
+int64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Create a message that holds the time it was sent.
+///
+/// @return The message.
+MessagePtr stamped()
+{
+	auto time = now();
+
+	return Message::create(sizeof(time), reinterpret_cast<const uint8_t*>(&time));
+}
+
+///
+/// Records the latency of the messages it receives.
+///
+class LatencyRecorder
+{
+public:
+
+	/// Record the latency of a message.
+	///
+	/// @param message[in] The message received.
+	void record(
+		const MessagePtr& message)
+	{
+		int64_t sent;
+
+		std::memcpy(&sent, message->payload(), sizeof(sent));
+		_latencies.push_back(now() - sent);
+		_count.store(_latencies.size(), std::memory_order_release);
+	}
+
+	/// Get the number of messages received.
+	size_t count() const { return _count.load(std::memory_order_acquire); }
+
+	/// Get a percentile of the latencies.
+	///
+	/// @param percent The percentile.
+	///
+	/// @return The latency (microseconds).
+	double percentile(
+		double percent)
+	{
+		std::sort(_latencies.begin(), _latencies.end());
+
+		return static_cast<double>(_latencies[static_cast<size_t>(percent / 100.0 * static_cast<double>(_latencies.size() - 1))]) / 1e3;
+	}
+
+private:
+
+	std::vector<int64_t> _latencies;
+	std::atomic<size_t>  _count{ 0 };
+};
+
+///
+/// Consumer that records the latency of the messages.
+///
+class LatencyConsumer :
+	public IConsumer,
+	public LatencyRecorder
+{
+public:
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override { record(message); }
+};
+
+///
+/// Sink that records the latency of the messages.
+///
+class LatencySink :
+	public Sink,
+	public LatencyRecorder
+{
+public:
+
+	/// Constructor.
+	LatencySink()
+		: Sink("benchmark")
+	{
+	}
+
+protected:
+
+	/// Process a message in the context of the runnable.
+	///
+	/// @param message[in] Message to be processed.
+	void process(
+		const MessagePtr& message) override { record(message); }
+};
+
+/// Send stamped messages one at a time, waiting for each to be received.
+///
+/// @param send The function that sends a message.
+/// @param recorder The recorder of the latencies.
+template <typename Send>
+void feed(
+	Send&&           send,
+	LatencyRecorder& recorder)
+{
+	for (size_t index = 0; index < MESSAGE_COUNT; ++index)
+	{
+		std::this_thread::sleep_for(GAP);
+		send(stamped());
+		while (recorder.count() <= index)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/// Print the latencies measured with a wait strategy.
+///
+/// @param name The name of the strategy.
+/// @param recorder The recorder of the latencies.
+void print(
+	const std::string& name,
+	LatencyRecorder&   recorder)
+{
+	fmt::print("{:>15} {:>10.1f} {:>10.1f} {:>10.1f}\n", name, recorder.percentile(50), recorder.percentile(99), recorder.percentile(99.9));
+}
+
+/// The strategies to compare.
+const std::vector<std::pair<std::string, WaitStrategy>> STRATEGIES{
+	{ "block", { WaitMode::block } },
+	{ "spin-then-park", { WaitMode::spinThenPark } },
+	{ "busy-poll", { WaitMode::busyPoll } },
+};
+
+} // namespace
+
+TEST(WaitStrategyBenchmark, dispatcher)
+{
+	fmt::print("{:>15} {:>10} {:>10} {:>10}\n", "strategy", "p50 (us)", "p99 (us)", "p99.9 (us)");
+
+	for (auto& [name, strategy] : STRATEGIES)
+	{
+		Dispatcher      dispatcher("benchmark");
+		LatencyConsumer consumer;
+		Port            port("port", nullptr, 1);
+		Route           route({ &port }, { &consumer }, &dispatcher);
+
+		port.attach(&route);
+		dispatcher.setWaitStrategy(strategy);
+
+		std::thread runner([&dispatcher] { dispatcher.run(); });
+
+		feed([&port](const MessagePtr& message) { port.dispatch(message); }, consumer);
+		dispatcher.shutdown();
+		runner.join();
+
+		print(name, consumer);
+	}
+}
+
+TEST(WaitStrategyBenchmark, sink)
+{
+	fmt::print("{:>15} {:>10} {:>10} {:>10}\n", "strategy", "p50 (us)", "p99 (us)", "p99.9 (us)");
+
+	for (auto& [name, strategy] : STRATEGIES)
+	{
+		LatencySink sink;
+
+		sink.setWaitStrategy(strategy);
+
+		std::thread runner([&sink] { sink.run(); });
+
+		feed([&sink](const MessagePtr& message) { sink.consume(message); }, sink);
+		sink.shutdown();
+		runner.join();
+
+		print(name, sink);
+	}
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,54 @@
+# ------------------------------------------------------------------------------
+# Manifest of a module
+# ------------------------------------------------------------------------------
+#
+# synapse_module_manifest(<target> <source>)
+#
+# Generate the manifest of a module next to its library: the list of the block
+# classes registered by the entry point of the module, read from <source>
+# (the calls 'registry.registerDescription(<class>::description())'). The
+# manager reads the manifests and only loads the modules that implement the
+# classes used by the configuration.
+
+function(synapse_module_manifest target source)
+	get_filename_component(source ${source} ABSOLUTE)
+
+	# Generate the manifest again when the entry point changes.
+	set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${source})
+
+	file(STRINGS ${source} lines REGEX "registerDescription")
+
+	set(blocks "")
+	foreach(line IN LISTS lines)
+		if(line MATCHES "registerDescription\\(([A-Za-z0-9_:]+)::description\\(\\)\\)")
+			list(APPEND blocks "\"${CMAKE_MATCH_1}\"")
+		endif()
+	endforeach()
+
+	# A manifest without the classes of the module would prevent it from being
+	# loaded: the calls shall be written as expected.
+	if(lines AND NOT blocks)
+		message(FATAL_ERROR "${source}: no call 'registerDescription(<class>::description())' found, the manifest of ${target} cannot be generated")
+	endif()
+
+	if(blocks)
+		list(JOIN blocks ",\n\t\t" blocks)
+		set(blocks "[\n\t\t${blocks}\n\t]")
+	else()
+		set(blocks "[]")
+	endif()
+
+	# The extension of the library is replaced by '.blocks.json'.
+	set(manifest "$<TARGET_FILE_DIR:${target}>/$<TARGET_FILE_PREFIX:${target}>$<TARGET_FILE_BASE_NAME:${target}>.blocks.json")
+
+	file(GENERATE
+		OUTPUT  ${manifest}
+		CONTENT "{\n\t\"blocks\": ${blocks}\n}\n")
+
+	# The manifest is installed next to the library.
+	if(WIN32)
+		install(FILES ${manifest} DESTINATION ${CMAKE_INSTALL_BINDIR})
+	else()
+		install(FILES ${manifest} DESTINATION ${CMAKE_INSTALL_LIBDIR})
+	endif()
+endfunction()
@@ -0,0 +1,110 @@
+///
+/// @file BatchCounters.h
+///
+/// Declaration of the BatchCounters class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace synapse {
+namespace framework {
+
+///
+/// Distribution of the size of the batches processed by a runnable.
+///
+/// The batches are counted in buckets of power of two sizes: the bucket `i`
+/// counts the batches of `2^i` to `2^(i+1) - 1` elements, the last bucket
+/// also counts the larger batches.
+///
+/// The counters are only written by the thread of the runnable, they are
+/// atomic so that they can be read by statistics() from any thread.
+///
+class BatchCounters
+{
+	// Definitions
+
+public:
+
+	/// Number of buckets of the distribution.
+	static constexpr size_t BUCKET_COUNT{ 16 };
+
+	///
+	/// Snapshot of the counters.
+	///
+	struct Statistics
+	{
+		/// Number of batches processed.
+		uint64_t                              batches{ 0 };
+
+		/// Number of elements processed.
+		uint64_t                              elements{ 0 };
+
+		/// Number of batches for each bucket of sizes.
+		std::array<uint64_t, BUCKET_COUNT>    histogram{};
+
+		/// Add the counters of another snapshot.
+		///
+		/// @param other The counters to add.
+		///
+		/// @return Reference on this snapshot.
+		Statistics& operator+=(
+			const Statistics& other);
+
+		/// Get the average number of elements of a batch.
+		///
+		/// @return The average size of the batches, 0 if no batch.
+		double mean() const;
+
+		/// Format the distribution in a human readable form.
+		///
+		/// @return The non empty buckets, like `1:120 2-3:45 4-7:3`.
+		std::string toString() const;
+	};
+
+	// Operations
+
+public:
+
+	/// Count a batch (only called by the thread of the runnable).
+	///
+	/// @param size The number of elements of the batch (not counted if 0).
+	void record(
+		size_t size);
+
+	/// Get the counters.
+	///
+	/// @return A snapshot of the counters.
+	Statistics statistics() const;
+
+	/// Get the bucket of a batch size.
+	///
+	/// @param size The number of elements of the batch (at least 1).
+	///
+	/// @return The index of the bucket.
+	static size_t bucketIndex(
+		size_t size);
+
+	// Private attributes
+
+private:
+
+	/// Number of batches processed.
+	std::atomic<uint64_t>                           _batches{ 0 };
+
+	/// Number of elements processed.
+	std::atomic<uint64_t>                           _elements{ 0 };
+
+	/// Number of batches for each bucket of sizes.
+	std::array<std::atomic<uint64_t>, BUCKET_COUNT> _histogram{};
+};
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,293 @@
+///
+/// @file Coroutine.h
+///
+/// Declaration of the Coroutine and Completion classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "Executor.h"
+#include "ITask.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Coroutine executed by the threads of an executor.
+///
+/// The coroutine is created suspended and starts when start() is called. Each
+/// time it is resumed (after a co_await on an awaitable of the framework), it
+/// is submitted as a task to the executor, so that many coroutines can share
+/// the few threads of the executor.
+///
+/// The object owns the frame of the coroutine: it shall not be destroyed while
+/// the coroutine is running or can still be resumed.
+///
+class Coroutine
+{
+	// Definitions
+
+public:
+
+	///
+	/// Promise of the coroutine (required by the compiler).
+	///
+	struct promise_type :
+		public ITask
+	{
+		/// Create the object returned to the caller of the coroutine.
+		Coroutine           get_return_object() { return Coroutine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+		/// The coroutine is suspended until start() is called.
+		std::suspend_always initial_suspend() noexcept { return {}; }
+
+		/// The frame is kept until the object is destroyed.
+		std::suspend_always final_suspend() noexcept { return {}; }
+
+		/// Nothing to do when the coroutine returns.
+		void                return_void() {}
+
+		/// Keep the exception that terminated the coroutine.
+		void                unhandled_exception() { exception = std::current_exception(); }
+
+		/// Resume the coroutine (in a thread of the executor).
+		void                execute() override { std::coroutine_handle<promise_type>::from_promise(*this).resume(); }
+
+		/// Submit the coroutine to its executor to be resumed.
+		void                schedule() { executor->submit(*this); }
+
+		/// The executor that resumes the coroutine.
+		Executor*           executor{ nullptr };
+
+		/// The exception that terminated the coroutine.
+		std::exception_ptr  exception;
+	};
+
+	/// Handle of a coroutine.
+	using Handle = std::coroutine_handle<promise_type>;
+
+	// Construction, destruction
+
+public:
+
+	/// Default constructor (no coroutine).
+	Coroutine() = default;
+
+	/// Move constructor.
+	///
+	/// @param other The coroutine to take.
+	Coroutine(
+		Coroutine&& other) noexcept
+		: _handle(std::exchange(other._handle, nullptr))
+	{
+	}
+
+	/// Move assignment.
+	///
+	/// @param other The coroutine to take.
+	///
+	/// @return Reference on this object.
+	Coroutine& operator=(
+		Coroutine&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			_handle = std::exchange(other._handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	/// Destructor (destroys the frame of the coroutine).
+	~Coroutine() { reset(); }
+
+	/// @cond
+	Coroutine(
+		const Coroutine& other) = delete;
+
+	Coroutine& operator=(
+		const Coroutine& other) = delete;
+	/// @endcond
+
+	// Accessors
+
+public:
+
+	/// Check if the object holds a coroutine.
+	explicit operator bool() const { return static_cast<bool>(_handle); }
+
+	/// Check if the coroutine has returned.
+	///
+	/// @return true if the coroutine has returned (or thrown an exception).
+	bool     done() const { return _handle && _handle.done(); }
+
+	/// Get the exception that terminated the coroutine.
+	///
+	/// @return The exception, nullptr if the coroutine has not thrown.
+	std::exception_ptr exception() const { return _handle ? _handle.promise().exception : nullptr; }
+
+	// Operations
+
+public:
+
+	/// Start the coroutine in a thread of an executor.
+	///
+	/// @param executor The executor that runs the coroutine.
+	void start(
+		Executor& executor)
+	{
+		_handle.promise().executor = &executor;
+		_handle.promise().schedule();
+	}
+
+	/// Destroy the frame of the coroutine.
+	void reset()
+	{
+		if (_handle)
+		{
+			_handle.destroy();
+			_handle = nullptr;
+		}
+	}
+
+	// Implementation
+
+private:
+
+	/// Constructor.
+	///
+	/// @param handle The handle of the coroutine.
+	explicit Coroutine(
+		Handle handle)
+		: _handle(handle)
+	{
+	}
+
+	// Private attributes
+
+private:
+
+	/// The handle of the coroutine.
+	Handle _handle;
+};
+
+///
+/// Result of an asynchronous operation awaited by a coroutine.
+///
+/// The operation is started by the coroutine with a completion handler that
+/// calls set(), then the coroutine awaits the completion:
+///
+///     auto completion = std::make_shared<Completion<size_t>>();
+///     socket.async_read_some(buffer, [completion](auto error, size_t size) { completion->set(size); });
+///     auto size = co_await *completion;
+///
+/// set() can be called by any thread, the coroutine is resumed by its executor.
+///
+/// @tparam T The type of the result.
+///
+template <typename T>
+class Completion
+{
+	// Operations
+
+public:
+
+	/// Set the result of the operation and resume the waiting coroutine.
+	///
+	/// @param value The result.
+	void set(
+		T value)
+	{
+		Coroutine::Handle waiter;
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			_value = std::move(value);
+			waiter = std::exchange(_waiter, nullptr);
+		}
+
+		if (waiter)
+		{
+			waiter.promise().schedule();
+		}
+	}
+
+	/// Await the result (co_await by the coroutine).
+	///
+	/// @return The awaiter that gives the result.
+	auto operator co_await() { return Awaiter{ *this }; }
+
+	// Private implementation
+
+private:
+
+	///
+	/// Awaiter of the result.
+	///
+	struct Awaiter
+	{
+		/// Check if the result is available.
+		bool await_ready()
+		{
+			std::lock_guard<std::mutex> lock(completion._mutex);
+
+			return completion._value.has_value();
+		}
+
+		/// Suspend the coroutine until the result is set.
+		///
+		/// @param handle The handle of the awaiting coroutine.
+		///
+		/// @return false if the result has been set meanwhile.
+		bool await_suspend(
+			Coroutine::Handle handle)
+		{
+			std::lock_guard<std::mutex> lock(completion._mutex);
+
+			if (completion._value.has_value())
+			{
+				return false;
+			}
+			completion._waiter = handle;
+
+			return true;
+		}
+
+		/// Get the result.
+		T await_resume()
+		{
+			std::lock_guard<std::mutex> lock(completion._mutex);
+
+			return std::move(*completion._value);
+		}
+
+		/// The awaited completion.
+		Completion& completion;
+	};
+
+	// Private attributes
+
+private:
+
+	/// The mutex to protect the result and the waiter.
+	std::mutex        _mutex;
+
+	/// The result of the operation.
+	std::optional<T>  _value;
+
+	/// The coroutine waiting for the result.
+	Coroutine::Handle _waiter;
+};
+
+} // namespace framework
+} // namespace synapse
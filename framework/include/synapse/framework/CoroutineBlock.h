@@ -0,0 +1,201 @@
+///
+/// @file CoroutineBlock.h
+///
+/// Declaration of the CoroutineBlock and CoroutineSink classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+
+#include "BaseBlock.h"
+#include "Coroutine.h"
+#include "IConsumer.h"
+#include "Mailbox.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// A coroutine block is a block whose processing is written as a coroutine.
+///
+/// The block has no thread of its own: the manager starts main() on the
+/// executor, and the coroutine is suspended on each co_await until the awaited
+/// event (a message, the completion of an I/O operation) resumes it. Many
+/// blocks can then share the threads of the executor.
+///
+/// A coroutine source derives from CoroutineBlock and IProducer; it awaits the
+/// completion of its I/O operations with a Completion.
+///
+class CoroutineBlock :
+	public BaseBlock
+{
+	// Construction, destruction
+
+public:
+
+	/// Default constructor.
+	///
+	/// @param[in] name The name of the block.
+	CoroutineBlock(
+		const std::string& name);
+
+	/// Destructor (destroys the frame of the coroutine).
+	virtual ~CoroutineBlock();
+
+	// Implementation of IBlock
+
+public:
+
+	/// Ask the block to prepare to be deleted (terminate all pending operations).
+	void shutdown() override;
+
+	// Accessors
+
+public:
+
+	/// Check if a shutdown has been requested.
+	///
+	/// @return true if the coroutine shall return.
+	bool               stopping() const { return _stopping.load(); }
+
+	/// Get the exception that terminated the coroutine.
+	///
+	/// @return The exception, nullptr if the coroutine has not thrown.
+	std::exception_ptr exception() const { return _coroutine.exception(); }
+
+	// Operations
+
+public:
+
+	/// Start the coroutine of the block.
+	///
+	/// This method is called by the manager when the executor is started.
+	///
+	/// @param executor The executor that runs the coroutine.
+	void start(
+		Executor& executor);
+
+	// Implementation
+
+protected:
+
+	/// Body of the block (a coroutine).
+	///
+	/// @return The coroutine (created suspended).
+	virtual Coroutine main() = 0;
+
+	// Private attributes
+
+private:
+
+	/// Indicates that a shutdown has been requested.
+	std::atomic<bool> _stopping{ false };
+
+	/// The coroutine of the block.
+	Coroutine         _coroutine;
+};
+
+///
+/// A coroutine sink is a coroutine block that receives messages from other
+/// blocks.
+///
+/// consume() is an adapter that posts the message to the mailbox of the
+/// block; the coroutine receives the messages with co_await receive() and
+/// returns when it receives a null message (on shutdown). The mailbox honours
+/// the queue policy of the block as the queue of a Sink does:
+///
+///     Coroutine main() override
+///     {
+///         while (auto message = co_await receive())
+///         {
+///             ...
+///         }
+///     }
+///
+class CoroutineSink :
+	public CoroutineBlock,
+	public IConsumer
+{
+	// Construction, destruction
+
+public:
+
+	/// Default constructor.
+	///
+	/// @param[in] name The name of the block.
+	CoroutineSink(
+		const std::string& name);
+
+	/// Destructor.
+	virtual ~CoroutineSink();
+
+	// Implementation of IBlock
+
+public:
+
+	/// Ask the block to prepare to be deleted (terminate all pending operations).
+	void shutdown() override;
+
+	// Accessors
+
+public:
+
+	/// Get the counters of the overflows of the mailbox.
+	///
+	/// @return The counters of the mailbox.
+	OverflowCounters::Statistics overflows() const { return _mailbox.overflows(); }
+
+	/// Get the limits of the mailbox.
+	///
+	/// @return The queue policy of the block.
+	QueuePolicy                  queuePolicy() const { return _mailbox.policy(); }
+
+	// Operations
+
+public:
+
+	/// Set the limits of the mailbox (before the execution).
+	///
+	/// @param policy The queue policy (capacity 0 for an unbounded mailbox).
+	void setQueuePolicy(
+		const QueuePolicy& policy) { _mailbox.setPolicy(policy); }
+
+	// Implementation of IConsumer
+
+public:
+
+	/// Check if the consumer accepts concurrent calls to consume().
+	///
+	/// @return true, the messages are posted to a mailbox protected by a mutex.
+	bool isThreadSafe() const override final { return true; }
+
+	/// Consume a message (post it to the mailbox).
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override final;
+
+	// Implementation
+
+protected:
+
+	/// Receive the next message (co_await by the coroutine).
+	///
+	/// @return The awaitable that gives the message (null on shutdown).
+	Mailbox::Receive receive() { return _mailbox.receive(); }
+
+	// Private attributes
+
+private:
+
+	/// The messages received by the block.
+	Mailbox _mailbox;
+};
+
+} // namespace framework
+} // namespace synapse
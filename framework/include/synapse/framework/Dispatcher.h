@@ -8,19 +8,31 @@
 ///
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <list>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <vector>
 
+#include "BatchCounters.h"
 #include "IRunnable.h"
-#include "Message.h"
+#include "ITask.h"
+#include "MessagePtr.h"
+#include "MpscRing.h"
 #include "Port.h"
+#include "QueuePolicy.h"
 #include "Route.h"
+#include "WaitStrategy.h"
 
 namespace synapse {
 namespace framework {
 
+class Executor;
+
 ///
 /// A dispatcher is in charge to route messages to the destination blocks.
 ///
@@ -31,9 +43,92 @@ namespace framework {
 /// When the destination block is a sink, the message is stored in its message
 /// queue (using the `consume` method also).
 ///
+/// The requests are stored in a bounded lock-free ring. When the ring is full,
+/// the overflow policy tells if the producer waits for a free slot or if a
+/// request is discarded. The runnable drains all the pending requests of the
+/// ring at once and then processes them.
+///
+/// A worker of the dispatcher never waits for room: a fiber processed by a
+/// worker may emit on a route served by the same dispatcher (a framer and a
+/// router on the default dispatcher), the worker would then wait for itself.
+/// With the block policy, the requests of the workers that find a full ring
+/// are queued beyond the capacity of the ring, and the following requests of
+/// the workers on the same lane join them until they are taken.
+///
+/// A dispatcher can use several threads (workers), each worker has its own
+/// ring. The messages issued by a port are always processed by the same
+/// worker so that their order is kept, the messages of different ports are
+/// spread over the workers. The destinations of a route dispatched by several
+/// workers shall accept concurrent calls to `consume`.
+///
+/// When an executor is set, the workers have no thread of their own: each
+/// worker is submitted as a task to the executor when requests are pending
+/// (run() is not used). Otherwise the wait strategy tells if the threads poll
+/// the rings before sleeping. A producer running on a thread of an executor
+/// never waits for a free slot: it executes the other pending tasks of the
+/// executor until the request is queued.
+///
+/// Each worker has one ring per route priority (lane). The highest lane with
+/// pending requests is served first; the lower lanes are drained in slices so
+/// that a burst of bulk traffic delays a high-priority request by at most one
+/// slice. A lane with pending requests passed over starvationLimit() times in
+/// a row is served before the others. The messages issued by a port on routes
+/// of different priorities may then be reordered.
+///
 class Dispatcher :
 	public IRunnable
 {
+	// Definitions
+
+public:
+
+	/// Default number of requests stored by a worker of the dispatcher.
+	static constexpr size_t DEFAULT_CAPACITY{ 4096 };
+
+	/// Default limits of the queue of a worker (the producers wait for room,
+	/// see OverflowPolicy::block for the producers running on an executor).
+	static constexpr QueuePolicy DEFAULT_QUEUE_POLICY{ DEFAULT_CAPACITY, OverflowPolicy::block };
+
+	/// Function called by each dedicated thread when it starts (with the
+	/// index of its worker).
+	using ThreadStart = std::function<void(size_t)>;
+
+	/// Number of priority lanes (one per route priority).
+	static constexpr size_t LANE_COUNT{ 3 };
+
+	/// Maximum number of requests taken at once from a lane below the highest
+	/// priority.
+	static constexpr size_t SLICE_SIZE{ 256 };
+
+	/// Default number of batches a lane with pending requests can be passed over.
+	static constexpr size_t DEFAULT_STARVATION_LIMIT{ 8 };
+
+	///
+	/// Counters of a priority lane.
+	///
+	struct LaneStatistics
+	{
+		/// Number of requests processed.
+		uint64_t processed{ 0 };
+
+		/// Number of requests pending (when the counters are read).
+		uint64_t depth{ 0 };
+
+		/// Total time spent by the requests in the queue (nanoseconds).
+		uint64_t totalWait{ 0 };
+
+		/// Longest time spent by a request in the queue (nanoseconds).
+		uint64_t maxWait{ 0 };
+
+		/// Number of batches served by the starvation guard.
+		uint64_t promoted{ 0 };
+
+		/// Get the mean time spent by a request in the queue.
+		///
+		/// @return The mean wait (nanoseconds).
+		double meanWait() const { return processed == 0 ? 0.0 : static_cast<double>(totalWait) / static_cast<double>(processed); }
+	};
+
 	// Construction, destruction
 
 public:
@@ -41,8 +136,16 @@ public:
 	/// Default constructor.
 	///
 	/// @param[in] name The name of the object.
+	/// @param[in] threadCount The number of threads processing the requests.
+	/// @param[in] queuePolicy The limits of the queue of each worker (the
+	/// capacity is rounded up to the next power of two).
+	///
+	/// @throw std::invalid_argument when the number of threads or the capacity
+	/// is 0.
 	Dispatcher(
-		const std::string& name);
+		const std::string& name,
+		size_t             threadCount = 1,
+		const QueuePolicy& queuePolicy = DEFAULT_QUEUE_POLICY);
 
 	/// Default destructor.
 	virtual ~Dispatcher();
@@ -56,6 +159,41 @@ public:
 	/// @return The name of the object.
 	const std::string& name() { return _name; }
 
+	/// Get the number of threads processing the requests.
+	///
+	/// @return The number of workers of the dispatcher.
+	size_t             threadCount() const { return _workers.size(); }
+
+	/// Get the limits of the queue of each worker.
+	///
+	/// @return The queue policy of the dispatcher.
+	const QueuePolicy& queuePolicy() const { return _queuePolicy; }
+
+	/// Get the way the dedicated threads wait for requests.
+	///
+	/// @return The wait strategy of the dispatcher.
+	const WaitStrategy& waitStrategy() const { return _waitStrategy; }
+
+	/// Get the distribution of the size of the batches of requests.
+	///
+	/// @return The counters of the batches processed by all the workers.
+	BatchCounters::Statistics statistics() const;
+
+	/// Get the counters of the overflows of the queues.
+	///
+	/// @return The counters for all the workers.
+	OverflowCounters::Statistics overflows() const { return _overflows.statistics(); }
+
+	/// Get the counters of the priority lanes.
+	///
+	/// @return The counters for all the workers, indexed by route priority.
+	std::array<LaneStatistics, LANE_COUNT> lanes() const;
+
+	/// Get the number of batches a lane with pending requests can be passed over.
+	///
+	/// @return The bound of the starvation guard.
+	size_t starvationLimit() const { return _starvationLimit; }
+
 	// Operations
 
 public:
@@ -66,13 +204,40 @@ public:
 	/// @param source The port that issue the message.
 	/// @param route The route to dispatch the message.
 	void dispatch(
-		const std::shared_ptr<Message>& message,
-		const Port&                     source,
-		const Route&                    route);
+		const MessagePtr& message,
+		const Port&       source,
+		const Route&      route);
 
 	/// Ask the dispatcher to terminate the routing of messages.
 	void shutdown();
 
+	/// Set the executor that schedules the workers (before the execution).
+	///
+	/// @param executor The executor (nullptr for dedicated threads).
+	void setExecutor(
+		Executor* executor) { _executor = executor; }
+
+	/// Set the way the dedicated threads wait for requests (before the execution).
+	///
+	/// @param strategy The wait strategy.
+	void setWaitStrategy(
+		const WaitStrategy& strategy) { _waitStrategy = strategy; }
+
+	/// Set the function called by each dedicated thread when it starts
+	/// (before the execution).
+	///
+	/// @param threadStart The function (to set the affinity of the thread
+	/// for instance).
+	void setThreadStart(
+		ThreadStart threadStart) { _threadStart = std::move(threadStart); }
+
+	/// Set the number of batches a lane with pending requests can be passed
+	/// over (before the execution).
+	///
+	/// @param limit The bound of the starvation guard (at least 1).
+	void setStarvationLimit(
+		size_t limit) { _starvationLimit = std::max<size_t>(limit, 1); }
+
 	// Implementation of IRunnable
 
 public:
@@ -80,7 +245,8 @@ public:
 	/// Control function of the runnable.
 	///
 	/// This method is called by the manager in a thread dedicated to the
-	/// execution of the runnable.
+	/// execution of the runnable. The first worker runs in this thread, the
+	/// other workers run in threads started and joined by this method.
 	void run() override final;
 
 	// Private definitions
@@ -91,31 +257,183 @@ private:
 	struct Request
 	{
 		/// The message to dispatch.
-		std::shared_ptr<Message> message;
+		MessagePtr   message;
 		/// The port that issue the message.
-		const Port&              source;
+		const Port*  source{ nullptr };
 		/// The route to dispatch the message.
-		const Route&             route;
+		const Route* route{ nullptr };
+		/// The time the request was queued (nanoseconds of the steady clock).
+		int64_t      queued{ 0 };
 	};
 
+	/// The requests of a priority.
+	struct Lane
+	{
+		/// Constructor.
+		///
+		/// @param capacity The number of requests stored by the lane.
+		Lane(
+			size_t capacity)
+			: requests(capacity)
+		{
+		}
+
+		/// Check if requests are pending in the ring or beyond its capacity
+		/// (consumer only).
+		///
+		/// @return true if requests are pending.
+		bool pending() const { return !requests.empty() || overflowed.load(std::memory_order_relaxed) != 0; }
+
+		/// Queue a request of a worker of the dispatcher beyond the capacity of
+		/// the ring.
+		///
+		/// @param request The request to queue.
+		void defer(
+			Request&& request);
+
+		/// Take the requests queued beyond the capacity of the ring.
+		///
+		/// @param values The container where the requests are appended.
+		/// @param max The maximum number of requests to take.
+		///
+		/// @return The number of requests taken.
+		size_t takeDeferred(
+			std::vector<Request>& values,
+			size_t                max);
+
+		/// The pending requests.
+		MpscRing<Request>     requests;
+
+		/// The mutex to protect the requests queued beyond the capacity.
+		std::mutex            overflowMutex;
+
+		/// The requests of the workers queued beyond the capacity of the ring
+		/// (after the requests of the ring).
+		std::deque<Request>   overflow;
+
+		/// Number of requests queued beyond the capacity (polled without the
+		/// lock).
+		std::atomic<size_t>   overflowed{ 0 };
+
+		/// Number of batches taken from the other lanes while requests were
+		/// pending (consumer only).
+		size_t                skipped{ 0 };
+
+		/// Number of requests processed.
+		std::atomic<uint64_t> processed{ 0 };
+
+		/// Total time spent by the requests in the queue (nanoseconds).
+		std::atomic<uint64_t> totalWait{ 0 };
+
+		/// Longest time spent by a request in the queue (nanoseconds).
+		std::atomic<uint64_t> maxWait{ 0 };
+
+		/// Number of batches served by the starvation guard.
+		std::atomic<uint64_t> promoted{ 0 };
+	};
+
+	/// A thread (or a task of the executor) processing a part of the requests.
+	struct Worker :
+		public ITask
+	{
+		/// Constructor.
+		///
+		/// @param dispatcher The dispatcher of the worker.
+		/// @param capacity The number of requests stored by the worker.
+		Worker(
+			Dispatcher& dispatcher,
+			size_t      capacity);
+
+		/// Process the pending requests (when scheduled by an executor).
+		void execute() override final;
+
+		/// Check if all the lanes are empty (consumer only).
+		///
+		/// @return true if no request is pending.
+		bool empty() const;
+
+		/// The dispatcher of the worker.
+		Dispatcher&                        dispatcher;
+
+		/// The pending requests, indexed by route priority.
+		std::vector<std::unique_ptr<Lane>> lanes;
+
+		/// The distribution of the size of the batches of requests.
+		BatchCounters                      batches;
+
+		/// The requests being processed.
+		std::vector<Request>               batch;
+
+		/// Indicates that the worker has been submitted to the executor.
+		std::atomic<bool>                  scheduled{ false };
+
+		/// Incremented to wake up the dedicated thread of the worker.
+		std::atomic<uint32_t>              doorbell{ 0 };
+
+		/// Indicates that the dedicated thread is about to sleep.
+		std::atomic<bool>                  sleeping{ false };
+	};
+
+	// Implementation
+
+private:
+
+	/// Control function of a worker.
+	///
+	/// @param worker The worker to run.
+	void run(
+		Worker& worker);
+
+	/// Wait until a lane of a worker is not empty or the dispatcher is shut down.
+	///
+	/// @param worker The worker of the calling thread.
+	void wait(
+		Worker& worker);
+
+	/// Take the next batch of requests of a worker.
+	///
+	/// @param worker The worker (its batch receives the requests).
+	///
+	/// @return true if requests have been taken.
+	bool take(
+		Worker& worker);
+
+	/// Process a batch of requests taken from the queue of a worker.
+	///
+	/// @param worker The worker of the requests (its batch is cleared on return).
+	void process(
+		Worker& worker);
+
 	// Private attributes
 
 private:
 
 	/// The name of the object.
-	std::string             _name;
+	std::string                          _name;
 
 	/// Indicates that a shutdown has been requested.
-	std::atomic<bool>       _shutdown{ false };
+	std::atomic<bool>                    _shutdown{ false };
+
+	/// The limits of the queue of each worker.
+	QueuePolicy                          _queuePolicy;
+
+	/// The counters of the overflows of the queues.
+	OverflowCounters                     _overflows;
+
+	/// The way the dedicated threads wait for requests.
+	WaitStrategy                         _waitStrategy;
+
+	/// The function called by each dedicated thread when it starts.
+	ThreadStart                          _threadStart;
 
-	/// The mutex to protect the access to the list of requests.
-	std::mutex              _mtxRequests;
+	/// Number of batches a lane with pending requests can be passed over.
+	size_t                               _starvationLimit{ DEFAULT_STARVATION_LIMIT };
 
-	/// The condition variable to detect changes on the list of requests.
-	std::condition_variable _cvRequests;
+	/// The executor that schedules the workers (nullptr for dedicated threads).
+	Executor*                            _executor{ nullptr };
 
-	/// The list of requets.
-	std::list<Request>      _requests;
+	/// The workers of the dispatcher.
+	std::vector<std::unique_ptr<Worker>> _workers;
 };
 
 } // namespace framework
@@ -0,0 +1,222 @@
+///
+/// @file Executor.h
+///
+/// Declaration of the Executor class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ITask.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Fixed pool of threads executing tasks.
+///
+/// Each thread has its own deque of tasks. The tasks submitted by a thread of
+/// the pool are added to its own deque, the tasks submitted by other threads
+/// are spread over the deques. A thread takes the tasks from the front of its
+/// deque and, when it is empty, steals a task from the back of the deque of
+/// another thread. The idle threads park with std::atomic::wait/notify.
+///
+/// The number of threads does not depend on the number of tasks.
+///
+/// A task shall not wait for an event that only another task can produce. A
+/// task that needs room in a full queue calls runPending() instead: the thread
+/// executes the other pending tasks of the executor (among them the consumer
+/// of the queue) until there is room.
+///
+class Executor
+{
+	// Definitions
+
+public:
+
+	///
+	/// Counters of the executor.
+	///
+	struct Statistics
+	{
+		/// Number of tasks executed.
+		uint64_t executed{ 0 };
+
+		/// Number of tasks executed by another thread than the one they were
+		/// submitted to.
+		uint64_t stolen{ 0 };
+	};
+
+	/// Function called by each thread of the pool when it starts (with the
+	/// index of the thread).
+	using ThreadStart = std::function<void(size_t)>;
+
+	// Construction, destruction
+
+public:
+
+	/// Constructor.
+	///
+	/// @param threadCount The number of threads of the pool (0 for one thread
+	/// per core).
+	Executor(
+		size_t threadCount = 0);
+
+	/// Destructor (stops the threads).
+	~Executor();
+
+	/// @cond
+	Executor(
+		const Executor& other) = delete;
+
+	Executor& operator=(
+		const Executor& other) = delete;
+	/// @endcond
+
+	// Accessors
+
+public:
+
+	/// Get the number of threads of the pool.
+	///
+	/// @return The number of threads.
+	size_t     threadCount() const { return _workers.size(); }
+
+	/// Get the counters of the executor.
+	///
+	/// @return A snapshot of the counters.
+	Statistics statistics() const;
+
+	/// Get the executor of the calling thread.
+	///
+	/// @return The executor, nullptr if the calling thread is not a thread of
+	/// an executor.
+	static Executor* current();
+
+	// Operations
+
+public:
+
+	/// Set the function called by each thread of the pool when it starts
+	/// (before start()).
+	///
+	/// @param threadStart The function (to log the affinity of the thread
+	/// for instance).
+	void setThreadStart(
+		ThreadStart threadStart) { _threadStart = std::move(threadStart); }
+
+	/// Start the threads of the pool.
+	void start();
+
+	/// Stop the threads of the pool.
+	///
+	/// The tasks being executed are completed, the pending tasks are discarded.
+	void stop();
+
+	/// Submit a task.
+	///
+	/// The task shall not be submitted again before it is executed.
+	///
+	/// @param task The task to execute.
+	void submit(
+		ITask& task);
+
+	/// Execute a pending task of the executor of the calling thread.
+	///
+	/// Called by a task that cannot make progress (its destination queue is
+	/// full) instead of waiting. The task being executed is not pending, it is
+	/// never called again recursively.
+	///
+	/// @return true if a task has been executed, false if no task is pending
+	/// or if the calling thread is not a thread of an executor.
+	static bool runPending();
+
+	// Private definitions
+
+private:
+
+	/// The deque of tasks of a thread.
+	struct Worker
+	{
+		/// The mutex to protect the deque.
+		std::mutex            mutex;
+
+		/// The pending tasks.
+		std::deque<ITask*>    tasks;
+
+		/// Number of tasks executed by the thread.
+		std::atomic<uint64_t> executed{ 0 };
+
+		/// Number of tasks stolen by the thread.
+		std::atomic<uint64_t> stolen{ 0 };
+	};
+
+	/// Control function of a thread of the pool.
+	///
+	/// @param index The index of the worker of the thread.
+	void run(
+		size_t index);
+
+	/// Execute a task and count it.
+	///
+	/// @param index The index of the worker of the calling thread.
+	/// @param task The task to execute.
+	/// @param stolen Indicates that the task was stolen from another thread.
+	void execute(
+		size_t index,
+		ITask& task,
+		bool   stolen);
+
+	/// Take the next task of a thread.
+	///
+	/// @param index The index of the worker of the thread.
+	/// @param stolen Set to true when the task was stolen from another thread.
+	///
+	/// @return The task, nullptr if no task is pending.
+	ITask* take(
+		size_t index,
+		bool&  stolen);
+
+	// Private attributes
+
+private:
+
+	/// The workers of the threads.
+	std::vector<std::unique_ptr<Worker>> _workers;
+
+	/// The threads of the pool.
+	std::vector<std::thread>             _threads;
+
+	/// Indicates that the threads shall stop.
+	std::atomic<bool>                    _stopping{ false };
+
+	/// Number of tasks waiting in the deques.
+	std::atomic<size_t>                  _pending{ 0 };
+
+	/// Number of threads parked (or about to be).
+	std::atomic<size_t>                  _sleeping{ 0 };
+
+	/// Counter incremented to wake up the parked threads.
+	std::atomic<uint32_t>                _signal{ 0 };
+
+	/// Index of the next deque used for the tasks submitted by other threads.
+	std::atomic<size_t>                  _next{ 0 };
+
+	/// The function called by each thread when it starts.
+	ThreadStart                          _threadStart;
+};
+
+} // namespace framework
+} // namespace synapse
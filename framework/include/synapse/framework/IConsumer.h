@@ -8,9 +8,9 @@
 ///
 #pragma once
 
-#include <memory>
-
 #include "Message.h"
+#include "MessagePtr.h"
+#include "Schema.h"
 
 namespace synapse {
 namespace framework {
@@ -18,8 +18,33 @@ namespace framework {
 ///
 /// Interface of a message consumer.
 ///
+/// The consumers written for the previous versions of the framework, that
+/// receive a std::shared_ptr<Message>, derive from LegacyConsumer.
+///
 class IConsumer
 {
+	// Enquiries
+
+public:
+
+	/// Check if the consumer accepts concurrent calls to consume().
+	///
+	/// The consumers of the inline routes are called by the threads of the
+	/// producers, a consumer that is not thread-safe can only be fed by one
+	/// port.
+	///
+	/// @return true if consume() can be called by several threads at once.
+	virtual bool isThreadSafe() const { return false; }
+
+	/// Get the schema of the messages accepted by the consumer.
+	///
+	/// The manager checks that the ports of the routes to a consumer that
+	/// accepts a structured schema issue this schema.
+	///
+	/// @return The identifier of the schema, RAW_SCHEMA if any message is
+	/// accepted.
+	virtual SchemaId schema() const { return RAW_SCHEMA; }
+
 	// Operations
 
 public:
@@ -28,7 +53,7 @@ public:
 	///
 	/// @param message[in] Message to be consumed.
 	virtual void consume(
-		const std::shared_ptr<Message>& message) = 0;
+		const MessagePtr& message) = 0;
 };
 
 } // namespace framework
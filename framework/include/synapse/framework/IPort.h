@@ -8,9 +8,8 @@
 ///
 #pragma once
 
-#include <memory>
-
 #include "Message.h"
+#include "MessagePtr.h"
 
 namespace synapse {
 namespace framework {
@@ -18,6 +17,9 @@ namespace framework {
 ///
 /// Interface for a port.
 ///
+/// The blocks written for the previous versions of the framework dispatch a
+/// std::shared_ptr<Message>: it is converted to a MessagePtr.
+///
 class IPort
 {
 	// Operations
@@ -28,7 +30,7 @@ public:
 	///
 	/// @param[in] message The message to dispatch.
 	virtual void dispatch(
-		const std::shared_ptr<Message>& message) = 0;
+		const MessagePtr& message) = 0;
 };
 
 } // namespace framework
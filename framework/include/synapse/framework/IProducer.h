@@ -13,6 +13,7 @@
 
 #include "IBlock.h"
 #include "Message.h"
+#include "Schema.h"
 
 namespace synapse {
 namespace framework {
@@ -33,6 +34,19 @@ public:
 	/// @return The list of the names of the output ports.
 	virtual std::list<std::string> ports(
 		const IBlock::ConfigData& configData) = 0;
+
+	/// Get the schema of the messages issued by a port.
+	///
+	/// @param[in] port The name of the port.
+	///
+	/// @return The identifier of the schema, RAW_SCHEMA for raw messages.
+	virtual SchemaId portSchema(
+		const std::string& port) const
+	{
+		(void) port; // Unused parameter.
+
+		return RAW_SCHEMA;
+	}
 };
 
 } // namespace framework
@@ -0,0 +1,35 @@
+///
+/// @file ITask.h
+///
+/// Declaration of the ITask interface.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+namespace synapse {
+namespace framework {
+
+///
+/// Interface of a unit of work scheduled on the threads of an executor.
+///
+/// A task is submitted each time it has work to do, it shall not wait for
+/// events: it processes what is pending and returns. When a queue it feeds is
+/// full, it executes the other pending tasks with Executor::runPending()
+/// rather than waiting for a task of the same executor to make room.
+///
+class ITask
+{
+	// Operations
+
+public:
+
+	/// Process the pending work of the task.
+	///
+	/// This method is called by a thread of the executor.
+	virtual void execute() = 0;
+};
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,110 @@
+///
+/// @file LegacyConsumer.h
+///
+/// Declaration of the LegacyConsumer and LegacySink classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Fiber.h"
+#include "Message.h"
+#include "MessagePtr.h"
+#include "Sink.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Consumer written for the previous versions of the framework.
+///
+/// The consumer overrides consume(const std::shared_ptr<Message>&), the
+/// messages received as a MessagePtr are shared with a std::shared_ptr (see
+/// MessagePtr::share()) and forwarded to it.
+///
+/// @tparam Base The class of the consumer (Fiber or a class that implements
+/// IConsumer).
+///
+/// @deprecated Override consume(const MessagePtr&) instead.
+///
+template <typename Base = Fiber>
+class LegacyConsumer :
+	public Base
+{
+	// Construction, destruction
+
+public:
+
+	using Base::Base;
+
+	// Implementation of IConsumer
+
+public:
+
+	/// Consume a message (forward it to the legacy overload).
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override final
+	{
+		consume(message.share());
+	}
+
+	/// Consume a message (legacy).
+	///
+	/// @param message[in] Message to be consumed.
+	virtual void consume(
+		const std::shared_ptr<Message>& message) = 0;
+};
+
+///
+/// Sink written for the previous versions of the framework.
+///
+/// The sink overrides process(const std::shared_ptr<Message>&), the messages
+/// are shared with a std::shared_ptr and forwarded to it.
+///
+/// @deprecated Override process(const MessagePtr&) instead.
+///
+class LegacySink :
+	public Sink
+{
+	// Construction, destruction
+
+public:
+
+	/// Constructor.
+	///
+	/// @param[in] name The name of the block.
+	explicit LegacySink(
+		const std::string& name)
+		: Sink(name)
+	{
+	}
+
+	// Implementation
+
+protected:
+
+	/// Process a message in the context of the runnable (forward it to the
+	/// legacy overload).
+	///
+	/// @param message[in] Message to be processed.
+	void process(
+		const MessagePtr& message) override final
+	{
+		process(message.share());
+	}
+
+	/// Process a message in the context of the runnable (legacy).
+	///
+	/// @param message[in] Message to be processed.
+	virtual void process(
+		const std::shared_ptr<Message>& message) = 0;
+};
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,188 @@
+///
+/// @file Mailbox.h
+///
+/// Declaration of the Mailbox class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "Coroutine.h"
+#include "MessagePtr.h"
+#include "QueuePolicy.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Queue of messages received by a coroutine.
+///
+/// Messages are posted by any thread, a single coroutine receives them with
+/// co_await receive(). The coroutine is suspended while the mailbox is empty
+/// and resumed by its executor when a message is posted.
+///
+/// Once the mailbox is closed, receive() returns a null message when the
+/// pending messages have been received.
+///
+/// The mailbox is unbounded unless a queue policy is set. When it is full, the
+/// overflow policy tells if the producer waits or if a message is discarded,
+/// as for the queue of a sink (a producer running on a thread of an executor
+/// executes the other pending tasks of the executor until there is room).
+///
+class Mailbox
+{
+	// Definitions
+
+public:
+
+	/// Period at which a producer running on a thread of an executor checks the
+	/// mailbox when it has no task to execute.
+	static constexpr std::chrono::milliseconds ROOM_POLL_PERIOD{ 1 };
+
+	///
+	/// Awaitable returned by receive().
+	///
+	class Receive
+	{
+	public:
+
+		/// Constructor.
+		///
+		/// @param mailbox The mailbox to receive from.
+		explicit Receive(
+			Mailbox& mailbox)
+			: _mailbox(mailbox)
+		{
+		}
+
+		/// Take a message if one is pending.
+		bool       await_ready() { return _mailbox.tryReceive(_message); }
+
+		/// Suspend the coroutine until a message is posted.
+		bool       await_suspend(
+			Coroutine::Handle handle) { return _mailbox.suspend(handle, _message); }
+
+		/// Get the message (null if the mailbox is closed).
+		MessagePtr await_resume();
+
+	private:
+
+		/// The mailbox to receive from.
+		Mailbox&   _mailbox;
+
+		/// The message received (if any).
+		MessagePtr _message;
+	};
+
+	// Accessors
+
+public:
+
+	/// Get the limits of the mailbox.
+	///
+	/// @return The queue policy of the mailbox.
+	QueuePolicy                  policy() const;
+
+	/// Get the counters of the overflows of the mailbox.
+	///
+	/// @return The counters of the mailbox.
+	OverflowCounters::Statistics overflows() const { return _overflows.statistics(); }
+
+	// Operations
+
+public:
+
+	/// Set the limits of the mailbox (before the execution).
+	///
+	/// @param policy The queue policy (capacity 0 for an unbounded mailbox).
+	void    setPolicy(
+		const QueuePolicy& policy);
+
+	/// Post a message to the mailbox (any thread).
+	///
+	/// @param message The message to post.
+	void    post(
+		const MessagePtr& message);
+
+	/// Receive the next message (co_await by the coroutine).
+	///
+	/// @return The awaitable that gives the message.
+	Receive receive() { return Receive(*this); }
+
+	/// Close the mailbox, resume the waiting coroutine and the producers
+	/// waiting for room.
+	void    close();
+
+	/// Get the number of pending messages.
+	///
+	/// @return The number of messages posted and not yet received.
+	size_t  size() const;
+
+	// Private implementation
+
+private:
+
+	/// Take the next message if one is pending.
+	///
+	/// @param message The message taken.
+	///
+	/// @return true if the coroutine shall not be suspended.
+	bool tryReceive(
+		MessagePtr& message);
+
+	/// Register the waiting coroutine unless a message arrived meanwhile.
+	///
+	/// @param handle  The handle of the coroutine.
+	/// @param message The message taken if the coroutine is not suspended.
+	///
+	/// @return true if the coroutine is suspended.
+	bool suspend(
+		Coroutine::Handle handle,
+		MessagePtr&       message);
+
+	/// Take the front message (the lock is held).
+	///
+	/// @param message The message taken.
+	void pop(
+		MessagePtr& message);
+
+	/// Wait until there is room in the mailbox (the lock is held).
+	///
+	/// @param lock The lock on the mutex of the mailbox.
+	void waitForRoom(
+		std::unique_lock<std::mutex>& lock);
+
+	// Private attributes
+
+private:
+
+	/// The mutex to protect the messages and the waiter.
+	mutable std::mutex       _mutex;
+
+	/// The condition variable to detect room in the mailbox.
+	std::condition_variable  _cvRoom;
+
+	/// The pending messages.
+	std::deque<MessagePtr>   _messages;
+
+	/// The limits of the mailbox.
+	QueuePolicy              _policy;
+
+	/// The counters of the overflows of the mailbox.
+	OverflowCounters         _overflows;
+
+	/// The coroutine waiting for a message.
+	Coroutine::Handle        _waiter;
+
+	/// Indicates that the mailbox is closed.
+	bool                     _closed{ false };
+};
+
+} // namespace framework
+} // namespace synapse
@@ -8,25 +8,33 @@
 ///
 #pragma once
 
+#include <atomic>
 #include <filesystem>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <boost/dll.hpp>
 
 #include <nlohmann/json.hpp>
 
 #include <synapse/framework/Dispatcher.h>
+#include <synapse/framework/Executor.h>
 #include <synapse/framework/IManager.h>
 #include <synapse/framework/Port.h>
 #include <synapse/framework/Registry.h>
 #include <synapse/framework/Route.h>
+#include <synapse/framework/ThreadPolicy.h>
 
 namespace synapse {
 namespace framework {
 
+class CoroutineBlock;
+class ReplicaSet;
+
 ///
 /// The block manager manage blocks.
 ///
@@ -40,6 +48,9 @@ public:
 	/// Configuration data is json.
 	using ConfigData = nlohmann::json;
 
+	/// The output ports of a block indexed by name.
+	using PortsByName = std::map<std::string, Port*>;
+
 	// Construction, destruction
 
 public:
@@ -87,6 +98,18 @@ public:
 		IBlock*            block,
 		const std::string& name) const override final;
 
+	// Accessors
+
+public:
+
+	/// Access to the registry of the block classes.
+	///
+	/// The classes of the modules are registered when they are loaded, the
+	/// application can register its own classes before the initialization.
+	///
+	/// @return The registry.
+	Registry& registry() { return _registry; }
+
 	// Operations
 
 public:
@@ -133,15 +156,44 @@ private:
 	/// Modules localted in the same folder as the executable and modules located
 	/// in the additional folders described in the configuration file.
 	///
+	/// A module with a manifest is loaded only if it implements a block class
+	/// of the configuration.
+	///
 	/// @param config The configuration data.
 	void loadModules(
 		const ConfigData& config);
 
-	/// Load the external modules located into a given folder.
+	/// Find the external modules located into a given folder.
 	///
 	/// @param folder Absolute path to the folder to search modules.
-	void loadModules(
-		const std::filesystem::path& folder);
+	/// @param paths The list to append the paths of the modules to.
+	static void findModules(
+		const std::filesystem::path&        folder,
+		std::vector<std::filesystem::path>& paths);
+
+	/// Open modules and register their blocks.
+	///
+	/// @param paths The paths of the modules.
+	void openModules(
+		const std::vector<std::filesystem::path>& paths);
+
+	/// Create an output port of a block.
+	///
+	/// @param name The name of the port.
+	/// @param block The block that owns the port.
+	///
+	/// @return The port.
+	Port* addPort(
+		const std::string& name,
+		IBlock*            block);
+
+	/// Get the output ports of a block.
+	///
+	/// @param block The block.
+	///
+	/// @return The ports of the block indexed by name.
+	const PortsByName& portsOf(
+		const IBlock* block) const;
 
 	/// Create the blocks described into the configuration file.
 	///
@@ -149,14 +201,79 @@ private:
 	void createBlocks(
 		const ConfigData& config);
 
+	/// Create the replicas of a fiber and the set that shards the messages
+	/// over them.
+	///
+	/// @param name The name of the fiber.
+	/// @param className The class of the fiber.
+	/// @param config The configuration data of the block.
+	///
+	/// @return The replica set, registered under the name of the fiber.
+	///
+	/// @throw std::runtime_error If the class is not a fiber or the options are invalid.
+	ReplicaSet* createReplicas(
+		const std::string& name,
+		const std::string& className,
+		const ConfigData&  config);
+
 	/// Create the routes described into the configuration file.
 	///
 	/// @param config The configuration data.
 	void createRoutes(
 		const ConfigData& config);
 
+	/// Check that the inline routes can be executed in the threads of the producers.
+	///
+	/// @throw std::runtime_error when a consumer that is not thread-safe is fed
+	/// inline by several ports or when the inline routes form a cycle.
+	void checkInlineRoutes() const;
+
+	/// Compile the execution plan and log it.
+	///
+	/// When the configuration enables it ("plan": { "fuse": true }), the
+	/// queued routes without options that link a fiber with a single output
+	/// to a fiber with a single input are fused: the downstream fiber is
+	/// called by the thread of the upstream one. Each fused route is logged.
+	void compilePlan();
+
+	/// Apply a thread policy to the calling thread and log its cores.
+	///
+	/// A policy refused by the system is logged, the thread runs anyway.
+	///
+	/// @param owner The description of the thread (for the log).
+	/// @param policy The thread policy.
+	static void applyThreadPolicy(
+		const std::string&  owner,
+		const ThreadPolicy& policy);
+
+	/// Get the executor that schedules a block.
+	///
+	/// @param blockName The name of the block.
+	///
+	/// @return The executor of the group of the block, the shared executor
+	/// if the block is not in a group.
+	Executor& executorOf(
+		const std::string& blockName);
+
+	/// Log the end of a runnable and its counters.
+	///
+	/// @param runnable The runnable that terminated.
+	static void report(
+		IRunnable* runnable);
+
+	/// Log the end of a coroutine block and the exception that terminated it.
+	///
+	/// @param block The coroutine block that terminated.
+	static void report(
+		CoroutineBlock* block);
+
 	/// Initialize the blocks when all the blocks and routes has been instancied.
 	///
+	/// The blocks are initialized one after the other in the order of the
+	/// configuration, unless more startup threads are configured: the
+	/// configuration then states that the initialization of a block does not
+	/// depend on another block, and the blocks are initialized concurrently.
+	///
 	/// @param config The configuration data.
 	///
 	void initializeBlocks(
@@ -186,6 +303,40 @@ private:
 
 	/// The collection of output ports of the blocks.
 	std::list<std::unique_ptr<Port>>                   _ports;
+
+	/// The output ports indexed by block and name.
+	std::map<const IBlock*, PortsByName>               _portIndex;
+
+	/// The queued routes that can be fused when the plan is compiled.
+	std::set<const Route*>                             _fusableRoutes;
+
+	/// Indicates that the chains of fibers are fused (opt-in).
+	bool                                               _fuseFibers{ false };
+
+	/// Number of threads of the executor (0 for one thread per core).
+	size_t                                             _executorThreads{ 0 };
+
+	/// Number of threads that initialize the blocks (1 to initialize them one
+	/// after the other, 0 for one thread per core).
+	size_t                                             _startupThreads{ 1 };
+
+	/// The executor that schedules the sinks and the dispatchers.
+	std::unique_ptr<Executor>                          _executor;
+
+	/// The executor group of the blocks (block name to group name).
+	std::map<std::string, std::string>                 _executorGroups;
+
+	/// The thread policies of the blocks (block name to policy).
+	std::map<std::string, ThreadPolicy>                _threadPolicies;
+
+	/// The thread policies of the dispatchers (dispatcher name to policy).
+	std::map<std::string, ThreadPolicy>                _dispatcherThreadPolicies;
+
+	/// The executors of the groups (one thread each).
+	std::map<std::string, std::unique_ptr<Executor>>   _groups;
+
+	/// Indicates that the termination has been requested.
+	std::atomic<bool>                                  _shutdownRequested{ false };
 };
 
 } // namespace framework
@@ -8,14 +8,67 @@
 ///
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Schema.h"
+
 namespace synapse {
 namespace framework {
 
+class MessagePtr;
+
 ///
 /// A message transmitted between blocks along a route.
 ///
+/// Messages created with Message::create() are shared with a MessagePtr: the
+/// header, the reference counter and the payload are stored in a single block
+/// obtained from the MessagePool. The header takes 64 bytes (one cache line on
+/// 64-bit targets), the payload follows it in the same block whatever its
+/// size.
+///
+/// Messages created with the constructors (typically with std::make_shared)
+/// store their payload in a separate block obtained from the MessagePool.
+///
+/// A slice references a sub-range of the payload of a parent message and keeps
+/// the parent alive, the payload is not copied.
+///
+/// A structured message carries a fixed-layout struct (see Schema.h) and the
+/// identifier of its schema: the consumers read the struct in place instead of
+/// parsing the bytes again.
+///
+/// The metadata of a message describe its ingress in the application, they are
+/// stamped by the first port that dispatches the message and inherited by the
+/// messages derived from it.
+///
 class Message
 {
+	// Definitions
+
+public:
+
+	///
+	/// Metadata of a message.
+	///
+	struct Metadata
+	{
+		/// Time of the reception of the content (nanoseconds of the steady clock,
+		/// 0 when not yet stamped).
+		uint64_t timestamp{ 0 };
+
+		/// Sequence number of the message on its origin port.
+		uint32_t sequence{ 0 };
+
+		/// Identifier of the port that issued the message (0 when not yet dispatched).
+		uint32_t origin{ 0 };
+
+		/// Get the current time of the clock used for the timestamps.
+		///
+		/// @return The current time (nanoseconds of the steady clock).
+		static uint64_t now();
+	};
+
 	// Construction, destruction
 
 public:
@@ -43,6 +96,71 @@ public:
 	/// Destructor.
 	virtual ~Message();
 
+	/// Create a message shared with a MessagePtr without initialization of
+	/// the payload.
+	///
+	/// @param size The size of the payload in bytes.
+	///
+	/// @return The new message.
+	static MessagePtr create(
+		size_t size);
+
+	/// Create a message shared with a MessagePtr with initialization of the
+	/// payload.
+	///
+	/// @param size The size of the payload in bytes.
+	/// @param payload The payload to be copied.
+	///
+	/// @return The new message.
+	static MessagePtr create(
+		size_t         size,
+		const uint8_t* payload);
+
+	/// Create a message derived from another one.
+	///
+	/// The payload is copied and the metadata are inherited from the other
+	/// message.
+	///
+	/// @param size The size of the payload in bytes.
+	/// @param payload The payload to be copied.
+	/// @param metadata The metadata of the message the new one is derived from.
+	///
+	/// @return The new message.
+	static MessagePtr create(
+		size_t          size,
+		const uint8_t*  payload,
+		const Metadata& metadata);
+
+	/// Create a structured message.
+	///
+	/// The struct is copied into the payload and the schema of the message is
+	/// set (defined in MessagePtr.h).
+	///
+	/// @tparam T The type of the payload.
+	///
+	/// @param value The struct to be copied.
+	///
+	/// @return The new message.
+	template <Structured T>
+	static MessagePtr create(
+		const T& value);
+
+	/// Create a message that references a sub-range of the payload of another
+	/// message.
+	///
+	/// The payload is shared with the parent message, it is not copied. The
+	/// metadata are inherited from the parent message.
+	///
+	/// @param parent The message that stores the payload.
+	/// @param offset The offset of the sub-range in the payload of the parent.
+	/// @param size The size of the sub-range in bytes.
+	///
+	/// @return The new message.
+	static MessagePtr slice(
+		const MessagePtr& parent,
+		size_t            offset,
+		size_t            size);
+
 	// Accessors
 
 public:
@@ -50,17 +168,43 @@ public:
 	/// Access to the payload of the message.
 	///
 	/// @return The payload of the message.
-	const uint8_t* payload() const { return _payload; }
+	const uint8_t*  payload() const { return _payload; }
 
 	/// Access to the payload of the message.
 	///
 	/// @return The payload of the message.
-	uint8_t*       payload() { return _payload; }
+	uint8_t*        payload() { return _payload; }
 
 	/// Size of the payload.
 	///
 	/// @return The size of the payload in bytes.
-	size_t         size() const { return _size; }
+	size_t          size() const { return _size; }
+
+	/// Get the schema of the payload.
+	///
+	/// @return The identifier of the schema (RAW_SCHEMA for the raw messages).
+	SchemaId        schema() const { return _schema; }
+
+	/// Access to the struct carried by a structured message.
+	///
+	/// @tparam T The type of the payload.
+	///
+	/// @return The struct, nullptr if the message does not carry this schema.
+	template <Structured T>
+	const T*        as() const
+	{
+		return _schema == schemaOf<T>() && _size == sizeof(T) ? reinterpret_cast<const T*>(_payload) : nullptr;
+	}
+
+	/// Access to the metadata of the message.
+	///
+	/// @return The metadata of the message.
+	const Metadata& metadata() const { return _metadata; }
+
+	/// Access to the metadata of the message.
+	///
+	/// @return The metadata of the message.
+	Metadata&       metadata() { return _metadata; }
 
 	// Operators
 
@@ -74,15 +218,91 @@ public:
 	Message& operator=(
 		Message&& other) noexcept;
 
+	// Private definitions
+
+private:
+
+	friend class MessagePtr;
+
+	/// Storage of the payload.
+	enum class Storage : uint8_t
+	{
+		/// The payload is stored in its own block of the pool.
+		pool,
+		/// The payload follows the header in the block of the message.
+		embedded,
+		/// The payload is a sub-range of the payload of the parent message.
+		slice
+	};
+
+	/// Constructor of a message stored in a block of the pool.
+	///
+	/// @param size The size of the payload in bytes.
+	/// @param blockSize The size of the block that stores the message.
+	/// @param storage The storage of the payload.
+	Message(
+		size_t  size,
+		size_t  blockSize,
+		Storage storage);
+
+	/// Acquire the payload of another message.
+	///
+	/// @param other The message whose payload is acquired.
+	void acquire(
+		Message& other);
+
+	/// Allocate the storage of the payload according to its size.
+	void allocatePayload();
+
+	/// Release the payload of the message.
+	void releasePayload() noexcept;
+
+	/// Add a reference to the message.
+	void addRef() const noexcept
+	{
+		_references.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/// Remove a reference to the message and destroy it with the last one.
+	void release() const noexcept
+	{
+		if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			destroy();
+		}
+	}
+
+	/// Destroy a message created with create() and release its block.
+	void destroy() const noexcept;
+
 	// Private attributes
 
 private:
 
 	/// The payload of the message.
-	uint8_t* _payload{ nullptr };
+	uint8_t*                      _payload{ nullptr };
 
 	/// The size of the payload of the message.
-	size_t   _size{ 0 };
+	size_t                        _size{ 0 };
+
+	/// The size of the block that stores the message (0 when the message has
+	/// not been created with create()).
+	size_t                        _blockSize{ 0 };
+
+	/// The message that stores the payload of a slice.
+	const Message*                _parent{ nullptr };
+
+	/// The metadata of the message.
+	Metadata                      _metadata;
+
+	/// The number of MessagePtr referencing the message.
+	mutable std::atomic<uint32_t> _references{ 0 };
+
+	/// The storage of the payload.
+	Storage                       _storage{ Storage::pool };
+
+	/// The schema of the payload.
+	SchemaId                      _schema{ RAW_SCHEMA };
 };
 
 } // namespace framework
@@ -0,0 +1,218 @@
+///
+/// @file MessagePool.h
+///
+/// Declaration of the MessagePool class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace synapse {
+namespace framework {
+
+///
+/// Pool of memory blocks used to store the content of the messages.
+///
+/// Blocks are sorted in size classes (powers of two from MIN_BLOCK_SIZE to
+/// MAX_BLOCK_SIZE). Each thread owns a cache of free blocks per size class so
+/// that allocating and releasing a block does not require any synchronization
+/// in the steady state. Caches exchange batches of blocks with a shared depot
+/// when they run empty or full. Requests larger than MAX_BLOCK_SIZE are served
+/// by the heap.
+///
+/// The blocks allocated or released after the cache of the thread has been
+/// destroyed (by the destructor of another thread_local object for instance)
+/// go directly through the depot.
+///
+class MessagePool
+{
+	// Definitions
+
+public:
+
+	/// Size of the smallest size class (bytes).
+	static constexpr size_t MIN_BLOCK_SIZE{ 64 };
+
+	/// Number of size classes.
+	static constexpr size_t CLASS_COUNT{ 11 };
+
+	/// Size of the largest size class (bytes).
+	static constexpr size_t MAX_BLOCK_SIZE{ MIN_BLOCK_SIZE << (CLASS_COUNT - 1) };
+
+	/// Maximum number of free blocks kept by a thread cache for a size class.
+	static constexpr size_t CACHE_CAPACITY{ 64 };
+
+	/// Number of blocks exchanged in one go between a thread cache and the depot.
+	static constexpr size_t BATCH_SIZE{ CACHE_CAPACITY / 2 };
+
+	/// Maximum number of free blocks kept by the depot for a size class.
+	static constexpr size_t DEPOT_CAPACITY{ 1024 };
+
+	///
+	/// Counters of the pool.
+	///
+	struct Statistics
+	{
+		/// Number of allocations served by a thread cache or the depot.
+		uint64_t hits{ 0 };
+
+		/// Number of allocations served by the heap.
+		uint64_t misses{ 0 };
+
+		/// Number of allocations larger than the largest size class (included in misses).
+		uint64_t oversized{ 0 };
+	};
+
+	// Construction, destruction
+
+private:
+
+	/// Constructor.
+	MessagePool();
+
+	/// Destructor.
+	~MessagePool();
+
+public:
+
+	/// @cond
+	MessagePool(
+		const MessagePool& other) = delete;
+
+	MessagePool& operator=(
+		const MessagePool& other) = delete;
+	/// @endcond
+
+	// Operations
+
+public:
+
+	/// Get access to the unique instance of the pool.
+	///
+	/// @return The instance of the pool.
+	///
+	/// @remarks The instance is never destroyed so that messages released
+	/// during the termination of the process can still be returned to it.
+	static MessagePool& instance();
+
+	/// Allocate a block.
+	///
+	/// @param size The number of bytes to be stored in the block.
+	///
+	/// @return Pointer on the block.
+	uint8_t* allocate(
+		size_t size);
+
+	/// Release a block previously obtained with allocate().
+	///
+	/// @param block Pointer on the block (can be nullptr).
+	/// @param size The size that was requested when allocating the block.
+	void release(
+		uint8_t* block,
+		size_t   size);
+
+	/// Get the counters of the pool.
+	///
+	/// @return The counters aggregated for all the threads.
+	Statistics statistics() const;
+
+	/// Get the size class of a request.
+	///
+	/// @param size The number of bytes to be stored.
+	///
+	/// @return The index of the size class, CLASS_COUNT when the request is larger
+	/// than the largest size class.
+	static size_t classIndex(
+		size_t size);
+
+	// Private definitions
+
+private:
+
+	/// Cache of free blocks owned by a thread.
+	struct ThreadCache;
+
+	/// Get the cache of the calling thread.
+	///
+	/// @return The cache of the calling thread, nullptr when it has already
+	/// been destroyed (the thread terminates).
+	static ThreadCache* threadCache();
+
+	/// Allocate a block without the cache of the thread (from the depot or
+	/// the heap).
+	///
+	/// @param size The number of bytes to be stored in the block.
+	///
+	/// @return Pointer on the block.
+	uint8_t* allocateShared(
+		size_t size);
+
+	/// Release a block without the cache of the thread (to the depot or the
+	/// heap).
+	///
+	/// @param block Pointer on the block.
+	/// @param index The index of the size class of the block.
+	void releaseShared(
+		uint8_t* block,
+		size_t   index);
+
+	/// Register a new thread cache.
+	///
+	/// @param cache The cache to register.
+	void attach(
+		ThreadCache* cache);
+
+	/// Unregister a thread cache when its thread terminates.
+	///
+	/// @param cache The cache to unregister.
+	void detach(
+		ThreadCache* cache);
+
+	/// Move a batch of free blocks from the depot to a thread cache.
+	///
+	/// @param index The index of the size class.
+	/// @param blocks The free blocks of the thread cache.
+	void refill(
+		size_t                 index,
+		std::vector<uint8_t*>& blocks);
+
+	/// Move a batch of free blocks from a thread cache to the depot.
+	///
+	/// @param index The index of the size class.
+	/// @param blocks The free blocks of the thread cache.
+	/// @param count The number of blocks to move.
+	void drain(
+		size_t                 index,
+		std::vector<uint8_t*>& blocks,
+		size_t                 count);
+
+	// Private attributes
+
+private:
+
+	/// The mutex to protect the access to the depot.
+	std::mutex                                     _mtxDepot;
+
+	/// The free blocks shared by all the threads for each size class.
+	std::array<std::vector<uint8_t*>, CLASS_COUNT> _depot;
+
+	/// The mutex to protect the access to the collection of thread caches.
+	mutable std::mutex                             _mtxCaches;
+
+	/// The caches of the running threads.
+	std::list<ThreadCache*>                        _caches;
+
+	/// The counters of the threads that are terminated.
+	Statistics                                     _retired;
+};
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,215 @@
+///
+/// @file MessagePtr.h
+///
+/// Declaration of the MessagePtr class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "Message.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Handle to share a message created with Message::create().
+///
+/// The reference counter is stored in the message itself (intrusive reference
+/// counting) so that sharing a message does not require any additional
+/// allocation.
+///
+/// The conversions from and to std::shared_ptr<Message> are provided to support
+/// the blocks that still use the legacy interfaces.
+///
+class MessagePtr
+{
+	// Construction, destruction
+
+public:
+
+	/// Default constructor (null handle).
+	MessagePtr() noexcept = default;
+
+	/// Constructor of a null handle.
+	MessagePtr(
+		std::nullptr_t) noexcept
+	{
+	}
+
+	/// Copy constructor.
+	///
+	/// @param other Object to be copied.
+	MessagePtr(
+		const MessagePtr& other) noexcept
+		: _message(other._message)
+	{
+		if (_message != nullptr)
+		{
+			_message->addRef();
+		}
+	}
+
+	/// Move constructor.
+	///
+	/// @param other Object to be acquired.
+	MessagePtr(
+		MessagePtr&& other) noexcept
+		: _message(other._message)
+	{
+		other._message = nullptr;
+	}
+
+	/// Constructor from a message shared with a std::shared_ptr (legacy).
+	///
+	/// The message is shared without copy when it has been obtained with
+	/// share(), otherwise its payload is copied in a new message.
+	///
+	/// @param message The message to be converted.
+	MessagePtr(
+		const std::shared_ptr<Message>& message);
+
+	/// Destructor.
+	~MessagePtr()
+	{
+		if (_message != nullptr)
+		{
+			_message->release();
+		}
+	}
+
+	// Accessors
+
+public:
+
+	/// Access to the message.
+	///
+	/// @return Pointer on the message (nullptr for a null handle).
+	Message* get() const noexcept { return _message; }
+
+	/// Access to the message.
+	///
+	/// @return Pointer on the message.
+	Message* operator->() const noexcept { return _message; }
+
+	/// Access to the message.
+	///
+	/// @return Reference on the message.
+	Message& operator*() const noexcept { return *_message; }
+
+	/// Check if the handle references a message.
+	///
+	/// @return true if the handle references a message.
+	explicit operator bool() const noexcept { return _message != nullptr; }
+
+	// Operators
+
+public:
+
+	/// Copy operator.
+	///
+	/// @param other Object to be copied.
+	///
+	/// @return This object.
+	MessagePtr& operator=(
+		const MessagePtr& other) noexcept
+	{
+		MessagePtr(other).swap(*this);
+
+		return *this;
+	}
+
+	/// Move operator.
+	///
+	/// @param other Object to be moved.
+	///
+	/// @return This object.
+	MessagePtr& operator=(
+		MessagePtr&& other) noexcept
+	{
+		MessagePtr(std::move(other)).swap(*this);
+
+		return *this;
+	}
+
+	/// Comparison operator.
+	///
+	/// @param other Object to be compared.
+	///
+	/// @return true if both handles reference the same message.
+	bool operator==(
+		const MessagePtr& other) const noexcept = default;
+
+	// Operations
+
+public:
+
+	/// Release the reference on the message.
+	void reset() noexcept
+	{
+		MessagePtr().swap(*this);
+	}
+
+	/// Exchange the content of two handles.
+	///
+	/// @param other The other handle.
+	void swap(
+		MessagePtr& other) noexcept
+	{
+		std::swap(_message, other._message);
+	}
+
+	/// Share the message with a std::shared_ptr (legacy).
+	///
+	/// The std::shared_ptr holds a reference on the message, the message is
+	/// not copied.
+	///
+	/// @return The shared pointer on the message.
+	std::shared_ptr<Message> share() const;
+
+	// Private definitions
+
+private:
+
+	friend class Message;
+
+	/// Deleter of the std::shared_ptr obtained with share().
+	struct Owner;
+
+	/// Constructor from a message created with Message::create().
+	///
+	/// @param message The message to be referenced.
+	explicit MessagePtr(
+		Message* message) noexcept
+		: _message(message)
+	{
+		_message->addRef();
+	}
+
+	// Private attributes
+
+private:
+
+	/// The referenced message.
+	Message* _message{ nullptr };
+};
+
+// Create a structured message.
+template <Structured T>
+inline MessagePtr Message::create(
+	const T& value)
+{
+	auto result = create(sizeof(T), reinterpret_cast<const uint8_t*>(&value));
+
+	result->_schema = schemaOf<T>();
+
+	return result;
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,469 @@
+///
+/// @file MpscRing.h
+///
+/// Declaration of the MpscRing class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace synapse {
+namespace framework {
+
+///
+/// Bounded lock-free queue with multiple producers and a single consumer.
+///
+/// The elements are stored in a ring of cells, each cell has a sequence number
+/// that tells if it is free or if it stores an element (algorithm of Dmitry
+/// Vyukov). Producers reserve a cell with a compare-and-swap on the tail of
+/// the ring. The head is also moved with a compare-and-swap so that a producer
+/// can discard the oldest element when the ring is full (tryPop()), the other
+/// operations on the head side are reserved to the single consumer.
+///
+/// The consumer parks when the ring is empty and the producers park when the
+/// ring is full, they are woken up with std::atomic::wait/notify (futex on
+/// Linux) only when a thread is actually parked.
+///
+/// @tparam T The type of the elements (default constructible and movable).
+///
+template <typename T>
+class MpscRing
+{
+	// Definitions
+
+public:
+
+	/// Size of a cache line (bytes).
+	static constexpr size_t CACHE_LINE_SIZE{ 64 };
+
+	// Construction, destruction
+
+public:
+
+	/// Constructor.
+	///
+	/// @param capacity The minimum number of elements stored by the ring (rounded
+	/// up to the next power of two).
+	MpscRing(
+		size_t capacity);
+
+	/// Destructor.
+	~MpscRing();
+
+	/// @cond
+	MpscRing(
+		const MpscRing& other) = delete;
+
+	MpscRing& operator=(
+		const MpscRing& other) = delete;
+	/// @endcond
+
+	// Accessors
+
+public:
+
+	/// Get the number of elements that can be stored by the ring.
+	///
+	/// @return The capacity of the ring.
+	size_t capacity() const { return _mask + 1; }
+
+	/// Check if the ring has been closed.
+	///
+	/// @return true if the ring is closed.
+	bool   closed() const { return _closed.load(std::memory_order_acquire); }
+
+	// Operations
+
+public:
+
+	/// Add an element to the ring if it is not full.
+	///
+	/// @param value The element to add (moved only on success).
+	///
+	/// @return true if the element has been added.
+	bool tryPush(
+		T& value);
+
+	/// Add an element to the ring, wait for a free cell if the ring is full.
+	///
+	/// @param value The element to add.
+	///
+	/// @return true if the element has been added, false if the ring has been
+	/// closed.
+	bool push(
+		T&& value);
+
+	/// Remove the oldest element of the ring.
+	///
+	/// This method can also be called by a producer to discard the oldest
+	/// element of a full ring.
+	///
+	/// @param value The removed element.
+	///
+	/// @return true if an element has been removed, false if the ring is empty.
+	bool tryPop(
+		T& value);
+
+	/// Remove all the elements of the ring (consumer only).
+	///
+	/// The producers are notified once for the whole batch.
+	///
+	/// @param values The container where the removed elements are appended.
+	/// @param max The maximum number of elements to remove.
+	///
+	/// @return The number of elements removed.
+	size_t tryPopAll(
+		std::vector<T>& values,
+		size_t          max = SIZE_MAX);
+
+	/// Check if the ring is empty (consumer only).
+	///
+	/// @return true if the ring is empty.
+	bool empty() const;
+
+	/// Get the number of elements in the ring (any thread).
+	///
+	/// @return An estimate of the number of elements (exact when the ring is
+	/// not modified concurrently).
+	size_t size() const;
+
+	/// Wait until the ring is not empty or closed (consumer only).
+	void wait();
+
+	/// Close the ring and wake up all the parked threads.
+	///
+	/// The elements can no longer be pushed with push(), the elements already
+	/// in the ring can still be removed.
+	void close();
+
+	// Private definitions
+
+private:
+
+	/// A cell of the ring.
+	struct Cell
+	{
+		/// The sequence number of the cell.
+		std::atomic<size_t> sequence;
+
+		/// The element stored in the cell.
+		T                   value;
+	};
+
+	/// Remove the oldest element of the ring without notifying the producers.
+	///
+	/// @param value The removed element.
+	///
+	/// @return true if an element has been removed, false if the ring is empty.
+	bool popOne(
+		T& value);
+
+	/// Wake up the consumer if it is parked (after an element has been added).
+	void notifyConsumer();
+
+	/// Wake up the producers if they are parked (after an element has been removed).
+	void notifyProducers();
+
+	// Private attributes
+
+private:
+
+	/// The mask to get the index of a cell from a position.
+	size_t                                          _mask;
+
+	/// The cells of the ring.
+	std::unique_ptr<Cell[]>                         _cells;
+
+	/// The position of the next cell to be reserved by a producer.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t>    _tail{ 0 };
+
+	/// The position of the next cell to be read by the consumer.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t>    _head{ 0 };
+
+	/// Counter incremented to wake up the consumer.
+	alignas(CACHE_LINE_SIZE) std::atomic<uint32_t>  _notEmpty{ 0 };
+
+	/// Indicates that the consumer is parked (or about to be).
+	std::atomic<bool>                               _consumerWaiting{ false };
+
+	/// Counter incremented to wake up the producers.
+	alignas(CACHE_LINE_SIZE) std::atomic<uint32_t>  _notFull{ 0 };
+
+	/// Indicates that producers are parked (or about to be).
+	std::atomic<bool>                               _producersWaiting{ false };
+
+	/// Indicates that the ring has been closed.
+	std::atomic<bool>                               _closed{ false };
+};
+
+// Constructor.
+template <typename T>
+MpscRing<T>::MpscRing(
+	size_t capacity)
+	: _mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+	  _cells(std::make_unique<Cell[]>(_mask + 1))
+{
+	for (size_t index = 0; index <= _mask; ++index)
+	{
+		_cells[index].sequence.store(index, std::memory_order_relaxed);
+	}
+}
+
+// Destructor.
+template <typename T>
+MpscRing<T>::~MpscRing()
+{
+}
+
+// Add an element to the ring if it is not full.
+template <typename T>
+bool MpscRing<T>::tryPush(
+	T& value)
+{
+	auto position = _tail.load(std::memory_order_relaxed);
+	bool result   = false;
+
+	while (true)
+	{
+		auto& cell     = _cells[position & _mask];
+		auto  sequence = cell.sequence.load(std::memory_order_acquire);
+		auto  diff     = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		// The cell is free, try to reserve it.
+		if (diff == 0)
+		{
+			if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell.value = std::move(value);
+				cell.sequence.store(position + 1, std::memory_order_release);
+				result = true;
+				break;
+			}
+		}
+		// The cell still stores an element pushed one lap before: the ring is full.
+		else if (diff < 0)
+		{
+			break;
+		}
+		// Another producer reserved the cell, try again with the new tail.
+		else
+		{
+			position = _tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (result)
+	{
+		notifyConsumer();
+	}
+
+	return result;
+}
+
+// Add an element to the ring, wait for a free cell if the ring is full.
+template <typename T>
+bool MpscRing<T>::push(
+	T&& value)
+{
+	bool result = false;
+
+	while (!closed())
+	{
+		if (tryPush(value))
+		{
+			result = true;
+			break;
+		}
+
+		// Announce that a producer is about to park then check again the ring
+		// to be sure not to miss the wake up of the consumer.
+		auto epoch = _notFull.load(std::memory_order_acquire);
+
+		_producersWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (tryPush(value))
+		{
+			result = true;
+			break;
+		}
+		if (!closed())
+		{
+			_notFull.wait(epoch, std::memory_order_acquire);
+		}
+	}
+
+	return result;
+}
+
+// Remove the oldest element of the ring.
+template <typename T>
+bool MpscRing<T>::tryPop(
+	T& value)
+{
+	bool result = popOne(value);
+
+	if (result)
+	{
+		notifyProducers();
+	}
+
+	return result;
+}
+
+// Remove all the elements of the ring (consumer only).
+template <typename T>
+size_t MpscRing<T>::tryPopAll(
+	std::vector<T>& values,
+	size_t          max)
+{
+	size_t result = 0;
+	T      value;
+
+	// Stop after one lap so that fast producers cannot keep the consumer busy.
+	while (result <= _mask && result < max && popOne(value))
+	{
+		values.push_back(std::move(value));
+		++result;
+	}
+	if (result > 0)
+	{
+		notifyProducers();
+	}
+
+	return result;
+}
+
+// Remove the oldest element of the ring without notifying the producers.
+template <typename T>
+bool MpscRing<T>::popOne(
+	T& value)
+{
+	auto position = _head.load(std::memory_order_relaxed);
+	bool result   = false;
+
+	while (true)
+	{
+		auto& cell     = _cells[position & _mask];
+		auto  sequence = cell.sequence.load(std::memory_order_acquire);
+		auto  diff     = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+		// The cell stores an element, try to take it.
+		if (diff == 0)
+		{
+			if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				value = std::move(cell.value);
+				cell.sequence.store(position + _mask + 1, std::memory_order_release);
+				result = true;
+				break;
+			}
+		}
+		// The cell has not been written yet: the ring is empty.
+		else if (diff < 0)
+		{
+			break;
+		}
+		// Another thread took the element, try again with the new head.
+		else
+		{
+			position = _head.load(std::memory_order_relaxed);
+		}
+	}
+
+	return result;
+}
+
+// Check if the ring is empty (consumer only).
+template <typename T>
+bool MpscRing<T>::empty() const
+{
+	auto position = _head.load(std::memory_order_relaxed);
+
+	return _cells[position & _mask].sequence.load(std::memory_order_acquire) != position + 1;
+}
+
+// Get the number of elements in the ring.
+template <typename T>
+size_t MpscRing<T>::size() const
+{
+	auto head = _head.load(std::memory_order_relaxed);
+	auto tail = _tail.load(std::memory_order_relaxed);
+
+	// The cells reserved by the producers are counted even if not yet written.
+	return tail > head ? std::min<size_t>(tail - head, _mask + 1) : 0;
+}
+
+// Wait until the ring is not empty or closed (consumer only).
+template <typename T>
+void MpscRing<T>::wait()
+{
+	// Announce that the consumer is about to park then check again the ring
+	// to be sure not to miss the wake up of a producer.
+	auto epoch = _notEmpty.load(std::memory_order_acquire);
+
+	_consumerWaiting.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (empty() && !closed())
+	{
+		_notEmpty.wait(epoch, std::memory_order_acquire);
+	}
+	_consumerWaiting.store(false, std::memory_order_relaxed);
+}
+
+// Close the ring and wake up all the parked threads.
+template <typename T>
+void MpscRing<T>::close()
+{
+	_closed.store(true, std::memory_order_seq_cst);
+
+	_notEmpty.fetch_add(1, std::memory_order_release);
+	_notEmpty.notify_all();
+	_notFull.fetch_add(1, std::memory_order_release);
+	_notFull.notify_all();
+}
+
+// Wake up the consumer if it is parked.
+template <typename T>
+void MpscRing<T>::notifyConsumer()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// Only the first producer that sees the consumer parked wakes it up.
+	if (_consumerWaiting.load(std::memory_order_relaxed) &&
+		_consumerWaiting.exchange(false, std::memory_order_relaxed))
+	{
+		_notEmpty.fetch_add(1, std::memory_order_release);
+		_notEmpty.notify_one();
+	}
+}
+
+// Wake up the producers if they are parked.
+template <typename T>
+void MpscRing<T>::notifyProducers()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// All the parked producers are woken up at once, those that still find the
+	// ring full park again and set the flag again.
+	if (_producersWaiting.load(std::memory_order_relaxed) &&
+		_producersWaiting.exchange(false, std::memory_order_relaxed))
+	{
+		_notFull.fetch_add(1, std::memory_order_release);
+		_notFull.notify_all();
+	}
+}
+
+} // namespace framework
+} // namespace synapse
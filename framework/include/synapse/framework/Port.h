@@ -10,8 +10,11 @@
 ///
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "IBlock.h"
 #include "IPort.h"
@@ -38,9 +41,12 @@ public:
 	///
 	/// @param[in] name Name of the port.
 	/// @param[in] block Pointer to the associated block.
+	/// @param[in] id Identifier of the port (stamped in the metadata of the
+	/// messages issued by the port).
 	Port(
 		const std::string& name,
-		IBlock*            block);
+		IBlock*            block,
+		uint32_t           id);
 
 	/// Destructor.
 	virtual ~Port();
@@ -59,15 +65,33 @@ public:
 	/// @return Pointer on associated block.
 	IBlock*            block() const { return _block; }
 
+	/// Get the identifier of the port.
+	///
+	/// @return The identifier of the port.
+	uint32_t           id() const { return _id; }
+
+	/// Get the schema of the messages issued by the port.
+	///
+	/// @return The identifier of the schema, RAW_SCHEMA for raw messages.
+	SchemaId           schema() const { return _schema; }
+
+	/// Get the routes attached to this port (its fan-out table).
+	///
+	/// @return The routes, in the order of attachment.
+	const std::vector<Route*>& routes() const { return _routes; }
+
 	// Implementation of IPort
 
 public:
 
 	/// Forward a message to destinations attached to this port.
 	///
+	/// The metadata of a message that has not yet been dispatched are stamped
+	/// with the identifier of the port and its next sequence number.
+	///
 	/// @param[in] message The message to dispatch.
 	void dispatch(
-		const std::shared_ptr<Message>& message) override final;
+		const MessagePtr& message) override final;
 
 	// Operations
 
@@ -79,18 +103,33 @@ public:
 	void attach(
 		Route* route);
 
+	/// Declare the schema of the messages issued by the port.
+	///
+	/// @param[in] schema The identifier of the schema.
+	void setSchema(
+		SchemaId schema) { _schema = schema; }
+
 	// Private attributes
 
 private:
 
 	/// Name of the port.
-	std::string       _name;
+	std::string           _name;
 
 	/// Pointer to the associated block.
-	IBlock*           _block;
+	IBlock*               _block;
+
+	/// Identifier of the port.
+	uint32_t              _id;
+
+	/// The schema of the messages issued by the port.
+	SchemaId              _schema{ RAW_SCHEMA };
+
+	/// The sequence number of the last message issued by the port.
+	std::atomic<uint32_t> _sequence{ 0 };
 
-	/// The collection of routes attached to this port.
-	std::list<Route*> _routes;
+	/// The routes attached to this port (contiguous to be walked quickly).
+	std::vector<Route*>   _routes;
 };
 
 } // namespace framework
@@ -0,0 +1,113 @@
+///
+/// @file QueuePolicy.h
+///
+/// Declaration of the QueuePolicy and OverflowCounters classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace synapse {
+namespace framework {
+
+///
+/// What to do with a message when the queue of a sink or a dispatcher is full.
+///
+/// The block policy is allowed whatever the thread of the producer and of the
+/// consumer. A producer on a dedicated thread (a source, a sink or a
+/// dispatcher with its own thread) sleeps until there is room. A producer
+/// running on a thread of an executor (the shared one or a group) does not
+/// sleep: it executes the other pending tasks of its executor, the consumer
+/// among them, until there is room.
+///
+/// Queued routes that form a cycle can still stall with the block policy when
+/// all the queues of the cycle are full, one of them shall drop messages.
+///
+enum class OverflowPolicy
+{
+	/// The producer waits until there is room in the queue (backpressure).
+	block,
+	/// The new message is discarded.
+	dropNewest,
+	/// The oldest message of the queue is discarded to make room.
+	dropOldest,
+};
+
+///
+/// Limits of the queue of a sink or a dispatcher.
+///
+struct QueuePolicy
+{
+	/// Maximum number of messages stored in the queue (0 for no limit).
+	size_t         capacity{ 0 };
+
+	/// What to do when the queue is full.
+	OverflowPolicy overflow{ OverflowPolicy::block };
+
+	/// @cond
+	bool operator==(
+		const QueuePolicy& other) const = default;
+	/// @endcond
+};
+
+///
+/// Counters of the overflows of a queue.
+///
+/// The counters are written by the producers only when the queue is full,
+/// they can be read by statistics() from any thread.
+///
+class OverflowCounters
+{
+	// Definitions
+
+public:
+
+	///
+	/// Snapshot of the counters.
+	///
+	struct Statistics
+	{
+		/// Number of times a producer found the queue full and waited for room
+		/// (or executed other tasks meanwhile).
+		uint64_t blocked{ 0 };
+
+		/// Number of messages discarded.
+		uint64_t dropped{ 0 };
+	};
+
+	// Operations
+
+public:
+
+	/// Count a producer that waits for room in the queue.
+	void blocked() { _blocked.fetch_add(1, std::memory_order_relaxed); }
+
+	/// Count a discarded message.
+	void dropped() { _dropped.fetch_add(1, std::memory_order_relaxed); }
+
+	/// Get the counters.
+	///
+	/// @return A snapshot of the counters.
+	Statistics statistics() const
+	{
+		return { _blocked.load(std::memory_order_relaxed), _dropped.load(std::memory_order_relaxed) };
+	}
+
+	// Private attributes
+
+private:
+
+	/// Number of times a producer waited for room in the queue.
+	std::atomic<uint64_t> _blocked{ 0 };
+
+	/// Number of messages discarded.
+	std::atomic<uint64_t> _dropped{ 0 };
+};
+
+} // namespace framework
+} // namespace synapse
@@ -34,6 +34,10 @@ public:
 	/// The name of the function to prepare the logger of the module.
 	static const char constexpr* PREPARE_LOGGER_FUNCTION{ "prepareLogger" };
 
+	/// The suffix of the manifest of a module (the extension of the module is
+	/// replaced by it), the manifest lists the block classes of the module.
+	static const char constexpr* MANIFEST_EXTENSION{ ".blocks.json" };
+
 	/// Defintion of the signature of the function to create a component.
 	using CreateFunction = std::add_pointer<IBlock*(const std::string&)>::type;
 
@@ -105,6 +109,14 @@ public:
 	const Registry::BlockDescription& find(
 		const std::string& className) const;
 
+	/// Check if a class name is registered.
+	///
+	/// @param className Class name.
+	///
+	/// @return true if a description is registered with this class name.
+	bool contains(
+		const std::string& className) const { return _descriptions.find(className) != _descriptions.end(); }
+
 	// Private attributes
 
 private:
@@ -0,0 +1,399 @@
+///
+/// @file ReplicaSet.h
+///
+/// Declaration of the ReplicaSet class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "BaseBlock.h"
+#include "Executor.h"
+#include "Fiber.h"
+#include "IConsumer.h"
+#include "ITask.h"
+#include "MpscRing.h"
+#include "Port.h"
+#include "QueuePolicy.h"
+#include "Route.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Key used to select the replica that processes a message.
+///
+enum class ShardKey
+{
+	/// The origin port of the message: the messages of a port are processed
+	/// by the same replica, in order.
+	port,
+	/// A hash of a range of bytes of the payload (a flow identifier).
+	bytes,
+	/// The replicas are used in turn (stateless fibers).
+	roundRobin,
+};
+
+///
+/// Sharding policy of a replica set.
+///
+struct ShardPolicy
+{
+	/// The key of the messages.
+	ShardKey key{ ShardKey::port };
+
+	/// Offset of the hashed bytes in the payload (ShardKey::bytes).
+	size_t   offset{ 0 };
+
+	/// Number of hashed bytes (ShardKey::bytes, 0 up to the end of the payload).
+	size_t   length{ 0 };
+
+	/// @cond
+	bool operator==(
+		const ShardPolicy& other) const = default;
+	/// @endcond
+};
+
+///
+/// Set of replicas of a fiber processing messages in parallel.
+///
+/// The set stands for the replicated fiber in the application: the routes to
+/// the fiber feed the set, which shards the messages over the replicas. Each
+/// replica has a queue scheduled on the executor, so the replicas run in
+/// parallel while each of them consumes its messages one at a time.
+///
+/// Without resequencing, the outputs of a replica are dispatched by its own
+/// ports. With resequencing, they are held by the set and released on its own
+/// ports in the order the inputs were received: an output is filed under the
+/// input being consumed by the replica that emits it (whatever the thread
+/// that emits it), the replicas shall then emit their outputs while they
+/// consume the input.
+///
+/// consume() never waits for a replica: when the queue of the replica is full,
+/// the overflow policy of the set applies (see OverflowPolicy).
+///
+class ReplicaSet :
+	public BaseBlock,
+	public IConsumer
+{
+	// Construction, destruction
+
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the replicated fiber.
+	/// @param replicas The replicas (at least one, not owned).
+	/// @param policy The sharding policy.
+	/// @param resequence Indicates that the outputs are released in order.
+	/// @param queuePolicy The limits of the queue of each replica.
+	///
+	/// @throw std::invalid_argument If there is no replica or the capacity is 0.
+	ReplicaSet(
+		const std::string&         name,
+		const std::vector<Fiber*>& replicas,
+		const ShardPolicy&         policy,
+		bool                       resequence,
+		const QueuePolicy&         queuePolicy = DEFAULT_QUEUE_POLICY);
+
+	/// Destructor.
+	virtual ~ReplicaSet();
+
+	// Constants
+
+public:
+
+	/// Default number of messages queued for each replica.
+	static constexpr size_t      DEFAULT_CAPACITY = 1024;
+
+	/// Default limits of the queue of a replica (the producers wait for room,
+	/// see OverflowPolicy::block for the producers running on an executor).
+	static constexpr QueuePolicy DEFAULT_QUEUE_POLICY{ DEFAULT_CAPACITY, OverflowPolicy::block };
+
+	// Implementation of IBlock
+
+public:
+
+	/// Ask the block to prepare to be deleted (terminate all pending operations).
+	void shutdown() override;
+
+	// Implementation of IConsumer
+
+public:
+
+	/// Check if the consumer accepts concurrent calls to consume().
+	///
+	/// @return true, the messages are queued in the rings of the replicas.
+	bool isThreadSafe() const override final { return true; }
+
+	/// Get the schema of the messages accepted by the consumer.
+	///
+	/// @return The schema accepted by the replicas.
+	SchemaId schema() const override final { return _replicas.front()->schema(); }
+
+	/// Consume a message (queue it for its replica).
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override final;
+
+	// Accessors
+
+public:
+
+	/// Get the replicas.
+	///
+	/// @return The replicas, in the order of the shards.
+	const std::vector<Fiber*>&   replicas() const { return _replicas; }
+
+	/// Get the sharding policy.
+	///
+	/// @return The sharding policy.
+	const ShardPolicy&           policy() const { return _policy; }
+
+	/// Check if the outputs are released in the order of the inputs.
+	///
+	/// @return true if the outputs are resequenced.
+	bool                         resequences() const { return _resequence; }
+
+	/// Get the limits of the queue of each replica.
+	///
+	/// @return The queue policy.
+	const QueuePolicy&           queuePolicy() const { return _queuePolicy; }
+
+	/// Get the counters of the overflows of the queues of the replicas.
+	///
+	/// @return A snapshot of the counters.
+	OverflowCounters::Statistics overflows() const { return _overflows.statistics(); }
+
+	/// Get the number of outputs held until the previous inputs are processed.
+	///
+	/// @return The number of held outputs.
+	size_t                       held() const;
+
+	// Operations
+
+public:
+
+	/// Set the executor that schedules the replicas (before the first message).
+	///
+	/// @param executor The executor.
+	void   setExecutor(
+		  Executor* executor) { _executor = executor; }
+
+	/// Get the replica that processes a message.
+	///
+	/// @param message The message.
+	///
+	/// @return The index of the replica.
+	size_t shardOf(
+		const MessagePtr& message);
+
+	/// Resequence the outputs of a port of the replicas.
+	///
+	/// The messages dispatched by the port of a replica are released on the
+	/// port of the set with the same name, after the outputs of the previous
+	/// inputs.
+	///
+	/// @param replicaPort The port of a replica.
+	/// @param output The port of the set.
+	///
+	/// @throw std::invalid_argument If the port is not a port of a replica.
+	void   bind(
+		  Port& replicaPort,
+		  Port& output);
+
+	// Implementation
+
+private:
+
+	///
+	/// Message queued for a replica.
+	///
+	struct Job
+	{
+		/// The message.
+		MessagePtr message;
+
+		/// The rank of the message among the inputs of the set.
+		uint64_t   ticket{ 0 };
+	};
+
+	///
+	/// Queue of a replica, scheduled on the executor.
+	///
+	struct Worker :
+		public ITask
+	{
+		/// Constructor.
+		///
+		/// @param set The replica set.
+		/// @param replica The replica.
+		/// @param capacity The number of queued messages.
+		Worker(
+			ReplicaSet& set,
+			Fiber&      replica,
+			size_t      capacity);
+
+		/// Process the queued messages.
+		void execute() override final;
+
+		/// The replica set.
+		ReplicaSet&       set;
+
+		/// The replica.
+		Fiber&                replica;
+
+		/// The queued messages.
+		MpscRing<Job>         jobs;
+
+		/// The messages being processed.
+		std::vector<Job>      batch;
+
+		/// Indicates that the worker has been submitted to the executor.
+		std::atomic<bool>     scheduled{ false };
+
+		/// The rank of the input being consumed by the replica.
+		std::atomic<uint64_t> ticket{ 0 };
+	};
+
+	///
+	/// Consumer of the outputs of a replica port (resequencing).
+	///
+	struct Output :
+		public IConsumer
+	{
+		/// Constructor.
+		///
+		/// @param set The replica set.
+		/// @param worker The worker of the replica that emits the outputs.
+		/// @param port The port of the set that releases the outputs.
+		Output(
+			ReplicaSet& set,
+			Worker&     worker,
+			Port&       port)
+			: set(set)
+			, worker(worker)
+			, port(port)
+		{
+		}
+
+		/// Check if the consumer accepts concurrent calls to consume().
+		bool isThreadSafe() const override final { return true; }
+
+		/// Hold an output until it can be released (filed under the input
+		/// being consumed by the replica).
+		void consume(
+			const MessagePtr& message) override final { set.hold(port, worker.ticket.load(), message); }
+
+		/// The replica set.
+		ReplicaSet& set;
+
+		/// The worker of the replica that emits the outputs.
+		Worker&     worker;
+
+		/// The port of the set that releases the outputs.
+		Port&       port;
+	};
+
+	///
+	/// Outputs of an input, held until the previous inputs are processed.
+	///
+	struct Pending
+	{
+		/// Indicates that the input has been processed.
+		bool                                     done{ false };
+
+		/// The outputs and the ports that release them.
+		std::vector<std::pair<Port*, MessagePtr>> outputs;
+	};
+
+	/// Hold an output until the previous inputs are processed.
+	///
+	/// An output of an input already released (emitted once the replica has
+	/// consumed the input) is dispatched at once.
+	///
+	/// @param port The port of the set that releases the output.
+	/// @param ticket The rank of the input the output belongs to.
+	/// @param message The output.
+	void hold(
+		Port&             port,
+		uint64_t          ticket,
+		const MessagePtr& message);
+
+	/// Mark an input as processed and release the outputs that are in order.
+	///
+	/// A single thread releases the outputs at a time, without holding any
+	/// lock while they are dispatched: the other threads leave their outputs
+	/// to it.
+	///
+	/// @param ticket The rank of the input.
+	void complete(
+		uint64_t ticket);
+
+	// Private attributes
+
+private:
+
+	/// The replicas.
+	std::vector<Fiber*>                  _replicas;
+
+	/// The sharding policy.
+	ShardPolicy                          _policy;
+
+	/// Indicates that the outputs are released in order.
+	bool                                 _resequence;
+
+	/// The limits of the queue of each replica.
+	QueuePolicy                          _queuePolicy;
+
+	/// The counters of the overflows of the queues.
+	OverflowCounters                     _overflows;
+
+	/// The queues of the replicas.
+	std::vector<std::unique_ptr<Worker>> _workers;
+
+	/// The executor that schedules the replicas.
+	Executor*                            _executor{ nullptr };
+
+	/// Indicates that the set is shutting down.
+	std::atomic<bool>                    _shutdown{ false };
+
+	/// The rank of the next input.
+	std::atomic<uint64_t>                _nextTicket{ 0 };
+
+	/// The next replica (ShardKey::roundRobin).
+	std::atomic<uint64_t>                _nextReplica{ 0 };
+
+	/// The consumers and routes of the resequenced ports.
+	std::vector<std::unique_ptr<Output>> _outputs;
+	std::vector<std::unique_ptr<Route>>  _routes;
+
+	/// The mutex to protect the held outputs.
+	mutable std::mutex                   _mutex;
+
+	/// The held outputs, by rank of input.
+	std::map<uint64_t, Pending>          _pending;
+
+	/// The rank of the next input to release.
+	uint64_t                             _nextRelease{ 0 };
+
+	/// The number of held outputs.
+	size_t                               _held{ 0 };
+
+	/// Indicates that a thread is releasing the outputs (so that they reach
+	/// the ports in order).
+	bool                                 _releasing{ false };
+};
+
+} // namespace framework
+} // namespace synapse
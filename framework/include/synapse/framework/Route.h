@@ -8,9 +8,14 @@
 ///
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <list>
+#include <string>
+#include <vector>
 
 #include "IConsumer.h"
+#include "RouteFilter.h"
 
 namespace synapse {
 namespace framework {
@@ -18,10 +23,29 @@ namespace framework {
 class Port;
 class Dispatcher;
 
+///
+/// Priority of the messages of a route in the queue of its dispatcher.
+///
+enum class RoutePriority
+{
+	/// Served first (alarms, positions).
+	high,
+	/// Default priority.
+	normal,
+	/// Served when the other lanes are empty (bulk traffic), or when the
+	/// starvation guard of the dispatcher requires it.
+	low,
+};
+
 ///
 /// A route is the path to transfer messages from some blocks to
 /// destination blocks.
 ///
+/// A route without dispatcher is inline: the destinations consume the
+/// messages in the thread of the port that dispatches them. A queued route
+/// can be fused by the manager when it compiles the execution plan: it then
+/// becomes inline.
+///
 class Route
 {
 	// Construction, destruction
@@ -32,7 +56,8 @@ public:
 	///
 	/// @param[in] ports The list of sources ports.
 	/// @param[in] destinations The list of destinations blocks.
-	/// @param[in] dispatcher The distpatcher that will route the messages.
+	/// @param[in] dispatcher The distpatcher that will route the messages
+	/// (nullptr for an inline route).
 	Route(
 		const std::list<Port*>&      ports,
 		const std::list<IConsumer*>& destinations,
@@ -45,15 +70,78 @@ public:
 
 public:
 
+	/// Get the name of the route.
+	///
+	/// @return The name given in the configuration (empty if unnamed).
+	const std::string&             name() const { return _name; }
+
+	/// Set the name of the route (before the execution).
+	///
+	/// @param name The name given in the configuration.
+	void                           setName(
+		const std::string& name) { _name = name; }
+
 	/// Get the list of sources ports.
 	///
 	/// @return The list of sources ports.
-	const std::list<Port*>&      ports() const { return _ports; }
+	const std::list<Port*>&        ports() const { return _ports; }
 
 	/// Get the list of destinations blocks.
 	///
 	/// @return The list of destinations blocks.
-	const std::list<IConsumer*>& destinations() const { return _destinations; }
+	const std::vector<IConsumer*>& destinations() const { return _destinations; }
+
+	/// Check if the messages are consumed in the thread of the source port.
+	///
+	/// @return true if the route has no dispatcher.
+	bool                           isInline() const { return _dispatcher == nullptr; }
+
+	/// Check if the route was queued and has been fused into the call
+	/// sequence of its source.
+	///
+	/// @return true if the route has been fused.
+	bool                           isFused() const { return _fused; }
+
+	/// Get the dispatcher of the route.
+	///
+	/// @return The dispatcher, nullptr for an inline route.
+	Dispatcher*                    dispatcher() const { return _dispatcher; }
+
+	/// Get the priority of the messages in the queue of the dispatcher.
+	///
+	/// @return The priority of the route.
+	RoutePriority                  priority() const { return _priority; }
+
+	/// Set the priority of the messages in the queue of the dispatcher
+	/// (before the execution).
+	///
+	/// @param priority The priority of the route.
+	void                           setPriority(
+		RoutePriority priority) { _priority = priority; }
+
+	/// Get the filter of the messages.
+	///
+	/// @return The filter (empty if all the messages are accepted).
+	const RouteFilter&             filter() const { return _filter; }
+
+	/// Set the filter of the messages (before the execution).
+	///
+	/// @param filter The filter.
+	void                           setFilter(
+		const RouteFilter& filter)
+	{
+		_filter   = filter;
+		_filtered = !filter.empty();
+	}
+
+	/// Get the number of messages rejected by the filter.
+	///
+	/// @return The number of rejected messages.
+	uint64_t                       rejected() const { return _rejected.load(std::memory_order_relaxed); }
+
+	/// Make the route inline: the destinations consume the messages in the
+	/// thread of the source port (before the execution).
+	void                           fuse();
 
 	// Operation
 
@@ -61,24 +149,44 @@ public:
 
 	/// Dispatch a message to destinations.
 	///
+	/// The filter is evaluated first, in the thread of the source port.
+	///
 	/// @param message The message to dispatch.
 	/// @param source The port that issue the message.
 	void dispatch(
-		const std::shared_ptr<Message>& message,
-		const Port&                     source);
+		const MessagePtr& message,
+		const Port&       source);
 
 	// Private attributes
 
 private:
 
+	/// The name of the route (empty if unnamed).
+	std::string             _name;
+
 	/// The list of sources ports.
-	std::list<Port*>      _ports;
+	std::list<Port*>        _ports;
 
-	/// The list of destinations blocks.
-	std::list<IConsumer*> _destinations;
+	/// The destinations blocks (contiguous to be walked quickly).
+	std::vector<IConsumer*> _destinations;
 
 	/// The distpatcher that will route the messages.
-	Dispatcher*           _dispatcher;
+	Dispatcher*             _dispatcher;
+
+	/// The priority of the messages in the queue of the dispatcher.
+	RoutePriority           _priority{ RoutePriority::normal };
+
+	/// Indicates that the route has been fused into the call sequence of its source.
+	bool                    _fused{ false };
+
+	/// The filter of the messages.
+	RouteFilter             _filter;
+
+	/// Indicates that the filter has predicates.
+	bool                    _filtered{ false };
+
+	/// The number of messages rejected by the filter.
+	std::atomic<uint64_t>   _rejected{ 0 };
 };
 
 } // namespace framework
@@ -0,0 +1,101 @@
+///
+/// @file RouteFilter.h
+///
+/// Declaration of the RouteFilter class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Message.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Predicates on the payload of the messages of a route.
+///
+/// The filter is evaluated by the thread of the source port before the
+/// message is queued: the rejected messages cost neither a queue slot nor a
+/// dispatcher hop. A message is accepted when all the predicates hold.
+///
+struct RouteFilter
+{
+	///
+	/// Expected value of a byte of the payload.
+	///
+	struct ByteMatch
+	{
+		/// Offset of the byte in the payload.
+		size_t  offset{ 0 };
+
+		/// Expected value.
+		uint8_t value{ 0 };
+	};
+
+	/// The payload starts with one of these prefixes (no constraint if empty).
+	std::vector<std::string> prefixes;
+
+	/// Minimum size of the payload.
+	size_t                   minSize{ 0 };
+
+	/// Maximum size of the payload.
+	size_t                   maxSize{ SIZE_MAX };
+
+	/// Bytes the payload shall contain.
+	std::vector<ByteMatch>   bytes;
+
+	/// Check if the filter has no predicate.
+	///
+	/// @return true if all the messages are accepted.
+	bool empty() const { return prefixes.empty() && minSize == 0 && maxSize == SIZE_MAX && bytes.empty(); }
+
+	/// Evaluate the predicates on a message.
+	///
+	/// @param message The message.
+	///
+	/// @return true if the message is accepted.
+	bool accepts(
+		const Message& message) const
+	{
+		auto size    = message.size();
+		auto payload = message.payload();
+
+		if (size < minSize || size > maxSize)
+		{
+			return false;
+		}
+
+		for (const auto& byte : bytes)
+		{
+			if (byte.offset >= size || payload[byte.offset] != byte.value)
+			{
+				return false;
+			}
+		}
+
+		if (prefixes.empty())
+		{
+			return true;
+		}
+
+		for (const auto& prefix : prefixes)
+		{
+			if (prefix.size() <= size && std::memcmp(payload, prefix.data(), prefix.size()) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+} // namespace framework
+} // namespace synapse
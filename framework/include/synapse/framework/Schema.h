@@ -0,0 +1,61 @@
+///
+/// @file Schema.h
+///
+/// Declaration of the schemas of the structured payloads.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace synapse {
+namespace framework {
+
+/// Identifier of the layout of the payload of a message.
+using SchemaId = uint16_t;
+
+/// Schema of the raw messages (bytes without a declared layout).
+static constexpr SchemaId RAW_SCHEMA = 0;
+
+/// Alignment guaranteed for the payload of a message (bytes).
+static constexpr size_t PAYLOAD_ALIGNMENT = 8;
+
+///
+/// A structured payload is a fixed-layout struct passed as is between the
+/// blocks of a process, it declares its schema:
+///
+///     struct Position
+///     {
+///         static constexpr SchemaId SCHEMA_ID = 1;
+///
+///         double latitude;
+///         double longitude;
+///     };
+///
+/// The identifiers are chosen by the modules, they shall be unique in the
+/// application and different from RAW_SCHEMA.
+///
+template <typename T>
+concept Structured = std::is_trivially_copyable_v<T> && alignof(T) <= PAYLOAD_ALIGNMENT && requires {
+	{ T::SCHEMA_ID } -> std::convertible_to<SchemaId>;
+};
+
+/// Get the schema of a structured payload.
+///
+/// @tparam T The type of the payload.
+///
+/// @return The identifier of the schema.
+template <Structured T>
+constexpr SchemaId schemaOf()
+{
+	static_assert(T::SCHEMA_ID != RAW_SCHEMA, "the schema of a structured payload cannot be RAW_SCHEMA");
+
+	return T::SCHEMA_ID;
+}
+
+} // namespace framework
+} // namespace synapse
@@ -9,26 +9,61 @@
 #pragma once
 
 #include <atomic>
-#include <list>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 
 #include "BaseBlock.h"
+#include "BatchCounters.h"
 #include "IConsumer.h"
 #include "IRunnable.h"
+#include "ITask.h"
+#include "QueuePolicy.h"
+#include "WaitStrategy.h"
 
 namespace synapse {
 namespace framework {
 
+class Executor;
+
 ///
 /// A sink is a block that process messages received from
 /// other blocks.
 ///
+/// The runnable takes all the pending messages at once (in a single critical
+/// section) and then processes them without holding the lock. The queue and
+/// the batch are deques swapped on each batch: a message has no allocation of
+/// its own and the oldest one is discarded in constant time.
+///
+/// When an executor is set, the sink has no thread of its own: it is submitted
+/// as a task to the executor when messages are pending (run() is not used).
+///
+/// The queue of messages is unbounded unless a queue policy is set. When the
+/// queue is full, the overflow policy tells if the producer waits or if a
+/// message is discarded. The batch being processed is not counted in the
+/// queue: the sink holds at most twice the capacity. A producer running on a
+/// thread of an executor does not wait: it executes the other pending tasks of
+/// the executor until there is room.
+///
+/// The wait strategy tells if the runnable polls the queue before sleeping on
+/// the condition variable.
+///
 class Sink :
 	public BaseBlock,
 	public IConsumer,
-	public IRunnable
+	public IRunnable,
+	public ITask
 {
+	// Definitions
+
+public:
+
+	/// Period at which a producer running on a thread of an executor checks the
+	/// queue when it has no task to execute.
+	static constexpr std::chrono::milliseconds ROOM_POLL_PERIOD{ 1 };
+
 	// Construction, destruction
 
 public:
@@ -59,15 +94,73 @@ public:
 	/// execution of the runnable.
 	void run() override final;
 
+	// Implementation of ITask
+
+public:
+
+	/// Process the pending messages (when the sink is scheduled by an executor).
+	void execute() override final;
+
+	// Accessors
+
+public:
+
+	/// Get the distribution of the size of the batches of messages.
+	///
+	/// @return The counters of the batches processed by the runnable.
+	BatchCounters::Statistics    statistics() const { return _batches.statistics(); }
+
+	/// Get the counters of the overflows of the queue.
+	///
+	/// @return The counters of the queue of messages.
+	OverflowCounters::Statistics overflows() const { return _overflows.statistics(); }
+
+	/// Get the limits of the queue of messages.
+	///
+	/// @return The queue policy of the sink.
+	QueuePolicy                  queuePolicy() const;
+
+	/// Get the way the runnable waits for messages.
+	///
+	/// @return The wait strategy of the sink.
+	const WaitStrategy&          waitStrategy() const { return _waitStrategy; }
+
+	// Operations
+
+public:
+
+	/// Set the limits of the queue of messages (before the execution).
+	///
+	/// @param policy The queue policy (capacity 0 for an unbounded queue).
+	void setQueuePolicy(
+		const QueuePolicy& policy);
+
+	/// Set the way the runnable waits for messages (before the execution).
+	///
+	/// @param strategy The wait strategy.
+	void setWaitStrategy(
+		const WaitStrategy& strategy) { _waitStrategy = strategy; }
+
+	/// Set the executor that schedules the sink (before the execution).
+	///
+	/// @param executor The executor (nullptr for a dedicated thread).
+	void setExecutor(
+		Executor* executor);
+
 	// Implementation of IConsumer
 
 public:
 
+	/// Check if the consumer accepts concurrent calls to consume().
+	///
+	/// @return true, the messages are stored in a queue protected by a mutex.
+	bool isThreadSafe() const override final { return true; }
+
 	/// Consume a message.
 	///
 	/// @param message[in] Message to be consumed.
 	void consume(
-		const std::shared_ptr<Message>& message) override final;
+		const MessagePtr& message) override final;
 
 	// Implementation
 
@@ -77,23 +170,68 @@ protected:
 	///
 	/// @param message[in] Message to be processed.
 	virtual void process(
-		const std::shared_ptr<Message>& message) = 0;
+		const MessagePtr& message) = 0;
+
+	// Private implementation
+
+private:
+
+	/// Process a batch of messages taken from the queue.
+	///
+	/// @param batch The messages to process (cleared on return).
+	void processBatch(
+		std::deque<MessagePtr>& batch);
+
+	/// Wait until there is room in the queue of messages or the sink is shut
+	/// down (overflow policy block).
+	///
+	/// @param lock The lock of the queue (held on entry and on return).
+	void waitForRoom(
+		std::unique_lock<std::mutex>& lock);
 
 	// Private attributes.
 
 private:
 
 	/// Indicates that a shutdown has been requested.
-	std::atomic<bool>                   _shutdown{ false };
+	std::atomic<bool>       _shutdown{ false };
 
 	/// The mutex to protect the access to the list of messages.
-	std::mutex                          _mtxMessages;
+	mutable std::mutex      _mtxMessages;
 
 	/// The condition variable to detect changes on the list of messages.
-	std::condition_variable             _cvMessages;
+	std::condition_variable _cvMessages;
+
+	/// The condition variable to detect room in the list of messages.
+	std::condition_variable _cvRoom;
+
+	/// The limits of the list of messages.
+	QueuePolicy             _queuePolicy;
+
+	/// The counters of the overflows of the list of messages.
+	OverflowCounters        _overflows;
+
+	/// The way the runnable waits for messages.
+	WaitStrategy            _waitStrategy;
+
+	/// Indicates that the list of messages is not empty (polled without the lock).
+	std::atomic<bool>       _pending{ false };
+
+	/// The executor that schedules the sink (nullptr for a dedicated thread).
+	Executor*               _executor{ nullptr };
+
+	/// Indicates that the sink has been submitted to the executor.
+	bool                    _scheduled{ false };
 
 	/// The list of messages.
-	std::list<std::shared_ptr<Message>> _messages;
+	std::deque<MessagePtr>  _messages;
+
+	/// The batch of messages being processed (swapped with the list of
+	/// messages).
+	std::deque<MessagePtr>  _batch;
+
+	/// The distribution of the size of the batches of messages.
+	BatchCounters           _batches;
 };
 
 } // namespace framework
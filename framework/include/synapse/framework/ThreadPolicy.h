@@ -0,0 +1,57 @@
+///
+/// @file ThreadPolicy.h
+///
+/// Declaration of the ThreadPolicy class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace synapse {
+namespace framework {
+
+///
+/// CPU affinity and scheduling policy of the thread of a runnable.
+///
+/// The policy is applied by the thread itself when it starts. Only Linux is
+/// supported; a real-time priority requires the CAP_SYS_NICE capability.
+///
+struct ThreadPolicy
+{
+	/// Maximum real-time priority.
+	static constexpr int MAX_PRIORITY = 99;
+
+	/// The cores the thread may run on (empty for any core).
+	std::vector<unsigned> cpus;
+
+	/// The SCHED_FIFO priority (0 for the default time-sharing policy).
+	int                   priority{ 0 };
+
+	/// Check if the policy changes anything.
+	///
+	/// @return true if neither the cores nor the priority are set.
+	bool empty() const { return cpus.empty() && priority == 0; }
+
+	/// Apply the policy to the calling thread.
+	///
+	/// @throw std::system_error if the system refuses the policy.
+	/// @throw std::invalid_argument if a core does not exist.
+	void apply() const;
+
+	/// Describe the cores and the scheduling policy of the calling thread.
+	///
+	/// @return A string like "cpus 2-3, SCHED_FIFO 50".
+	static std::string describeCurrentThread();
+
+	/// @cond
+	bool operator==(
+		const ThreadPolicy& other) const = default;
+	/// @endcond
+};
+
+} // namespace framework
+} // namespace synapse
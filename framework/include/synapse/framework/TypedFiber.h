@@ -0,0 +1,88 @@
+///
+/// @file TypedFiber.h
+///
+/// Declaration of the TypedFiber class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <format>
+#include <stdexcept>
+
+#include "Fiber.h"
+#include "Schema.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Fiber that consumes structured messages.
+///
+/// The fiber declares the schema it accepts, so that the manager rejects the
+/// routes from ports that issue another schema: the struct is read in place,
+/// the message is never parsed again.
+///
+/// @tparam T The type of the payload.
+///
+template <Structured T>
+class TypedFiber :
+	public Fiber
+{
+	// Construction, destruction
+
+public:
+
+	/// Constructor.
+	///
+	/// @param[in] name The name of the block.
+	explicit TypedFiber(
+		const std::string& name)
+		: Fiber(name)
+	{
+	}
+
+	// Implementation of IConsumer
+
+public:
+
+	using Fiber::consume;
+
+	/// Get the schema of the messages accepted by the consumer.
+	///
+	/// @return The schema of T.
+	SchemaId schema() const override final { return schemaOf<T>(); }
+
+	/// Consume a message (forward its struct).
+	///
+	/// @param message[in] Message to be consumed.
+	///
+	/// @throw std::logic_error If the message does not carry the schema of T.
+	void     consume(
+			const MessagePtr& message) override final
+	{
+		auto value = message->as<T>();
+
+		if (value == nullptr)
+		{
+			throw std::logic_error(std::format("block '{}': message of schema {} received, schema {} expected", name(), message->schema(), schemaOf<T>()));
+		}
+		consume(*value, message);
+	}
+
+	// Implementation
+
+protected:
+
+	/// Consume a struct.
+	///
+	/// @param value[in] The struct carried by the message.
+	/// @param message[in] The message (for its metadata).
+	virtual void consume(
+		const T&          value,
+		const MessagePtr& message) = 0;
+};
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,83 @@
+///
+/// @file TypedPort.h
+///
+/// Declaration of the TypedPort class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include "IPort.h"
+#include "Message.h"
+#include "MessagePtr.h"
+#include "Schema.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Output port that issues structured messages.
+///
+/// The port is a view on a port of the block, whose schema is declared by the
+/// block with IProducer::portSchema().
+///
+/// @tparam T The type of the payload.
+///
+template <Structured T>
+class TypedPort
+{
+	// Construction, destruction
+
+public:
+
+	/// Constructor.
+	///
+	/// @param[in] port The port of the block (nullptr while not connected).
+	explicit TypedPort(
+		IPort* port = nullptr)
+		: _port(port)
+	{
+	}
+
+	// Accessors
+
+public:
+
+	/// Check if the port is connected.
+	explicit operator bool() const { return _port != nullptr; }
+
+	// Operations
+
+public:
+
+	/// Forward a struct to the destinations attached to the port.
+	///
+	/// @param[in] value The struct (copied into the message).
+	void dispatch(
+		const T& value) { _port->dispatch(Message::create(value)); }
+
+	/// Forward a struct derived from another message.
+	///
+	/// @param[in] value The struct (copied into the message).
+	/// @param[in] metadata The metadata of the message the struct is derived from.
+	void dispatch(
+		const T&                 value,
+		const Message::Metadata& metadata)
+	{
+		auto message = Message::create(value);
+
+		message->metadata() = metadata;
+		_port->dispatch(message);
+	}
+
+	// Private attributes
+
+private:
+
+	/// The port of the block.
+	IPort* _port;
+};
+
+} // namespace framework
+} // namespace synapse
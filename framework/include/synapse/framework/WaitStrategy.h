@@ -0,0 +1,118 @@
+///
+/// @file WaitStrategy.h
+///
+/// Declaration of the WaitStrategy class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <cstddef>
+#include <thread>
+
+namespace synapse {
+namespace framework {
+
+///
+/// How the thread of a sink or a dispatcher waits for messages.
+///
+enum class WaitMode
+{
+	/// The thread sleeps until it is notified (no CPU used while idle).
+	block,
+	/// The thread polls for a while, then sleeps.
+	spinThenPark,
+	/// The thread polls until a message arrives (for a dedicated core).
+	busyPoll,
+};
+
+///
+/// Wait strategy of a sink or a dispatcher.
+///
+/// Polling avoids the wake up of a sleeping thread (futex and context switch)
+/// when messages follow each other closely, at the cost of CPU time. A sink or
+/// a dispatcher that does not block needs a thread of its own: it is not
+/// scheduled by an executor.
+///
+struct WaitStrategy
+{
+	/// Default number of polls before sleeping.
+	static constexpr size_t DEFAULT_SPINS = 10000;
+
+	/// The wait mode.
+	WaitMode mode{ WaitMode::block };
+
+	/// Number of polls before sleeping (spinThenPark).
+	size_t   spins{ DEFAULT_SPINS };
+
+	/// Check if the thread polls before sleeping.
+	///
+	/// @return true if the strategy needs a dedicated thread.
+	bool polls() const { return mode != WaitMode::block; }
+
+	/// @cond
+	bool operator==(
+		const WaitStrategy& other) const = default;
+	/// @endcond
+};
+
+/// Hint the processor that the thread is polling.
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield");
+#endif
+}
+
+/// Poll a condition according to a wait strategy.
+///
+/// A busy-polling thread yields from time to time so that it does not starve
+/// the other threads when the machine is oversubscribed.
+///
+/// @param strategy The wait strategy.
+/// @param ready The condition to poll.
+///
+/// @return true if the condition is met, false if the thread shall sleep.
+template <typename Predicate>
+bool spinUntil(
+	const WaitStrategy& strategy,
+	Predicate&&         ready)
+{
+	static constexpr size_t YIELD_PERIOD = 1024;
+
+	switch (strategy.mode)
+	{
+	default:
+	case WaitMode::block:
+		return false;
+	case WaitMode::spinThenPark:
+		for (size_t spin = 0; spin < strategy.spins; ++spin)
+		{
+			if (ready())
+			{
+				return true;
+			}
+			cpuRelax();
+		}
+		return ready();
+	case WaitMode::busyPoll:
+		for (size_t spin = 1; !ready(); ++spin)
+		{
+			if (spin % YIELD_PERIOD == 0)
+			{
+				std::this_thread::yield();
+			}
+			else
+			{
+				cpuRelax();
+			}
+		}
+		return true;
+	}
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,126 @@
+///
+/// @file BatchCounters.cpp
+///
+/// Implementation of the BatchCounters class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <bit>
+
+#include <fmt/format.h>
+
+#include "synapse/framework/BatchCounters.h"
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+/// Increment a counter (only called by the thread of the runnable).
+///
+/// @param counter The counter to increment.
+/// @param value The value to add.
+void increment(
+	std::atomic<uint64_t>& counter,
+	uint64_t               value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// Add the counters of another snapshot.
+BatchCounters::Statistics& BatchCounters::Statistics::operator+=(
+	const Statistics& other)
+{
+	batches += other.batches;
+	elements += other.elements;
+	for (size_t index = 0; index < BUCKET_COUNT; ++index)
+	{
+		histogram[index] += other.histogram[index];
+	}
+
+	return *this;
+}
+
+// Get the average number of elements of a batch.
+double BatchCounters::Statistics::mean() const
+{
+	return batches == 0 ? 0.0 : static_cast<double>(elements) / static_cast<double>(batches);
+}
+
+// Format the distribution in a human readable form.
+std::string BatchCounters::Statistics::toString() const
+{
+	std::string result;
+
+	for (size_t index = 0; index < BUCKET_COUNT; ++index)
+	{
+		if (histogram[index] == 0)
+		{
+			continue;
+		}
+
+		size_t first = size_t{ 1 } << index;
+		size_t last  = (first << 1) - 1;
+
+		if (!result.empty())
+		{
+			result += ' ';
+		}
+		if (index == BUCKET_COUNT - 1)
+		{
+			result += fmt::format("{}+:{}", first, histogram[index]);
+		}
+		else if (first == last)
+		{
+			result += fmt::format("{}:{}", first, histogram[index]);
+		}
+		else
+		{
+			result += fmt::format("{}-{}:{}", first, last, histogram[index]);
+		}
+	}
+
+	return result;
+}
+
+// Count a batch.
+void BatchCounters::record(
+	size_t size)
+{
+	if (size > 0)
+	{
+		increment(_batches, 1);
+		increment(_elements, size);
+		increment(_histogram[bucketIndex(size)], 1);
+	}
+}
+
+// Get the counters.
+BatchCounters::Statistics BatchCounters::statistics() const
+{
+	Statistics result;
+
+	result.batches  = _batches.load(std::memory_order_relaxed);
+	result.elements = _elements.load(std::memory_order_relaxed);
+	for (size_t index = 0; index < BUCKET_COUNT; ++index)
+	{
+		result.histogram[index] = _histogram[index].load(std::memory_order_relaxed);
+	}
+
+	return result;
+}
+
+// Get the bucket of a batch size.
+size_t BatchCounters::bucketIndex(
+	size_t size)
+{
+	return std::min<size_t>(std::bit_width(std::max<size_t>(size, 1)) - 1, BUCKET_COUNT - 1);
+}
+
+} // namespace framework
+} // namespace synapse
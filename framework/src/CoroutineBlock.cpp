@@ -0,0 +1,70 @@
+///
+/// @file CoroutineBlock.cpp
+///
+/// Implementation of the CoroutineBlock and CoroutineSink classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include "synapse/framework/CoroutineBlock.h"
+
+namespace synapse {
+namespace framework {
+
+// Default constructor.
+CoroutineBlock::CoroutineBlock(
+	const std::string& name)
+	: BaseBlock(name)
+{
+}
+
+// Destructor.
+CoroutineBlock::~CoroutineBlock()
+{
+}
+
+// Ask the block to prepare to be deleted.
+void CoroutineBlock::shutdown()
+{
+	_stopping.store(true);
+}
+
+// Start the coroutine of the block.
+void CoroutineBlock::start(
+	Executor& executor)
+{
+	_coroutine = main();
+	_coroutine.start(executor);
+}
+
+// Default constructor.
+CoroutineSink::CoroutineSink(
+	const std::string& name)
+	: CoroutineBlock(name)
+{
+}
+
+// Destructor.
+CoroutineSink::~CoroutineSink()
+{
+}
+
+// Ask the block to prepare to be deleted.
+void CoroutineSink::shutdown()
+{
+	CoroutineBlock::shutdown();
+
+	// Resume the coroutine with a null message.
+	_mailbox.close();
+}
+
+// Consume a message.
+void CoroutineSink::consume(
+	const MessagePtr& message)
+{
+	_mailbox.post(message);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -7,16 +7,143 @@
 /// @copyright Copyright (c) 2024, Xavier Caroff
 ///
 
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
 #include "synapse/framework/Dispatcher.h"
+#include "synapse/framework/Executor.h"
 
 namespace synapse {
 namespace framework {
 
+namespace {
+
+/// Get the current time to measure the time spent in the queues.
+///
+/// @return The number of nanoseconds of the steady clock.
+int64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Add a value to a counter written by a single thread.
+///
+/// @param counter The counter.
+/// @param value The value to add.
+void add(
+	std::atomic<uint64_t>& counter,
+	uint64_t               value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/// The dispatcher whose requests are processed by the calling thread.
+thread_local const Dispatcher* processing = nullptr;
+
+} // namespace
+
+// Queue a request beyond the capacity of the ring.
+void Dispatcher::Lane::defer(
+	Request&& request)
+{
+	std::lock_guard<std::mutex> lock(overflowMutex);
+
+	overflow.push_back(std::move(request));
+	overflowed.store(overflow.size(), std::memory_order_relaxed);
+}
+
+// Take the requests queued beyond the capacity of the ring.
+size_t Dispatcher::Lane::takeDeferred(
+	std::vector<Request>& values,
+	size_t                max)
+{
+	std::lock_guard<std::mutex> lock(overflowMutex);
+
+	size_t result = 0;
+
+	while (result < max && !overflow.empty())
+	{
+		values.push_back(std::move(overflow.front()));
+		overflow.pop_front();
+		++result;
+	}
+	overflowed.store(overflow.size(), std::memory_order_relaxed);
+
+	return result;
+}
+
+// Constructor of a worker.
+Dispatcher::Worker::Worker(
+	Dispatcher& dispatcher,
+	size_t      capacity)
+	: dispatcher(dispatcher)
+{
+	for (size_t lane = 0; lane < LANE_COUNT; ++lane)
+	{
+		lanes.push_back(std::make_unique<Lane>(capacity));
+	}
+	batch.reserve(lanes.front()->requests.capacity());
+}
+
+// Process the pending requests of a worker.
+void Dispatcher::Worker::execute()
+{
+	if (dispatcher.take(*this))
+	{
+		dispatcher.process(*this);
+	}
+
+	// Submit the worker again if requests arrived meanwhile (the fence pairs
+	// with the one of the ring after a request has been added).
+	scheduled.store(false);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (!dispatcher._shutdown.load() && !empty() && !scheduled.exchange(true))
+	{
+		dispatcher._executor->submit(*this);
+	}
+}
+
+// Check if all the lanes are empty.
+bool Dispatcher::Worker::empty() const
+{
+	for (const auto& lane : lanes)
+	{
+		if (lane->pending())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 // Default constructor.
 Dispatcher::Dispatcher(
-	const std::string& name)
-	: _name(name)
+	const std::string& name,
+	size_t             threadCount,
+	const QueuePolicy& queuePolicy)
+	: _name(name),
+	  _queuePolicy(queuePolicy)
 {
+	if (threadCount == 0)
+	{
+		throw std::invalid_argument(fmt::format("dispatcher '{}': the number of threads shall be at least 1", name));
+	}
+	if (queuePolicy.capacity == 0)
+	{
+		throw std::invalid_argument(fmt::format("dispatcher '{}': the capacity of the queue shall be at least 1", name));
+	}
+
+	for (size_t index = 0; index < threadCount; ++index)
+	{
+		_workers.push_back(std::make_unique<Worker>(*this, queuePolicy.capacity));
+	}
 }
 
 // Default destructor.
@@ -24,69 +151,309 @@ Dispatcher::~Dispatcher()
 {
 }
 
+// Get the distribution of the size of the batches of requests.
+BatchCounters::Statistics Dispatcher::statistics() const
+{
+	BatchCounters::Statistics result;
+
+	for (const auto& worker : _workers)
+	{
+		result += worker->batches.statistics();
+	}
+
+	return result;
+}
+
+// Get the counters of the priority lanes.
+std::array<Dispatcher::LaneStatistics, Dispatcher::LANE_COUNT> Dispatcher::lanes() const
+{
+	std::array<LaneStatistics, LANE_COUNT> result;
+
+	for (const auto& worker : _workers)
+	{
+		for (size_t index = 0; index < LANE_COUNT; ++index)
+		{
+			auto& lane = *worker->lanes[index];
+
+			result[index].processed += lane.processed.load(std::memory_order_relaxed);
+			result[index].depth += lane.requests.size() + lane.overflowed.load(std::memory_order_relaxed);
+			result[index].totalWait += lane.totalWait.load(std::memory_order_relaxed);
+			result[index].maxWait = std::max(result[index].maxWait, lane.maxWait.load(std::memory_order_relaxed));
+			result[index].promoted += lane.promoted.load(std::memory_order_relaxed);
+		}
+	}
+
+	return result;
+}
+
 // Dispatch a message to destinations.
 void Dispatcher::dispatch(
-	const std::shared_ptr<Message>& message,
-	const Port&                     source,
-	const Route&                    route)
+	const MessagePtr& message,
+	const Port&       source,
+	const Route&      route)
 {
-	// Enqueue the request.
+	// The identifiers of the ports are consecutive: the ports are spread
+	// evenly over the workers and a port always uses the same worker.
+	auto& worker   = *_workers[source.id() % _workers.size()];
+	auto& lane     = *worker.lanes[static_cast<size_t>(route.priority())];
+	auto& requests = lane.requests;
+
+	// Enqueue the request in the lane of the route.
+	Request request{ message, &source, &route, now() };
+
+	// The requests of the workers queued beyond the capacity are taken after
+	// the ones of the ring: the next requests of the workers join them to keep
+	// the order of their ports.
+	if (processing == this && lane.overflowed.load(std::memory_order_relaxed) != 0)
+	{
+		lane.defer(std::move(request));
+	}
+	// The queue is full, apply the overflow policy.
+	else if (!requests.tryPush(request))
+	{
+		switch (_queuePolicy.overflow)
+		{
+		default:
+		case OverflowPolicy::block:
+			_overflows.blocked();
+
+			// A worker of the dispatcher does not wait for room in a ring that
+			// it may have to drain itself.
+			if (processing == this)
+			{
+				lane.defer(std::move(request));
+				break;
+			}
+			if (Executor::current() == nullptr)
+			{
+				requests.push(std::move(request));
+				break;
+			}
+
+			// A thread of an executor does not wait for the worker, which may
+			// be a task of the same executor: it executes the pending tasks
+			// meanwhile.
+			while (!requests.tryPush(request) && !requests.closed())
+			{
+				if (!Executor::runPending())
+				{
+					std::this_thread::yield();
+				}
+			}
+			break;
+		case OverflowPolicy::dropNewest:
+			_overflows.dropped();
+			break;
+		case OverflowPolicy::dropOldest:
+			do
+			{
+				Request discarded;
+
+				if (requests.tryPop(discarded))
+				{
+					_overflows.dropped();
+				}
+			} while (!requests.tryPush(request));
+			break;
+		}
+	}
+
+	// Submit the worker to the executor if it is not already pending.
+	if (_executor != nullptr)
 	{
-		std::lock_guard<std::mutex> lock(_mtxRequests);
-		_requests.push_back({ message, source, route });
+		if (!worker.scheduled.load(std::memory_order_relaxed) && !worker.scheduled.exchange(true))
+		{
+			_executor->submit(worker);
+		}
+		return;
 	}
 
-	// Notify the runnable.
-	_cvRequests.notify_one();
+	// Wake up the dedicated thread if it sleeps (the fence pairs with the one
+	// of wait()). Only the first producer that sees it asleep rings.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (worker.sleeping.load(std::memory_order_relaxed) && worker.sleeping.exchange(false, std::memory_order_relaxed))
+	{
+		worker.doorbell.fetch_add(1, std::memory_order_release);
+		worker.doorbell.notify_one();
+	}
 }
 
 // Ask the dispatcher to terminate the routing of messages.
 void Dispatcher::shutdown()
 {
 	_shutdown.store(true);
-	_cvRequests.notify_one();
+	for (auto& worker : _workers)
+	{
+		for (auto& lane : worker->lanes)
+		{
+			lane->requests.close();
+		}
+		worker->doorbell.fetch_add(1, std::memory_order_release);
+		worker->doorbell.notify_all();
+	}
 }
 
 // Control function of the runnable.
 void Dispatcher::run()
 {
-	while (_shutdown.load() == false)
+	std::vector<std::thread> threads;
+
+	for (size_t index = 1; index < _workers.size(); ++index)
 	{
-		// Wait for an action to be processed.
-		{
-			std::unique_lock<std::mutex> lock(_mtxRequests);
+		threads.emplace_back([this, index] {
+			if (_threadStart)
+			{
+				_threadStart(index);
+			}
+			run(*_workers[index]);
+		});
+	}
 
-			_cvRequests.wait(lock, [this] { return _shutdown.load() || !_requests.empty(); });
+	if (_threadStart)
+	{
+		_threadStart(0);
+	}
+	run(*_workers.front());
 
-			// If shutdown was requested, stop the loop.
-			if (_shutdown.load())
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+// Control function of a worker.
+void Dispatcher::run(
+	Worker& worker)
+{
+	while (_shutdown.load() == false)
+	{
+		// Get the next batch of requests or wait for one (polling first if the
+		// wait strategy allows it).
+		if (!take(worker))
+		{
+			if (!spinUntil(_waitStrategy, [this, &worker] { return !worker.empty() || _shutdown.load(std::memory_order_relaxed); }))
 			{
-				break;
+				wait(worker);
 			}
+			continue;
+		}
+
+		process(worker);
+	}
+}
+
+// Wait until a lane of a worker is not empty.
+void Dispatcher::wait(
+	Worker& worker)
+{
+	// Announce that the thread is about to sleep then check again the lanes
+	// to be sure not to miss the doorbell of a producer.
+	auto epoch = worker.doorbell.load(std::memory_order_acquire);
+
+	worker.sleeping.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (worker.empty() && !_shutdown.load())
+	{
+		worker.doorbell.wait(epoch, std::memory_order_acquire);
+	}
+	worker.sleeping.store(false, std::memory_order_relaxed);
+}
+
+// Take the next batch of requests of a worker.
+bool Dispatcher::take(
+	Worker& worker)
+{
+	size_t selected = LANE_COUNT;
+
+	// Serve first a lane that has been passed over too many times.
+	for (size_t index = 1; index < LANE_COUNT && selected == LANE_COUNT; ++index)
+	{
+		auto& lane = *worker.lanes[index];
+
+		if (lane.skipped >= _starvationLimit && lane.pending())
+		{
+			selected = index;
+			add(lane.promoted, 1);
 		}
+	}
 
-		// Process pending messages.
-		while (true)
+	// Otherwise serve the highest lane with pending requests.
+	for (size_t index = 0; index < LANE_COUNT && selected == LANE_COUNT; ++index)
+	{
+		if (worker.lanes[index]->pending())
 		{
-			// Get the next request to process.
-			_mtxRequests.lock();
-			if (_requests.empty())
-			{
-				_mtxRequests.unlock();
-				break;
-			}
-			auto request = _requests.front();
-			_requests.pop_front();
-			_mtxRequests.unlock();
+			selected = index;
+		}
+	}
 
-			// Process the request.
-			for (auto& current : request.route.destinations())
-			{
-				current->consume(request.message);
-			}
+	if (selected == LANE_COUNT)
+	{
+		return false;
+	}
+
+	// The highest priority is drained at once, the others by slices. The
+	// requests queued beyond the capacity follow the ones of the ring.
+	auto& lane  = *worker.lanes[selected];
+	auto  max   = selected == 0 ? SIZE_MAX : SLICE_SIZE;
+	auto  count = lane.requests.tryPopAll(worker.batch, max);
+
+	if (count < max && lane.requests.empty())
+	{
+		count += lane.takeDeferred(worker.batch, max - count);
+	}
+
+	lane.skipped = 0;
+	for (size_t index = 0; index < LANE_COUNT; ++index)
+	{
+		if (index != selected && worker.lanes[index]->pending())
+		{
+			++worker.lanes[index]->skipped;
+		}
+	}
+
+	// Measure the time spent by the requests in the queue.
+	auto     taken   = now();
+	uint64_t total   = 0;
+	uint64_t longest = lane.maxWait.load(std::memory_order_relaxed);
+
+	for (const auto& request : worker.batch)
+	{
+		auto wait = static_cast<uint64_t>(std::max<int64_t>(taken - request.queued, 0));
+
+		total += wait;
+		longest = std::max(longest, wait);
+	}
+	add(lane.processed, count);
+	add(lane.totalWait, total);
+	lane.maxWait.store(longest, std::memory_order_relaxed);
+
+	return true;
+}
+
+// Process a batch of requests taken from the queue of a worker.
+void Dispatcher::process(
+	Worker& worker)
+{
+	auto& batch = worker.batch;
+
+	worker.batches.record(batch.size());
+
+	// The requests emitted by the destinations on the routes of the dispatcher
+	// shall not wait for the workers.
+	auto previous = std::exchange(processing, this);
+
+	// Process the requests.
+	for (auto& request : batch)
+	{
+		for (auto& current : request.route->destinations())
+		{
+			current->consume(request.message);
 		}
 	}
+	batch.clear();
+	processing = previous;
 }
 
 } // namespace framework
-} // namespace synapse
\ No newline at end of file
+} // namespace synapse
@@ -0,0 +1,247 @@
+///
+/// @file Executor.cpp
+///
+/// Implementation of the Executor class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+
+#include "synapse/framework/Executor.h"
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+/// The executor of the calling thread (nullptr if it is not a thread of a pool).
+thread_local Executor* currentExecutor{ nullptr };
+
+/// The index of the worker of the calling thread.
+thread_local size_t    currentIndex{ 0 };
+
+} // namespace
+
+// Constructor.
+Executor::Executor(
+	size_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	for (size_t index = 0; index < threadCount; ++index)
+	{
+		_workers.push_back(std::make_unique<Worker>());
+	}
+}
+
+// Destructor.
+Executor::~Executor()
+{
+	stop();
+}
+
+// Get the counters of the executor.
+Executor::Statistics Executor::statistics() const
+{
+	Statistics result;
+
+	for (const auto& worker : _workers)
+	{
+		result.executed += worker->executed.load(std::memory_order_relaxed);
+		result.stolen += worker->stolen.load(std::memory_order_relaxed);
+	}
+
+	return result;
+}
+
+// Get the executor of the calling thread.
+Executor* Executor::current()
+{
+	return currentExecutor;
+}
+
+// Start the threads of the pool.
+void Executor::start()
+{
+	_stopping.store(false);
+	for (size_t index = 0; index < _workers.size(); ++index)
+	{
+		_threads.emplace_back([this, index] {
+			if (_threadStart)
+			{
+				_threadStart(index);
+			}
+			run(index);
+		});
+	}
+}
+
+// Stop the threads of the pool.
+void Executor::stop()
+{
+	_stopping.store(true);
+	_signal.fetch_add(1);
+	_signal.notify_all();
+
+	for (auto& thread : _threads)
+	{
+		thread.join();
+	}
+	_threads.clear();
+
+	// Discard the pending tasks.
+	for (auto& worker : _workers)
+	{
+		std::lock_guard<std::mutex> lock(worker->mutex);
+
+		_pending.fetch_sub(worker->tasks.size());
+		worker->tasks.clear();
+	}
+}
+
+// Submit a task.
+void Executor::submit(
+	ITask& task)
+{
+	// A thread of the pool keeps its tasks, the other threads spread them.
+	size_t index = currentExecutor == this ? currentIndex : _next.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+	auto&  worker = *_workers[index];
+
+	// The task is counted before being visible so that the counter never
+	// goes below zero.
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+
+		_pending.fetch_add(1);
+		worker.tasks.push_back(&task);
+	}
+
+	// Wake up a parked thread.
+	if (_sleeping.load() > 0)
+	{
+		_signal.fetch_add(1);
+		_signal.notify_one();
+	}
+}
+
+// Execute a pending task of the executor of the calling thread.
+bool Executor::runPending()
+{
+	auto executor = currentExecutor;
+	auto index    = currentIndex;
+	bool stolen   = false;
+
+	if (executor == nullptr || executor->_stopping.load())
+	{
+		return false;
+	}
+
+	auto task = executor->take(index, stolen);
+
+	if (task == nullptr)
+	{
+		return false;
+	}
+
+	executor->execute(index, *task, stolen);
+
+	return true;
+}
+
+// Execute a task and count it.
+void Executor::execute(
+	size_t index,
+	ITask& task,
+	bool   stolen)
+{
+	auto& worker = *_workers[index];
+
+	task.execute();
+
+	worker.executed.store(worker.executed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (stolen)
+	{
+		worker.stolen.store(worker.stolen.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+}
+
+// Control function of a thread of the pool.
+void Executor::run(
+	size_t index)
+{
+	currentExecutor = this;
+	currentIndex    = index;
+
+	while (!_stopping.load())
+	{
+		bool stolen = false;
+
+		if (auto task = take(index, stolen))
+		{
+			execute(index, *task, stolen);
+			continue;
+		}
+
+		// Announce that the thread is about to park then check again the
+		// pending tasks to be sure not to miss the wake up of a submitter.
+		auto epoch = _signal.load();
+
+		_sleeping.fetch_add(1);
+		if (_pending.load() == 0 && !_stopping.load())
+		{
+			_signal.wait(epoch);
+		}
+		_sleeping.fetch_sub(1);
+	}
+
+	currentExecutor = nullptr;
+}
+
+// Take the next task of a thread.
+ITask* Executor::take(
+	size_t index,
+	bool&  stolen)
+{
+	ITask* result = nullptr;
+
+	// Take the oldest task of the thread.
+	{
+		auto&                       worker = *_workers[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+
+		if (!worker.tasks.empty())
+		{
+			result = worker.tasks.front();
+			worker.tasks.pop_front();
+		}
+	}
+
+	// Steal the newest task of another thread.
+	for (size_t offset = 1; result == nullptr && offset < _workers.size() && _pending.load() > 0; ++offset)
+	{
+		auto&                       victim = *_workers[(index + offset) % _workers.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.tasks.empty())
+		{
+			result = victim.tasks.back();
+			victim.tasks.pop_back();
+			stolen = true;
+		}
+	}
+
+	if (result != nullptr)
+	{
+		_pending.fetch_sub(1);
+	}
+
+	return result;
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,203 @@
+///
+/// @file Mailbox.cpp
+///
+/// Implementation of the Mailbox class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include "synapse/framework/Executor.h"
+#include "synapse/framework/Mailbox.h"
+
+namespace synapse {
+namespace framework {
+
+// Get the message (null if the mailbox is closed).
+MessagePtr Mailbox::Receive::await_resume()
+{
+	// The coroutine has been resumed by post() or close(): take the message now.
+	if (!_message)
+	{
+		_mailbox.tryReceive(_message);
+	}
+
+	return std::move(_message);
+}
+
+// Get the limits of the mailbox.
+QueuePolicy Mailbox::policy() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _policy;
+}
+
+// Set the limits of the mailbox.
+void Mailbox::setPolicy(
+	const QueuePolicy& policy)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_policy = policy;
+}
+
+// Post a message to the mailbox.
+void Mailbox::post(
+	const MessagePtr& message)
+{
+	Coroutine::Handle waiter;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		if (_closed)
+		{
+			return;
+		}
+
+		// The mailbox is full, apply the overflow policy.
+		if (_policy.capacity > 0 && _messages.size() >= _policy.capacity)
+		{
+			switch (_policy.overflow)
+			{
+			default:
+			case OverflowPolicy::block:
+				_overflows.blocked();
+				waitForRoom(lock);
+				if (_closed)
+				{
+					return;
+				}
+				break;
+			case OverflowPolicy::dropNewest:
+				_overflows.dropped();
+				return;
+			case OverflowPolicy::dropOldest:
+				_overflows.dropped();
+				_messages.pop_front();
+				break;
+			}
+		}
+
+		_messages.push_back(message);
+		waiter = std::exchange(_waiter, nullptr);
+	}
+
+	// Resume the coroutine outside of the lock.
+	if (waiter)
+	{
+		waiter.promise().schedule();
+	}
+}
+
+// Close the mailbox.
+void Mailbox::close()
+{
+	Coroutine::Handle waiter;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_closed = true;
+		waiter  = std::exchange(_waiter, nullptr);
+	}
+	_cvRoom.notify_all();
+
+	if (waiter)
+	{
+		waiter.promise().schedule();
+	}
+}
+
+// Get the number of pending messages.
+size_t Mailbox::size() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _messages.size();
+}
+
+// Take the next message if one is pending.
+bool Mailbox::tryReceive(
+	MessagePtr& message)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (!_messages.empty())
+	{
+		pop(message);
+
+		return true;
+	}
+
+	return _closed;
+}
+
+// Register the waiting coroutine.
+bool Mailbox::suspend(
+	Coroutine::Handle handle,
+	MessagePtr&       message)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// A message arrived (or the mailbox was closed) since await_ready().
+	if (!_messages.empty())
+	{
+		pop(message);
+
+		return false;
+	}
+	if (_closed)
+	{
+		return false;
+	}
+	_waiter = handle;
+
+	return true;
+}
+
+// Take the front message.
+void Mailbox::pop(
+	MessagePtr& message)
+{
+	message = std::move(_messages.front());
+	_messages.pop_front();
+
+	// Wake up the producers waiting for room in the mailbox.
+	if (_policy.capacity > 0)
+	{
+		_cvRoom.notify_all();
+	}
+}
+
+// Wait until there is room in the mailbox.
+void Mailbox::waitForRoom(
+	std::unique_lock<std::mutex>& lock)
+{
+	auto room = [this] { return _closed || _messages.size() < _policy.capacity; };
+
+	// A thread of an executor does not wait for the coroutine, which may be
+	// resumed by the same executor: it executes the pending tasks meanwhile.
+	if (Executor::current() == nullptr)
+	{
+		_cvRoom.wait(lock, room);
+		return;
+	}
+
+	while (!room())
+	{
+		lock.unlock();
+		auto executed = Executor::runPending();
+		lock.lock();
+
+		// The coroutine runs on another thread, wait for it a moment.
+		if (!executed)
+		{
+			_cvRoom.wait_for(lock, ROOM_POLL_PERIOD, room);
+		}
+	}
+}
+
+} // namespace framework
+} // namespace synapse
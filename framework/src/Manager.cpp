@@ -7,11 +7,18 @@
 /// @copyright Copyright (c) 2024, Xavier Caroff
 ///
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <latch>
 #include <memory>
-#include <regex>
+#include <set>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 
 #include <boost/dll.hpp>
 
@@ -19,15 +26,282 @@
 
 #include <spdlog/spdlog.h>
 
+#include "synapse/framework/CoroutineBlock.h"
 #include "synapse/framework/Dispatcher.h"
+#include "synapse/framework/Executor.h"
+#include "synapse/framework/Fiber.h"
 #include "synapse/framework/IConsumer.h"
 #include "synapse/framework/IProducer.h"
 #include "synapse/framework/IRunnable.h"
 #include "synapse/framework/Manager.h"
+#include "synapse/framework/MessagePool.h"
+#include "synapse/framework/ReplicaSet.h"
+#include "synapse/framework/Sink.h"
 
 namespace synapse {
 namespace framework {
 
+// clang-format off
+NLOHMANN_JSON_SERIALIZE_ENUM( OverflowPolicy, {
+	{ OverflowPolicy::block,		"block" },
+	{ OverflowPolicy::dropNewest,	"drop-newest" },
+	{ OverflowPolicy::dropOldest,	"drop-oldest" },
+})
+// clang-format on
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void from_json(
+	const nlohmann::json& json,
+	QueuePolicy&          object)
+{
+	auto capacity = json.at("capacity").get<int64_t>();
+
+	if (capacity < 1)
+	{
+		throw std::runtime_error("the capacity of a queue shall be at least 1");
+	}
+
+	object.capacity = static_cast<size_t>(capacity);
+	object.overflow = json.value("overflow", OverflowPolicy::block);
+}
+
+// clang-format off
+NLOHMANN_JSON_SERIALIZE_ENUM( WaitMode, {
+	{ WaitMode::block,			"block" },
+	{ WaitMode::spinThenPark,	"spin-then-park" },
+	{ WaitMode::busyPoll,		"busy-poll" },
+})
+// clang-format on
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void from_json(
+	const nlohmann::json& json,
+	WaitStrategy&         object)
+{
+	auto spins = json.value("spins", static_cast<int64_t>(WaitStrategy::DEFAULT_SPINS));
+
+	if (spins < 0)
+	{
+		throw std::runtime_error("the number of spins shall not be negative");
+	}
+
+	object.mode  = json.at("strategy").get<WaitMode>();
+	object.spins = static_cast<size_t>(spins);
+}
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void from_json(
+	const nlohmann::json& json,
+	ThreadPolicy&         object)
+{
+	for (auto cpu : json.value("cpus", std::vector<int>()))
+	{
+		if (cpu < 0)
+		{
+			throw std::runtime_error(fmt::format("invalid cpu {}", cpu));
+		}
+		object.cpus.push_back(static_cast<unsigned>(cpu));
+	}
+
+	object.priority = json.value("priority", 0);
+	if (object.priority < 0 || object.priority > ThreadPolicy::MAX_PRIORITY)
+	{
+		throw std::runtime_error(fmt::format("the priority shall be between 0 and {}", ThreadPolicy::MAX_PRIORITY));
+	}
+}
+
+// clang-format off
+NLOHMANN_JSON_SERIALIZE_ENUM( ShardKey, {
+	{ ShardKey::port,		"port" },
+	{ ShardKey::bytes,		"bytes" },
+	{ ShardKey::roundRobin,	"round-robin" },
+})
+// clang-format on
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void from_json(
+	const nlohmann::json& json,
+	ShardPolicy&          object)
+{
+	auto offset = json.value("offset", static_cast<int64_t>(0));
+	auto length = json.value("length", static_cast<int64_t>(0));
+
+	if (offset < 0 || length < 0)
+	{
+		throw std::runtime_error("the range of the shard key shall not be negative");
+	}
+
+	object.key    = json.at("key").get<ShardKey>();
+	object.offset = static_cast<size_t>(offset);
+	object.length = static_cast<size_t>(length);
+}
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void from_json(
+	const nlohmann::json&   json,
+	RouteFilter::ByteMatch& object)
+{
+	auto offset = json.at("offset").get<int64_t>();
+	auto value  = json.at("value");
+
+	if (offset < 0)
+	{
+		throw std::runtime_error("the offset of a byte shall not be negative");
+	}
+	object.offset = static_cast<size_t>(offset);
+
+	// The value is a number or a single character.
+	if (value.is_string())
+	{
+		auto text = value.get<std::string>();
+
+		if (text.size() != 1)
+		{
+			throw std::runtime_error(fmt::format("'{}' is not a single character", text));
+		}
+		object.value = static_cast<uint8_t>(text[0]);
+	}
+	else
+	{
+		auto number = value.get<int>();
+
+		if (number < 0 || number > UINT8_MAX)
+		{
+			throw std::runtime_error(fmt::format("{} is not a byte value", number));
+		}
+		object.value = static_cast<uint8_t>(number);
+	}
+}
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void from_json(
+	const nlohmann::json& json,
+	RouteFilter&          object)
+{
+	// A single prefix or a list of prefixes.
+	if (json.find("prefix") != json.end())
+	{
+		auto& prefix = json.at("prefix");
+
+		object.prefixes = prefix.is_string() ? std::vector<std::string>{ prefix.get<std::string>() } : prefix.get<std::vector<std::string>>();
+	}
+
+	if (json.find("length") != json.end())
+	{
+		auto minimum = json.at("length").value("min", static_cast<int64_t>(0));
+		auto maximum = json.at("length").value("max", static_cast<int64_t>(-1));
+
+		if (minimum < 0 || (maximum >= 0 && maximum < minimum))
+		{
+			throw std::runtime_error(fmt::format("invalid length range [{}, {}]", minimum, maximum));
+		}
+		object.minSize = static_cast<size_t>(minimum);
+		object.maxSize = maximum < 0 ? SIZE_MAX : static_cast<size_t>(maximum);
+	}
+
+	object.bytes = json.value("bytes", std::vector<RouteFilter::ByteMatch>());
+}
+
+namespace {
+
+/// Names of the route priorities (indexed by RoutePriority).
+const std::string PRIORITY_NAMES[Dispatcher::LANE_COUNT] = { "high", "normal", "low" };
+
+/// Log the cores and the scheduling policy of the calling thread.
+///
+/// @param owner The description of the thread.
+void logThread(
+	const std::string& owner)
+{
+	spdlog::info("{}: running on {}", owner, ThreadPolicy::describeCurrentThread());
+}
+
+/// Run a task for each index of a range on a pool of threads.
+///
+/// The exceptions are collected, the one of the lowest index is thrown again
+/// once all the tasks are done (the same one as a serial run).
+///
+/// @param count The number of indexes.
+/// @param threads The number of threads (0 for one thread per core).
+/// @param task The task to run for an index.
+void parallelFor(
+	size_t                             count,
+	size_t                             threads,
+	const std::function<void(size_t)>& task)
+{
+	std::vector<std::exception_ptr> errors(count);
+	std::atomic<size_t>             next{ 0 };
+	auto                            work = [&] {
+        for (size_t index = next++; index < count; index = next++)
+        {
+            try
+            {
+                task(index);
+            }
+            catch (...)
+            {
+                errors[index] = std::current_exception();
+            }
+        }
+	};
+
+	if (threads == 0)
+	{
+		threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+	threads = std::min(threads, count);
+
+	// The calling thread takes its share of the tasks.
+	std::vector<std::thread> pool;
+
+	for (size_t index = 1; index < threads; ++index)
+	{
+		pool.emplace_back(work);
+	}
+	work();
+	for (auto& thread : pool)
+	{
+		thread.join();
+	}
+
+	for (auto& error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+/// Run a startup phase and log its duration.
+///
+/// @param phase The name of the phase.
+/// @param action The phase.
+void timePhase(
+	const std::string&           phase,
+	const std::function<void()>& action)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	action();
+
+	spdlog::info("Startup: {} in {:.1f} ms", phase, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
 // Constructor.
 Manager::Manager()
 {
@@ -85,88 +359,294 @@ IPort* Manager::find(
 	const std::string& name)
 	const
 {
-	auto itr = std::find_if(_ports.cbegin(), _ports.cend(), [block, name](const auto& current) {
-		return current->block() == block && current->name() == name;
-	});
+	auto& ports = portsOf(block);
+	auto  itr   = ports.find(name);
 
-	if (itr == _ports.cend())
+	if (itr == ports.end())
 	{
 		throw std::logic_error(fmt::format("port '{}' not found for block '{}'", name, block->name()).c_str());
 	}
 
-	return itr->get();
+	return itr->second;
+}
+
+// Create an output port of a block.
+Port* Manager::addPort(
+	const std::string& name,
+	IBlock*            block)
+{
+	auto port = _ports.emplace_back(std::make_unique<Port>(name, block, static_cast<uint32_t>(_ports.size() + 1))).get();
+
+	_portIndex[block].emplace(name, port);
+
+	return port;
+}
+
+// Get the output ports of a block.
+const Manager::PortsByName& Manager::portsOf(
+	const IBlock* block) const
+{
+	static const PortsByName NO_PORTS;
+
+	auto itr = _portIndex.find(block);
+
+	return itr != _portIndex.end() ? itr->second : NO_PORTS;
 }
 
 // Initialize the object from configuration data.
 void Manager::initialize(
 	const ConfigData& config)
 {
+	// Get the number of threads of the executor.
+	if (config.find("executor") != config.end())
+	{
+		auto threads = config.at("executor").value("threads", 0);
+
+		if (threads < 0)
+		{
+			throw std::runtime_error("the number of threads of the executor shall not be negative");
+		}
+		_executorThreads = static_cast<size_t>(threads);
+	}
+
+	// Check if the chains of fibers shall be fused (the queued routes then
+	// change of semantic, it is not the default).
+	if (config.find("plan") != config.end())
+	{
+		_fuseFibers = config.at("plan").value("fuse", false);
+	}
+
+	// Get the number of threads that initialize the blocks (the blocks are
+	// initialized one after the other unless the configuration states that
+	// they are independent).
+	if (config.find("startup") != config.end())
+	{
+		auto threads = config.at("startup").value("threads", 1);
+
+		if (threads < 0)
+		{
+			throw std::runtime_error("the number of startup threads shall not be negative");
+		}
+		_startupThreads = static_cast<size_t>(threads);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
 	// Load modules.
-	loadModules(config);
+	timePhase("modules loaded", [&] { loadModules(config); });
 
 	// Create the blocks.
-	createBlocks(config);
+	timePhase("blocks created", [&] { createBlocks(config); });
 
 	// Create the routes.
-	createRoutes(config);
+	timePhase("routes created", [&] {
+		createRoutes(config);
+		checkInlineRoutes();
+		compilePlan();
+	});
 
 	// Initialize the blocks.
-	initializeBlocks(config);
+	timePhase("blocks initialized", [&] { initializeBlocks(config); });
+
+	spdlog::info("Startup: done in {:.1f} ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 }
 
 // Start the blocks and wait for terminaison request.
 void Manager::run()
 {
-	// Start the runnables block running in a dedicated thread.
-	size_t runnableCount =
-		std::count_if(_blocks.cbegin(), _blocks.cend(), [](const auto& current) { return dynamic_cast<IRunnable*>(current.second); }) +
-		_dispatchers.size();
-	std::latch               latch(runnableCount);
-	std::vector<std::thread> runnables;
-	auto                     run = [](IRunnable* runnable, std::latch& latch) {
-        // Execute the 	runnable
-        runnable->run();
+	// Create the shared executor and the executors of the groups (one thread
+	// per group, the blocks of a group are serviced in turn). Each thread
+	// started by the manager logs its cores when it starts.
+	_executor = std::make_unique<Executor>(_executorThreads);
+	_executor->setThreadStart([](size_t index) { logThread(fmt::format("Executor thread {}", index)); });
+	for (auto& current : _executorGroups)
+	{
+		auto& executor = _groups[current.second];
 
-        // Log the end of the runnable
-        std::string type;
-        std::string name;
-        if (auto block = dynamic_cast<IBlock*>(runnable))
+		if (!executor)
+		{
+			executor = std::make_unique<Executor>(1);
+			executor->setThreadStart([name = current.second](size_t) { logThread(fmt::format("Executor group '{}'", name)); });
+		}
+	}
+
+	// The polling sinks and dispatchers and the ones with a thread policy
+	// keep a dedicated thread.
+	auto dedicatedDispatcher = [this](const std::string& name, const Dispatcher& dispatcher) {
+		return dispatcher.waitStrategy().polls() || _dispatcherThreadPolicies.find(name) != _dispatcherThreadPolicies.end();
+	};
+	auto dedicatedSink = [this](const std::string& name, const Sink& sink) {
+		return sink.waitStrategy().polls() || _threadPolicies.find(name) != _threadPolicies.end();
+	};
+
+	// Schedule the other sinks and dispatchers on the executors. The threads
+	// to start are kept with the name of their block (empty for the
+	// dispatchers, which apply their thread policy themselves). Their queues
+	// keep their overflow policy: a task that finds a full queue with the
+	// block policy executes the other tasks of its executor instead of
+	// waiting (see OverflowPolicy).
+	std::vector<std::pair<IRunnable*, std::string>> threaded;
+
+	for (auto& current : _dispatchers)
+	{
+		if (dedicatedDispatcher(current.first, *current.second))
+		{
+			if (auto policy = _dispatcherThreadPolicies.find(current.first); policy != _dispatcherThreadPolicies.end())
+			{
+				current.second->setThreadStart([name = current.first, policy = policy->second](size_t worker) {
+					applyThreadPolicy(fmt::format("Dispatcher '{}' worker {}", name, worker), policy);
+				});
+			}
+			else
+			{
+				current.second->setThreadStart([name = current.first](size_t worker) {
+					logThread(fmt::format("Dispatcher '{}' worker {}", name, worker));
+				});
+			}
+			threaded.emplace_back(current.second.get(), std::string());
+		}
+		else
+		{
+			current.second->setExecutor(_executor.get());
+		}
+	}
+	for (auto& current : _blocks)
+	{
+		if (auto sink = dynamic_cast<Sink*>(current.second); sink != nullptr && !dedicatedSink(current.first, *sink))
+		{
+			sink->setExecutor(&executorOf(current.first));
+		}
+		else if (auto replicaSet = dynamic_cast<ReplicaSet*>(current.second))
+		{
+			replicaSet->setExecutor(&executorOf(current.first));
+		}
+	}
+	_executor->start();
+	spdlog::info("Executor started with {} threads", _executor->threadCount());
+	for (auto& current : _groups)
+	{
+		current.second->start();
+		spdlog::info("Executor group '{}' started", current.first);
+	}
+
+	// Start the coroutines of the blocks on the executors.
+	for (auto& current : _blocks)
+	{
+		if (auto block = dynamic_cast<CoroutineBlock*>(current.second))
+		{
+			block->start(executorOf(current.first));
+		}
+	}
+
+	// Start the other runnables (the sources and the dedicated sinks) in a
+	// dedicated thread.
+	for (auto& current : _blocks)
+	{
+		auto sink = dynamic_cast<Sink*>(current.second);
+
+		if (auto runnable = dynamic_cast<IRunnable*>(current.second); runnable != nullptr && (sink == nullptr || dedicatedSink(current.first, *sink)))
+		{
+			threaded.emplace_back(runnable, current.first);
+		}
+	}
+
+	std::latch               latch(threaded.size());
+	std::vector<std::thread> runnables;
+	auto                     run = [this](IRunnable* runnable, const std::string& blockName, std::latch& latch) {
+        // Apply the thread policy of the block (the dispatchers log their
+        // own threads)
+        if (auto policy = _threadPolicies.find(blockName); policy != _threadPolicies.end())
         {
-            type = "Block";
-            name = block->name();
+            applyThreadPolicy(fmt::format("Block '{}'", blockName), policy->second);
         }
-        else if (auto dispatcher = dynamic_cast<Dispatcher*>(runnable))
+        else if (!blockName.empty())
         {
-            type = "Dispatcher";
-            name = dispatcher->name();
+            logThread(fmt::format("Block '{}'", blockName));
         }
-        spdlog::info("{} '{}' terminated", type, name);
+
+        // Execute the 	runnable
+        runnable->run();
+
+        // Log the end of the runnable
+        report(runnable);
 
         // Signal the termination
         latch.count_down();
     };
 
+	for (auto& [runnable, blockName] : threaded)
+	{
+		runnables.emplace_back(std::thread(run, runnable, std::cref(blockName), std::ref(latch)));
+	}
+
+	// Wait for the termination request and then for the runnables to finish.
+	_shutdownRequested.wait(false);
+	latch.wait();
+	for (auto& thread : runnables)
+	{
+		thread.join();
+	}
+
+	// Stop the executor and log the end of the tasks.
+	_executor->stop();
+	for (auto& current : _groups)
+	{
+		current.second->stop();
+	}
 	for (auto& current : _dispatchers)
 	{
-		if (auto runnable = dynamic_cast<IRunnable*>(current.second.get()))
+		if (!dedicatedDispatcher(current.first, *current.second))
 		{
-			runnables.emplace_back(std::thread(run, runnable, std::ref(latch)));
+			report(current.second.get());
 		}
 	}
 	for (auto& current : _blocks)
 	{
-		if (auto runnable = dynamic_cast<IRunnable*>(current.second))
+		if (auto sink = dynamic_cast<Sink*>(current.second))
 		{
-			runnables.emplace_back(std::thread(run, runnable, std::ref(latch)));
+			if (!dedicatedSink(current.first, *sink))
+			{
+				report(sink);
+			}
+		}
+		else if (auto block = dynamic_cast<CoroutineBlock*>(current.second))
+		{
+			report(block);
+		}
+		else if (auto replicaSet = dynamic_cast<ReplicaSet*>(current.second))
+		{
+			auto overflows = replicaSet->overflows();
+
+			if (overflows.blocked > 0 || overflows.dropped > 0)
+			{
+				spdlog::warn("Replica set '{}': queue full, {} producers blocked, {} messages dropped", current.first, overflows.blocked, overflows.dropped);
+			}
+			if (replicaSet->held() != 0)
+			{
+				spdlog::warn("Replica set '{}': {} outputs not released", current.first, replicaSet->held());
+			}
 		}
 	}
 
-	// Wait for runnables to finish.
-	std::this_thread::yield();
-	latch.wait();
-	for (auto& thread : runnables)
+	// Log the messages rejected by the filters of the routes.
+	size_t counter = 0;
+
+	for (auto& route : _routes)
 	{
-		thread.join();
+		++counter;
+		if (!route->filter().empty())
+		{
+			spdlog::info("Route '{}': {} messages rejected by the filter", !route->name().empty() ? route->name() : fmt::format("unnamed #{}", counter),
+						 route->rejected());
+		}
+	}
+
+	auto executor = _executor->statistics();
+
+	spdlog::info("Executor: {} tasks executed ({} stolen)", executor.executed, executor.stolen);
+	for (auto& current : _groups)
+	{
+		spdlog::info("Executor group '{}': {} tasks executed", current.first, current.second->statistics().executed);
 	}
 
 	// Delete blocks.
@@ -175,6 +655,11 @@ void Manager::run()
 		current.second->destroy();
 		current.second = nullptr;
 	}
+
+	// Report the usage of the message pool.
+	auto statistics = MessagePool::instance().statistics();
+
+	spdlog::info("Message pool: {} hits, {} misses ({} oversized)", statistics.hits, statistics.misses, statistics.oversized);
 }
 
 // Ask to stop the execution.
@@ -191,28 +676,37 @@ void Manager::shutdown()
 	{
 		current.second->shutdown();
 	}
+
+	// Release the main loop.
+	_shutdownRequested.store(true);
+	_shutdownRequested.notify_all();
 }
 
 // Check the provided name is a valid name for block, route and port.
 bool Manager::isValidName(
 	const std::string& name)
 {
-	std::regex pattern("^[a-z][a-z0-9-]*$");
+	// Same as the pattern "^[a-z][a-z0-9-]*$", checked without building a
+	// regex for each of the names of a large configuration.
+	auto isLower = [](char c) { return c >= 'a' && c <= 'z'; };
+	auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
 
-	return std::regex_match(name, pattern);
+	return !name.empty() && isLower(name.front()) &&
+		   std::all_of(name.begin() + 1, name.end(), [&](char c) { return isLower(c) || isDigit(c) || c == '-'; });
 }
 
 // Load all possible modules.
 void Manager::loadModules(
 	const ConfigData& config)
 {
-	std::filesystem::path exe       = boost::dll::program_location().string();
-	std::filesystem::path exeFolder = exe.parent_path();
+	std::filesystem::path              exe       = boost::dll::program_location().string();
+	std::filesystem::path              exeFolder = exe.parent_path();
+	std::vector<std::filesystem::path> paths;
 
-	// Load modules installed in the same folder as the executable.
-	loadModules(exeFolder);
+	// Find the modules installed in the same folder as the executable.
+	findModules(exeFolder, paths);
 
-	// Load the modules located in the additional folders of the configuration file.
+	// Find the modules located in the additional folders of the configuration file.
 	if (config.find("additionalPackageFolders") != config.end())
 	{
 		for (const auto& current : config.at("additionalPackageFolders"))
@@ -226,15 +720,74 @@ void Manager::loadModules(
 					path = exeFolder / path;
 				}
 
-				loadModules(path);
+				findModules(path, paths);
+			}
+		}
+	}
+
+	// The modules with a manifest that lists none of the classes of the
+	// configuration are not loaded.
+	std::set<std::string>              classNames;
+	std::vector<std::filesystem::path> selected;
+	std::vector<std::filesystem::path> skipped;
+
+	if (config.find("blocks") != config.end())
+	{
+		for (const auto& current : config.at("blocks"))
+		{
+			classNames.insert(current.value("className", std::string()));
+		}
+	}
+	for (const auto& path : paths)
+	{
+		auto manifest = path;
+
+		manifest.replace_extension(Registry::MANIFEST_EXTENSION);
+		if (!std::filesystem::exists(manifest))
+		{
+			selected.push_back(path);
+			continue;
+		}
+
+		try
+		{
+			std::ifstream stream(manifest);
+			auto          blocks = nlohmann::json::parse(stream).at("blocks").get<std::vector<std::string>>();
+
+			if (std::any_of(blocks.begin(), blocks.end(), [&classNames](const auto& className) { return classNames.contains(className); }))
+			{
+				selected.push_back(path);
 			}
+			else
+			{
+				skipped.push_back(path);
+				spdlog::debug("Module {} skipped, no block used", path.string());
+			}
+		}
+		catch (std::exception& e)
+		{
+			spdlog::warn("Module {}: invalid manifest ({}), the module is loaded", path.string(), e.what());
+			selected.push_back(path);
 		}
 	}
+
+	openModules(selected);
+
+	// A manifest may be out of date: the skipped modules are loaded when a
+	// class is still missing.
+	auto missing = std::find_if(classNames.begin(), classNames.end(), [this](const auto& className) { return !_registry.contains(className); });
+
+	if (missing != classNames.end() && !skipped.empty())
+	{
+		spdlog::warn("Class {} not found in the manifests, loading the other modules", *missing);
+		openModules(skipped);
+	}
 }
 
-// Load the external modules located into a given folder.
-void Manager::loadModules(
-	const std::filesystem::path& folder)
+// Find the external modules located into a given folder.
+void Manager::findModules(
+	const std::filesystem::path&        folder,
+	std::vector<std::filesystem::path>& paths)
 {
 	for (const auto& current : std::filesystem::directory_iterator(folder))
 	{
@@ -242,82 +795,398 @@ void Manager::loadModules(
 			current.path().extension() == std::filesystem::path{ ".dll" } ||
 			current.path().extension() == std::filesystem::path{ ".dylib" })
 		{
+			paths.push_back(current.path());
+		}
+	}
+}
+
+// Open modules and register their blocks.
+void Manager::openModules(
+	const std::vector<std::filesystem::path>& paths)
+{
+	// The libraries are opened and their blocks registered in the order of
+	// the paths, libraries without entry point are ignored.
+	for (const auto& path : paths)
+	{
+		try
+		{
+			boost::dll::shared_library lib(path.string());
+			auto                       registerBlocks = lib.get<void(Registry&)>(Registry::ENTRY_POINT_FUNCTION);
+			auto                       prepareLogger  = lib.get<void(const std::string&, spdlog::level::level_enum)>(Registry::PREPARE_LOGGER_FUNCTION);
+
+			registerBlocks(_registry);
+			prepareLogger("%^%l%$: %v", spdlog::get_level());
+
+			_modules.push_back(std::move(lib));
+			spdlog::info("Module {} loaded", path.string());
+		}
+		catch (boost::system::system_error&)
+		{
+			// can't find the entry point, not a new-nav module :-(.
+		}
+	}
+}
+
+// Create the blocks described into the configuration file.
+void Manager::createBlocks(
+	const ConfigData& config)
+{
+	for (const auto& current : config.at("blocks"))
+	{
+		std::string name      = current.at("name").get<std::string>();
+		std::string className = current.at("className").get<std::string>();
+		IBlock*     block     = nullptr;
+
+		// Instantiate the object, or its replicas and the set that shards the
+		// messages over them.
+		try
+		{
+			block = current.find("replicas") != current.end() ? createReplicas(name, className, current) : this->create(name, className);
+		}
+		catch (std::runtime_error& e)
+		{
+			throw std::runtime_error(fmt::format("failed to create block {}: {}", name, e.what()));
+		}
+
+		// Set the limits of the queue of the sinks and of the mailbox of the
+		// coroutine sinks (the queues of the replicas are set when they are
+		// created).
+		if (current.find("queue") != current.end() && dynamic_cast<ReplicaSet*>(block) == nullptr)
+		{
+			auto sink          = dynamic_cast<Sink*>(block);
+			auto coroutineSink = dynamic_cast<CoroutineSink*>(block);
+
+			if (sink == nullptr && coroutineSink == nullptr)
+			{
+				throw std::runtime_error(fmt::format("block '{}' is not a sink, it has no queue", name));
+			}
+
+			try
+			{
+				auto policy = current.at("queue").get<QueuePolicy>();
+
+				if (sink != nullptr)
+				{
+					sink->setQueuePolicy(policy);
+				}
+				else
+				{
+					coroutineSink->setQueuePolicy(policy);
+				}
+			}
+			catch (const std::exception& e)
+			{
+				throw std::runtime_error(fmt::format("block '{}': invalid queue: {}", name, e.what()));
+			}
+		}
+
+		// Set the wait strategy of the sinks.
+		if (current.find("wait") != current.end())
+		{
+			auto sink = dynamic_cast<Sink*>(block);
+
+			if (sink == nullptr)
+			{
+				throw std::runtime_error(fmt::format("block '{}' is not a sink, it has no wait strategy", name));
+			}
+
 			try
 			{
-				boost::dll::shared_library lib(current.path().string());
-				auto                       registerBlocks = lib.get<void(Registry&)>(Registry::ENTRY_POINT_FUNCTION);
-				auto                       prepareLogger  = lib.get<void(const std::string&, spdlog::level::level_enum)>(Registry::PREPARE_LOGGER_FUNCTION);
+				sink->setWaitStrategy(current.at("wait").get<WaitStrategy>());
+			}
+			catch (const std::exception& e)
+			{
+				throw std::runtime_error(fmt::format("block '{}': invalid wait strategy: {}", name, e.what()));
+			}
 
-				registerBlocks(_registry);
-				prepareLogger("%^%l%$: %v", spdlog::get_level());
+			if (sink->waitStrategy().polls() && current.find("executor") != current.end())
+			{
+				throw std::runtime_error(fmt::format("block '{}': a polling sink has its own thread, it cannot join an executor group", name));
+			}
+		}
 
-				_modules.push_back(std::move(lib));
-				spdlog::info("Module {} loaded", current.path().string());
+		// Get the thread policy of the runnables.
+		if (current.find("thread") != current.end())
+		{
+			if (dynamic_cast<IRunnable*>(block) == nullptr)
+			{
+				throw std::runtime_error(fmt::format("block '{}' has no thread, it has no thread policy", name));
+			}
+			if (current.find("executor") != current.end())
+			{
+				throw std::runtime_error(fmt::format("block '{}': a block with a thread policy has its own thread, it cannot join an executor group", name));
+			}
+
+			try
+			{
+				_threadPolicies[name] = current.at("thread").get<ThreadPolicy>();
+			}
+			catch (const std::exception& e)
+			{
+				throw std::runtime_error(fmt::format("block '{}': invalid thread policy: {}", name, e.what()));
+			}
+		}
+
+		// Get the executor group of the block.
+		if (current.find("executor") != current.end())
+		{
+			if (dynamic_cast<Sink*>(block) == nullptr && dynamic_cast<CoroutineBlock*>(block) == nullptr && dynamic_cast<ReplicaSet*>(block) == nullptr)
+			{
+				throw std::runtime_error(fmt::format("block '{}' is not a sink, it cannot join an executor group", name));
+			}
+
+			auto group = current.at("executor").get<std::string>();
+
+			if (!isValidName(group))
+			{
+				throw std::runtime_error(fmt::format("block '{}': invalid executor group '{}'", name, group));
+			}
+			_executorGroups[name] = group;
+		}
+
+		// Instantiate the output ports (the ports of the replicas for a
+		// replicated fiber).
+		auto                 replicaSet = dynamic_cast<ReplicaSet*>(block);
+		std::vector<IBlock*> owners{ block };
+
+		if (replicaSet != nullptr)
+		{
+			owners.assign(replicaSet->replicas().begin(), replicaSet->replicas().end());
+		}
+
+		for (auto owner : owners)
+		{
+			if (auto producer = dynamic_cast<IProducer*>(owner))
+			{
+				std::map<std::string, bool> ports;
+
+				for (auto& portName : producer->ports(current.at("config")))
+				{
+					// Check the name is valid.
+					if (!isValidName(portName))
+					{
+						block->destroy();
+						block = nullptr;
+						throw std::runtime_error(fmt::format("'{}' is not a valid port name (block class '{}')", portName, className));
+					}
+
+					// Check the port name is not already used.
+					if (ports.find(portName) != ports.end())
+					{
+						block->destroy();
+						block = nullptr;
+						throw std::logic_error(fmt::format("block `{}`: another existing port has the same name `{}`", block->name(), portName));
+					}
+
+					auto port = addPort(portName, owner);
+
+					port->setSchema(producer->portSchema(portName));
+					ports[portName] = true;
+				}
+			}
+		}
+
+		// The outputs of the replicas are released in order by the ports of
+		// the set.
+		if (replicaSet != nullptr && replicaSet->resequences())
+		{
+			for (auto& portName : replicaSet->replicas().front()->ports(current.at("config")))
+			{
+				auto output = addPort(portName, replicaSet);
+
+				output->setSchema(replicaSet->replicas().front()->portSchema(portName));
+
+				for (auto replica : replicaSet->replicas())
+				{
+					replicaSet->bind(*static_cast<Port*>(find(replica, portName)), *output);
+				}
+			}
+		}
+	}
+}
+
+// Create the replicas of a fiber and the set that shards the messages over them.
+ReplicaSet* Manager::createReplicas(
+	const std::string& name,
+	const std::string& className,
+	const ConfigData&  config)
+{
+	auto count = config.at("replicas").get<int>();
+
+	if (count < 1)
+	{
+		throw std::runtime_error("the number of replicas shall be at least 1");
+	}
+	if (!isValidName(name))
+	{
+		throw std::runtime_error(fmt::format("'{}' is not a valid block name", name));
+	}
+	if (_blocks.find(name) != _blocks.end())
+	{
+		throw std::runtime_error("another existing block has the same name");
+	}
+
+	ShardPolicy policy;
+
+	if (config.find("shard") != config.end())
+	{
+		try
+		{
+			policy = config.at("shard").get<ShardPolicy>();
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error(fmt::format("invalid shard key: {}", e.what()));
+		}
+	}
+
+	QueuePolicy queuePolicy = ReplicaSet::DEFAULT_QUEUE_POLICY;
+
+	if (config.find("queue") != config.end())
+	{
+		try
+		{
+			queuePolicy = config.at("queue").get<QueuePolicy>();
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error(fmt::format("invalid queue: {}", e.what()));
+		}
+	}
+
+	// The replicas are named after the fiber, they can be found in the logs.
+	std::vector<Fiber*> replicas;
+
+	for (int index = 1; index <= count; ++index)
+	{
+		auto block   = create(fmt::format("{}-{}", name, index), className);
+		auto replica = dynamic_cast<Fiber*>(block);
+
+		if (replica == nullptr)
+		{
+			throw std::runtime_error(fmt::format("class '{}' is not a fiber, it cannot be replicated", className));
+		}
+		replicas.push_back(replica);
+	}
+
+	auto result = new ReplicaSet(name, replicas, policy, config.value("resequence", false), queuePolicy);
+
+	_blocks.emplace(name, result);
+
+	return result;
+}
+
+// Create the routes described into the configuration file.
+void Manager::createRoutes(
+	const ConfigData& config)
+{
+	static const std::string DEFAULT_DISPATCHER_NAME = "default";
+	static const std::string QUEUED_DISPATCH         = "queued";
+	static const std::string INLINE_DISPATCH         = "inline";
+
+	// Get the number of threads and the queue policy of the dispatchers (the
+	// same dispatcher can be used by several routes, only one of them needs to
+	// provide them).
+	std::map<std::string, size_t>       threadCounts;
+	std::map<std::string, QueuePolicy>  queuePolicies;
+	std::map<std::string, WaitStrategy> waitStrategies;
+	int                                 counter = 0;
+
+	_dispatcherThreadPolicies.clear();
+
+	for (const auto& current : config.at("routes"))
+	{
+		++counter;
+
+		if (current.value("dispatch", QUEUED_DISPATCH) == INLINE_DISPATCH)
+		{
+			continue;
+		}
+
+		std::string dispatcherName = current.value("dispatcher", DEFAULT_DISPATCHER_NAME);
+
+		if (current.find("threads") != current.end())
+		{
+			auto threads = current.at("threads").get<int>();
+
+			if (threads < 1)
+			{
+				throw std::runtime_error(fmt::format("route '#{}': the number of threads of dispatcher '{}' shall be at least 1", counter, dispatcherName));
+			}
+
+			auto itr = threadCounts.emplace(dispatcherName, static_cast<size_t>(threads)).first;
+
+			if (itr->second != static_cast<size_t>(threads))
+			{
+				throw std::runtime_error(fmt::format("route '#{}': conflicting number of threads for dispatcher '{}'", counter, dispatcherName));
+			}
+		}
+
+		if (current.find("queue") != current.end())
+		{
+			QueuePolicy policy;
+
+			try
+			{
+				policy = current.at("queue").get<QueuePolicy>();
+			}
+			catch (const std::exception& e)
+			{
+				throw std::runtime_error(fmt::format("route '#{}': invalid queue of dispatcher '{}': {}", counter, dispatcherName, e.what()));
+			}
+
+			auto itr = queuePolicies.emplace(dispatcherName, policy).first;
+
+			if (itr->second != policy)
+			{
+				throw std::runtime_error(fmt::format("route '#{}': conflicting queue for dispatcher '{}'", counter, dispatcherName));
+			}
+		}
+
+		if (current.find("wait") != current.end())
+		{
+			WaitStrategy strategy;
+
+			try
+			{
+				strategy = current.at("wait").get<WaitStrategy>();
 			}
-			catch (boost::system::system_error&)
+			catch (const std::exception& e)
 			{
-				// can't find the entry point, not a new-nav module :-(.
+				throw std::runtime_error(fmt::format("route '#{}': invalid wait strategy of dispatcher '{}': {}", counter, dispatcherName, e.what()));
 			}
-		}
-	}
-}
 
-// Create the blocks described into the configuration file.
-void Manager::createBlocks(
-	const ConfigData& config)
-{
-	for (const auto& current : config.at("blocks"))
-	{
-		std::string name      = current.at("name").get<std::string>();
-		std::string className = current.at("className").get<std::string>();
-		IBlock*     block     = nullptr;
+			auto itr = waitStrategies.emplace(dispatcherName, strategy).first;
 
-		// Instantiate the object.
-		try
-		{
-			block = this->create(name, className);
-		}
-		catch (std::runtime_error& e)
-		{
-			throw std::runtime_error(fmt::format("failed to create block {}: {}", name, e.what()));
+			if (itr->second != strategy)
+			{
+				throw std::runtime_error(fmt::format("route '#{}': conflicting wait strategy for dispatcher '{}'", counter, dispatcherName));
+			}
 		}
 
-		// Instantiate the output ports
-		if (auto producer = dynamic_cast<IProducer*>(block))
+		if (current.find("thread") != current.end())
 		{
-			std::map<std::string, bool> ports;
+			ThreadPolicy policy;
 
-			for (auto& portName : producer->ports(current.at("config")))
+			try
 			{
-				// Check the name is valid.
-				if (!isValidName(portName))
-				{
-					block->destroy();
-					block = nullptr;
-					throw std::runtime_error(fmt::format("'{}' is not a valid port name (block class '{}')", portName, className));
-				}
+				policy = current.at("thread").get<ThreadPolicy>();
+			}
+			catch (const std::exception& e)
+			{
+				throw std::runtime_error(fmt::format("route '#{}': invalid thread policy of dispatcher '{}': {}", counter, dispatcherName, e.what()));
+			}
 
-				// Check the port name is not already used.
-				if (ports.find(portName) != ports.end())
-				{
-					block->destroy();
-					block = nullptr;
-					throw std::logic_error(fmt::format("block `{}`: another existing port has the same name `{}`", block->name(), portName));
-				}
+			auto itr = _dispatcherThreadPolicies.emplace(dispatcherName, policy).first;
 
-				_ports.emplace_back(std::make_unique<Port>(portName, block));
-				ports[portName] = true;
+			if (itr->second != policy)
+			{
+				throw std::runtime_error(fmt::format("route '#{}': conflicting thread policy for dispatcher '{}'", counter, dispatcherName));
 			}
 		}
 	}
-}
-
-// Create the routes described into the configuration file.
-void Manager::createRoutes(
-	const ConfigData& config)
-{
-	int counter = 0;
 
+	counter = 0;
 	for (const auto& current : config.at("routes"))
 	{
 		++counter;
@@ -387,37 +1256,44 @@ void Manager::createRoutes(
 
 				auto block = itrBlock->second;
 
+				// The outputs of a replicated fiber that are not resequenced
+				// are dispatched by the ports of its replicas.
+				std::vector<IBlock*> owners{ block };
+
+				if (auto replicaSet = dynamic_cast<ReplicaSet*>(block); replicaSet != nullptr && !replicaSet->resequences())
+				{
+					owners.assign(replicaSet->replicas().begin(), replicaSet->replicas().end());
+				}
+
 				// Find the port name if no port name is provided.
 				if (portName.empty())
 				{
-					// Scan the ports and check there is only one port for this block.
-					size_t count{ 0 };
-					for (const auto& port : _ports)
+					// Check there is only one port for this block.
+					auto& ports = portsOf(owners.front());
+
+					if (ports.size() == 1)
 					{
-						if (port->block() == block)
-						{
-							++count;
-							portName = port->name();
-						}
+						portName = ports.begin()->first;
 					}
-					if (count > 1)
+					if (ports.size() > 1)
 					{
 						throw std::runtime_error(fmt::format("route '{}': block '{}' has more than one port, port name shall be provided", errName, blockName));
 					}
 				}
 
 				// Find the port.
-				auto itrPort = std::find_if(
-					_ports.cbegin(),
-					_ports.cend(),
-					[&](const std::unique_ptr<Port>& p) { return p->name() == portName && p->block() == block; });
-
-				if (itrPort == _ports.cend())
+				for (auto owner : owners)
 				{
-					throw std::runtime_error(fmt::format("route '{}': port '{}' not found in the definition of a route", errName, current));
-				}
+					auto& ports   = portsOf(owner);
+					auto  itrPort = ports.find(portName);
+
+					if (itrPort == ports.end())
+					{
+						throw std::runtime_error(fmt::format("route '{}': port '{}' not found in the definition of a route", errName, current));
+					}
 
-				result.push_back(itrPort->get());
+					result.push_back(itrPort->second);
+				}
 			}
 
 			return result;
@@ -451,18 +1327,51 @@ void Manager::createRoutes(
 		auto sourcePorts       = prepareSources(sources);
 		auto destinationBlocks = prepareDestinations(destinations);
 
+		// Check the ports issue the schemas expected by the destinations.
+		for (auto destination : destinationBlocks)
+		{
+			if (destination->schema() == RAW_SCHEMA)
+			{
+				continue;
+			}
+
+			for (auto port : sourcePorts)
+			{
+				if (port->schema() != destination->schema())
+				{
+					throw std::runtime_error(fmt::format("route '{}': port '{}.{}' issues messages of schema {}, block '{}' expects schema {}",
+														 errName, port->block()->name(), port->name(), port->schema(), dynamic_cast<IBlock*>(destination)->name(), destination->schema()));
+				}
+			}
+		}
+
 		// When the route is named, check it is unique.
 		if (!name.empty() && _namedRoutes.find(name) != _namedRoutes.end())
 		{
 			throw std::runtime_error(fmt::format("route '{}' is already defined", name));
 		}
 
-		// Create or find the dispatcher.
+		// Get the dispatch mode.
+		std::string mode = current.value("dispatch", QUEUED_DISPATCH);
+
+		if (mode != QUEUED_DISPATCH && mode != INLINE_DISPATCH)
+		{
+			throw std::runtime_error(fmt::format("route '{}': unknown dispatch mode '{}'", errName, mode));
+		}
+		if (mode == INLINE_DISPATCH &&
+			(current.find("dispatcher") != current.end() || current.find("threads") != current.end() || current.find("queue") != current.end() ||
+			 current.find("wait") != current.end() || current.find("thread") != current.end() || current.find("priority") != current.end()))
+		{
+			throw std::runtime_error(fmt::format("route '{}': an inline route shall not define a dispatcher", errName));
+		}
+
+		// Create or find the dispatcher (inline routes have no dispatcher).
 		Dispatcher* dispatcher = nullptr;
+
+		if (mode == QUEUED_DISPATCH)
 		{
 			// Get the name of the dispatcher.
-			static const std::string DEFAULT_DISPATCHER_NAME = "default";
-			std::string              dispatcherName{ DEFAULT_DISPATCHER_NAME };
+			std::string dispatcherName{ DEFAULT_DISPATCHER_NAME };
 
 			if (current.find("dispatcher") != current.end())
 			{
@@ -478,7 +1387,22 @@ void Manager::createRoutes(
 
 			if (itr == _dispatchers.end())
 			{
-				dispatcher = _dispatchers.emplace(dispatcherName, std::make_unique<Dispatcher>(dispatcherName)).first->second.get();
+				auto threads = threadCounts.find(dispatcherName);
+				auto policy  = queuePolicies.find(dispatcherName);
+
+				dispatcher = _dispatchers
+								 .emplace(
+									 dispatcherName,
+									 std::make_unique<Dispatcher>(
+										 dispatcherName,
+										 threads == threadCounts.end() ? 1 : threads->second,
+										 policy == queuePolicies.end() ? Dispatcher::DEFAULT_QUEUE_POLICY : policy->second))
+								 .first->second.get();
+
+				if (auto strategy = waitStrategies.find(dispatcherName); strategy != waitStrategies.end())
+				{
+					dispatcher->setWaitStrategy(strategy->second);
+				}
 			}
 			else
 			{
@@ -489,12 +1413,48 @@ void Manager::createRoutes(
 		// Create the route.
 		auto& route = _routes.emplace_back(std::make_unique<Route>(sourcePorts, destinationBlocks, dispatcher));
 
+		// Set the priority of the messages in the queue of the dispatcher.
+		if (current.find("priority") != current.end())
+		{
+			auto value    = current.at("priority").get<std::string>();
+			auto priority = std::find(std::begin(PRIORITY_NAMES), std::end(PRIORITY_NAMES), value);
+
+			if (priority == std::end(PRIORITY_NAMES))
+			{
+				throw std::runtime_error(fmt::format("route '{}': unknown priority '{}'", errName, value));
+			}
+			route->setPriority(static_cast<RoutePriority>(priority - std::begin(PRIORITY_NAMES)));
+		}
+
+		// Set the filter evaluated before the messages are queued.
+		if (current.find("filter") != current.end())
+		{
+			try
+			{
+				route->setFilter(current.at("filter").get<RouteFilter>());
+			}
+			catch (const std::exception& e)
+			{
+				throw std::runtime_error(fmt::format("route '{}': invalid filter: {}", errName, e.what()));
+			}
+		}
+
 		// register it with its name eventually.
 		if (!name.empty())
 		{
+			route->setName(name);
 			_namedRoutes.emplace(name, _routes.back().get());
 		}
 
+		// A queued route without any option of its dispatcher can be fused
+		// when the plan is compiled.
+		static const std::vector<std::string> DISPATCH_OPTIONS{ "dispatch", "dispatcher", "threads", "queue", "wait", "thread", "priority" };
+
+		if (std::none_of(DISPATCH_OPTIONS.begin(), DISPATCH_OPTIONS.end(), [&current](const std::string& key) { return current.find(key) != current.end(); }))
+		{
+			_fusableRoutes.insert(route.get());
+		}
+
 		// Register the route to its source ports.
 		for (auto& sourcePort : sourcePorts)
 		{
@@ -503,23 +1463,380 @@ void Manager::createRoutes(
 	}
 }
 
+// Check that the inline routes can be executed in the threads of the producers.
+void Manager::checkInlineRoutes() const
+{
+	auto blockName = [](IConsumer* consumer) {
+		auto block = dynamic_cast<IBlock*>(consumer);
+
+		return block ? block->name() : std::string("?");
+	};
+
+	// Count the paths (a source port of a route) that feed each consumer.
+	std::map<IConsumer*, size_t> paths;
+
+	for (const auto& route : _routes)
+	{
+		for (auto destination : route->destinations())
+		{
+			paths[destination] += route->ports().size();
+		}
+	}
+
+	// A consumer called inline that is not thread-safe shall only be fed by
+	// one path, otherwise it could be called by several threads at once.
+	std::map<const IBlock*, std::set<const IBlock*>> edges;
+
+	for (const auto& route : _routes)
+	{
+		if (!route->isInline())
+		{
+			continue;
+		}
+
+		for (auto destination : route->destinations())
+		{
+			if (!destination->isThreadSafe() && paths[destination] > 1)
+			{
+				throw std::runtime_error(fmt::format("block '{}' is not thread-safe, it cannot be fed by several ports when one of its routes is inline", blockName(destination)));
+			}
+
+			for (auto port : route->ports())
+			{
+				edges[port->block()].insert(dynamic_cast<IBlock*>(destination));
+			}
+		}
+	}
+
+	// The inline routes shall not form a cycle (the message would be consumed
+	// recursively forever).
+	enum class State
+	{
+		visiting,
+		visited
+	};
+	std::map<const IBlock*, State>     states;
+	std::function<void(const IBlock*)> visit = [&](const IBlock* block) {
+		states[block] = State::visiting;
+
+		for (auto next : edges[block])
+		{
+			auto itr = states.find(next);
+
+			if (itr == states.end())
+			{
+				visit(next);
+			}
+			else if (itr->second == State::visiting)
+			{
+				throw std::runtime_error(fmt::format("inline routes form a cycle through block '{}'", next ? next->name() : std::string("?")));
+			}
+		}
+
+		states[block] = State::visited;
+	};
+
+	for (const auto& current : edges)
+	{
+		if (states.find(current.first) == states.end())
+		{
+			visit(current.first);
+		}
+	}
+}
+
+// Compile the execution plan.
+void Manager::compilePlan()
+{
+	size_t fused = 0;
+
+	if (_fuseFibers)
+	{
+		// Count the paths (a source port of a route) that feed each consumer.
+		std::map<const IConsumer*, size_t> paths;
+
+		for (const auto& route : _routes)
+		{
+			for (auto destination : route->destinations())
+			{
+				paths[destination] += route->ports().size();
+			}
+		}
+
+		// Check if a block reaches another one through inline routes.
+		std::function<bool(const IBlock*, const IBlock*, std::set<const IBlock*>&)> reaches =
+			[&](const IBlock* from, const IBlock* to, std::set<const IBlock*>& visited) {
+				if (from == to)
+				{
+					return true;
+				}
+				if (!visited.insert(from).second)
+				{
+					return false;
+				}
+				for (const auto& [portName, port] : portsOf(from))
+				{
+					for (auto route : port->routes())
+					{
+						for (auto destination : route->destinations())
+						{
+							if (route->isInline() && reaches(dynamic_cast<const IBlock*>(destination), to, visited))
+							{
+								return true;
+							}
+						}
+					}
+				}
+				return false;
+			};
+
+		// Fuse the routes that link a fiber with a single output to a fiber
+		// with a single input: the downstream fiber is called by the thread
+		// of the upstream one instead of going through a queue.
+		for (const auto& route : _routes)
+		{
+			if (_fusableRoutes.find(route.get()) == _fusableRoutes.end() || route->ports().size() != 1 || route->destinations().size() != 1)
+			{
+				continue;
+			}
+
+			auto port       = route->ports().front();
+			auto upstream   = dynamic_cast<Fiber*>(port->block());
+			auto downstream = dynamic_cast<Fiber*>(route->destinations().front());
+
+			if (upstream == nullptr || downstream == nullptr || port->routes().size() != 1 || paths[downstream] != 1)
+			{
+				continue;
+			}
+
+			// The downstream fiber is called by the threads of the upstream
+			// one: they shall be sequential unless it is thread-safe.
+			if (!downstream->isThreadSafe() && paths[upstream] != 1)
+			{
+				continue;
+			}
+
+			// The fused routes shall not form a cycle with the inline ones.
+			std::set<const IBlock*> visited;
+
+			if (reaches(downstream, upstream, visited))
+			{
+				continue;
+			}
+
+			route->fuse();
+			++fused;
+			spdlog::info("Plan: queued route '{}.{}' -> '{}' fused, '{}' is called by the thread of '{}'", upstream->name(), port->name(), downstream->name(),
+						 downstream->name(), upstream->name());
+		}
+	}
+
+	// Log the plan.
+	spdlog::info("Execution plan: {} routes, {} fused", _routes.size(), fused);
+	for (const auto& port : _ports)
+	{
+		auto source = fmt::format("{}.{}", port->block() ? port->block()->name() : std::string("?"), port->name());
+
+		for (auto route : port->routes())
+		{
+			std::string mode;
+			std::string destinations;
+
+			if (route->isFused())
+			{
+				mode = "fused";
+			}
+			else if (route->isInline())
+			{
+				mode = "inline";
+			}
+			else
+			{
+				mode = fmt::format("dispatcher '{}' ({})", route->dispatcher()->name(), PRIORITY_NAMES[static_cast<size_t>(route->priority())]);
+			}
+
+			for (auto destination : route->destinations())
+			{
+				auto block = dynamic_cast<const IBlock*>(destination);
+
+				destinations += fmt::format("{}'{}'", destinations.empty() ? "" : ", ", block ? block->name() : std::string("?"));
+			}
+
+			if (!route->filter().empty())
+			{
+				mode += " filtered";
+			}
+
+			spdlog::info("Plan: '{}' -> {} -> {}", source, mode, destinations);
+		}
+	}
+}
+
+// Apply a thread policy to the calling thread and log where it runs.
+void Manager::applyThreadPolicy(
+	const std::string&  owner,
+	const ThreadPolicy& policy)
+{
+	try
+	{
+		policy.apply();
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error("{}: {}", owner, e.what());
+	}
+
+	logThread(owner);
+}
+
+// Get the executor that schedules a block.
+Executor& Manager::executorOf(
+	const std::string& blockName)
+{
+	auto group = _executorGroups.find(blockName);
+
+	return group == _executorGroups.end() ? *_executor : *_groups.at(group->second);
+}
+
+// Log the end of a coroutine block.
+void Manager::report(
+	CoroutineBlock* block)
+{
+	spdlog::info("Block '{}' terminated", block->name());
+
+	// Log the overflows of the mailbox.
+	if (auto sink = dynamic_cast<CoroutineSink*>(block))
+	{
+		auto overflows = sink->overflows();
+
+		if (overflows.blocked > 0 || overflows.dropped > 0)
+		{
+			spdlog::warn("Block '{}': queue full, {} producers blocked, {} messages dropped", block->name(), overflows.blocked, overflows.dropped);
+		}
+	}
+
+	if (auto exception = block->exception())
+	{
+		try
+		{
+			std::rethrow_exception(exception);
+		}
+		catch (const std::exception& e)
+		{
+			spdlog::error("Block '{}': coroutine failed: {}", block->name(), e.what());
+		}
+		catch (...)
+		{
+			spdlog::error("Block '{}': coroutine failed", block->name());
+		}
+	}
+}
+
+// Log the end of a runnable.
+void Manager::report(
+	IRunnable* runnable)
+{
+	std::string                  type;
+	std::string                  name;
+	BatchCounters::Statistics    batches;
+	OverflowCounters::Statistics overflows;
+
+	if (auto block = dynamic_cast<IBlock*>(runnable))
+	{
+		type = "Block";
+		name = block->name();
+		if (auto sink = dynamic_cast<Sink*>(runnable))
+		{
+			batches   = sink->statistics();
+			overflows = sink->overflows();
+		}
+	}
+	else if (auto dispatcher = dynamic_cast<Dispatcher*>(runnable))
+	{
+		type      = "Dispatcher";
+		name      = dispatcher->name();
+		batches   = dispatcher->statistics();
+		overflows = dispatcher->overflows();
+	}
+	spdlog::info("{} '{}' terminated", type, name);
+
+	// Log the amortisation of the batches.
+	if (batches.batches > 0)
+	{
+		spdlog::info("{} '{}': {} messages in {} batches (mean {:.1f}), sizes {}", type, name, batches.elements, batches.batches, batches.mean(), batches.toString());
+	}
+
+	// Log the overflows of the queue.
+	if (overflows.blocked > 0 || overflows.dropped > 0)
+	{
+		spdlog::warn("{} '{}': queue full, {} producers blocked, {} messages dropped", type, name, overflows.blocked, overflows.dropped);
+	}
+
+	// Log the time spent in the priority lanes.
+	if (auto dispatcher = dynamic_cast<Dispatcher*>(runnable))
+	{
+		auto lanes = dispatcher->lanes();
+
+		for (size_t index = 0; index < lanes.size(); ++index)
+		{
+			if (lanes[index].processed > 0)
+			{
+				spdlog::info("{} '{}': lane {}: {} requests, wait mean {:.1f} us, max {:.1f} us, {} pending, {} promoted batches", type, name, PRIORITY_NAMES[index],
+							 lanes[index].processed, lanes[index].meanWait() / 1e3, static_cast<double>(lanes[index].maxWait) / 1e3, lanes[index].depth,
+							 lanes[index].promoted);
+			}
+		}
+	}
+}
+
 // Initialize the blocks.
 void Manager::initializeBlocks(
 	const ConfigData& config)
 {
+	// The blocks (and the replicas of the replicated fibers) are initialized
+	// in the order of the configuration, concurrently when several startup
+	// threads are configured.
+	struct Initialization
+	{
+		IBlock*            block;
+		const std::string& name;
+		const ConfigData&  config;
+	};
+
+	std::vector<std::string>    names;
+	std::vector<Initialization> initializations;
+
 	for (const auto& current : config["blocks"])
 	{
-		std::string name = current.at("name").get<std::string>();
+		names.push_back(current.at("name").get<std::string>());
+	}
+	for (size_t index = 0; index < names.size(); ++index)
+	{
+		auto  block       = _blocks.find(names[index])->second;
+		auto& blockConfig = config["blocks"][index].at("config");
+
+		initializations.push_back({ block, names[index], blockConfig });
+		if (auto replicaSet = dynamic_cast<ReplicaSet*>(block))
+		{
+			for (auto replica : replicaSet->replicas())
+			{
+				initializations.push_back({ replica, names[index], blockConfig });
+			}
+		}
+	}
+
+	parallelFor(initializations.size(), _startupThreads, [this, &initializations](size_t index) {
+		auto& current = initializations[index];
 
 		try
 		{
-			_blocks.find(name)->second->initialize(current.at("config"), this);
+			current.block->initialize(current.config, this);
 		}
 		catch (std::runtime_error& e)
 		{
-			throw std::runtime_error(fmt::format("failed to create block {}: {}", name, e.what()));
+			throw std::runtime_error(fmt::format("failed to create block {}: {}", current.name, e.what()));
 		}
-	}
+	});
 }
 
 } // namespace framework
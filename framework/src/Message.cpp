@@ -7,9 +7,13 @@
 /// @copyright Copyright (c) 2024, Xavier Caroff
 ///
 
+#include <chrono>
 #include <cstring>
+#include <new>
 
 #include "synapse/framework/Message.h"
+#include "synapse/framework/MessagePool.h"
+#include "synapse/framework/MessagePtr.h"
 
 namespace synapse {
 namespace framework {
@@ -19,10 +23,7 @@ Message::Message(
 	size_t size)
 	: _size(size)
 {
-	if (size > 0)
-	{
-		_payload = new uint8_t[size];
-	}
+	allocatePayload();
 }
 
 // Constructor with initialization of the payload.
@@ -31,44 +32,186 @@ Message::Message(
 	const uint8_t* payload)
 	: _size(size)
 {
+	allocatePayload();
+
 	if (size > 0)
 	{
-		_payload = new uint8_t[size];
 		std::memcpy(_payload, payload, size);
 	}
 }
 
+// Constructor of a message stored in a block of the pool.
+Message::Message(
+	size_t  size,
+	size_t  blockSize,
+	Storage storage)
+	: _payload(nullptr),
+	  _size(size),
+	  _blockSize(blockSize),
+	  _storage(storage)
+{
+	if (storage == Storage::embedded)
+	{
+		_payload = reinterpret_cast<uint8_t*>(this + 1);
+	}
+}
+
 // Move constructor.
 Message::Message(
 	Message&& other) noexcept
 {
-	_payload       = other._payload;
-	_size          = other._size;
-	other._payload = nullptr;
-	other._size    = 0;
+	acquire(other);
 }
 
 // Destructor.
 Message::~Message()
 {
-	if (_payload != nullptr)
+	releasePayload();
+}
+
+// Create a message shared with a MessagePtr without initialization of the payload.
+MessagePtr Message::create(
+	size_t size)
+{
+	// The payload follows the object in the block (only the room it needs).
+	auto blockSize = sizeof(Message) + size;
+	auto block     = MessagePool::instance().allocate(blockSize);
+
+	return MessagePtr(new (block) Message(size, blockSize, Storage::embedded));
+}
+
+// Create a message shared with a MessagePtr with initialization of the payload.
+MessagePtr Message::create(
+	size_t         size,
+	const uint8_t* payload)
+{
+	auto result = create(size);
+
+	if (size > 0)
 	{
-		delete[] _payload;
-		_payload = nullptr;
+		std::memcpy(result->payload(), payload, size);
 	}
+
+	return result;
+}
+
+// Create a message derived from another one.
+MessagePtr Message::create(
+	size_t          size,
+	const uint8_t*  payload,
+	const Metadata& metadata)
+{
+	auto result = create(size, payload);
+
+	result->_metadata = metadata;
+
+	return result;
+}
+
+// Create a message that references a sub-range of the payload of another message.
+MessagePtr Message::slice(
+	const MessagePtr& parent,
+	size_t            offset,
+	size_t            size)
+{
+	// A slice of a slice references the message that stores the payload.
+	auto root  = parent->_storage == Storage::slice ? parent->_parent : parent.get();
+	auto block = MessagePool::instance().allocate(sizeof(Message));
+	auto slice = new (block) Message(size, sizeof(Message), Storage::slice);
+
+	root->addRef();
+	slice->_parent   = root;
+	slice->_payload  = parent->_payload + offset;
+	slice->_metadata = parent->_metadata;
+
+	return MessagePtr(slice);
 }
 
 // Move operator.
 Message& Message::operator=(
 	Message&& other) noexcept
 {
-	_payload       = other._payload;
-	_size          = other._size;
-	other._payload = nullptr;
-	other._size    = 0;
+	if (this != &other)
+	{
+		releasePayload();
+		acquire(other);
+	}
 
 	return *this;
 }
 
+// Acquire the payload of another message.
+void Message::acquire(
+	Message& other)
+{
+	_size     = other._size;
+	_storage  = Storage::pool;
+	_metadata = other._metadata;
+	_schema   = other._schema;
+
+	if (other._storage == Storage::pool)
+	{
+		_payload       = other._payload;
+		other._payload = nullptr;
+		other._size    = 0;
+	}
+	else
+	{
+		// The payload is not owned by the other message alone, it is copied.
+		allocatePayload();
+
+		if (_size > 0)
+		{
+			std::memcpy(_payload, other._payload, _size);
+		}
+	}
+}
+
+// Allocate the storage of the payload according to its size.
+void Message::allocatePayload()
+{
+	if (_size == 0)
+	{
+		_payload = nullptr;
+		_storage = Storage::pool;
+	}
+	else
+	{
+		_payload = MessagePool::instance().allocate(_size);
+		_storage = Storage::pool;
+	}
+}
+
+// Release the payload of the message.
+void Message::releasePayload() noexcept
+{
+	if (_storage == Storage::pool)
+	{
+		MessagePool::instance().release(_payload, _size);
+	}
+	else if (_storage == Storage::slice)
+	{
+		_parent->release();
+		_parent = nullptr;
+	}
+	_payload = nullptr;
+}
+
+// Get the current time of the clock used for the timestamps.
+uint64_t Message::Metadata::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Destroy a message created with create() and release its block.
+void Message::destroy() const noexcept
+{
+	auto block     = reinterpret_cast<uint8_t*>(const_cast<Message*>(this));
+	auto blockSize = _blockSize;
+
+	this->~Message();
+	MessagePool::instance().release(block, blockSize);
+}
+
 } // namespace framework
 } // namespace synapse
\ No newline at end of file
@@ -0,0 +1,370 @@
+///
+/// @file MessagePool.cpp
+///
+/// Implementation of the MessagePool class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <new>
+
+#include "synapse/framework/MessagePool.h"
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// State of the cache of a thread.
+///
+enum class CacheState : uint8_t
+{
+	/// The cache has not been created yet.
+	none,
+	/// The cache is usable.
+	alive,
+	/// The cache has been destroyed (the thread terminates).
+	destroyed,
+};
+
+/// The state of the cache of the calling thread (trivial, so that it can
+/// still be read after the cache has been destroyed).
+thread_local CacheState cacheState{ CacheState::none };
+
+} // namespace
+
+///
+/// Cache of free blocks owned by a thread.
+///
+/// The counters are only written by the owning thread, they are atomic so that
+/// they can be read by statistics() from any thread.
+///
+struct MessagePool::ThreadCache
+{
+	/// The free blocks for each size class.
+	std::array<std::vector<uint8_t*>, CLASS_COUNT> blocks;
+
+	/// Number of allocations served by the cache or the depot.
+	std::atomic<uint64_t>                          hits{ 0 };
+
+	/// Number of allocations served by the heap.
+	std::atomic<uint64_t>                          misses{ 0 };
+
+	/// Number of allocations larger than the largest size class.
+	std::atomic<uint64_t>                          oversized{ 0 };
+
+	/// Constructor.
+	ThreadCache()
+	{
+		for (auto& current : blocks)
+		{
+			current.reserve(CACHE_CAPACITY + 1);
+		}
+
+		MessagePool::instance().attach(this);
+		cacheState = CacheState::alive;
+	}
+
+	/// Destructor.
+	~ThreadCache()
+	{
+		cacheState = CacheState::destroyed;
+		MessagePool::instance().detach(this);
+	}
+
+	/// Increment a counter (only called by the owning thread).
+	///
+	/// @param counter The counter to increment.
+	static void increment(
+		std::atomic<uint64_t>& counter)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+};
+
+// Constructor.
+MessagePool::MessagePool()
+{
+}
+
+// Destructor.
+MessagePool::~MessagePool()
+{
+}
+
+// Get access to the unique instance of the pool.
+MessagePool& MessagePool::instance()
+{
+	static MessagePool* instance = new MessagePool();
+
+	return *instance;
+}
+
+// Allocate a block.
+uint8_t* MessagePool::allocate(
+	size_t size)
+{
+	auto     cache  = threadCache();
+	auto     index  = classIndex(size);
+	uint8_t* result = nullptr;
+
+	// The cache of the thread is already destroyed.
+	if (cache == nullptr)
+	{
+		return allocateShared(size);
+	}
+
+	// Requests larger than the largest size class are served by the heap.
+	if (index == CLASS_COUNT)
+	{
+		ThreadCache::increment(cache->oversized);
+		ThreadCache::increment(cache->misses);
+		result = static_cast<uint8_t*>(::operator new(size));
+	}
+	else
+	{
+		auto& blocks = cache->blocks[index];
+
+		// Get a batch of blocks from the depot when the thread cache is empty.
+		if (blocks.empty())
+		{
+			refill(index, blocks);
+		}
+
+		if (!blocks.empty())
+		{
+			ThreadCache::increment(cache->hits);
+			result = blocks.back();
+			blocks.pop_back();
+		}
+		else
+		{
+			ThreadCache::increment(cache->misses);
+			result = static_cast<uint8_t*>(::operator new(MIN_BLOCK_SIZE << index));
+		}
+	}
+
+	return result;
+}
+
+// Release a block previously obtained with allocate().
+void MessagePool::release(
+	uint8_t* block,
+	size_t   size)
+{
+	auto index = classIndex(size);
+
+	if (block == nullptr)
+	{
+		// Nothing to do.
+	}
+	else if (index == CLASS_COUNT)
+	{
+		::operator delete(block);
+	}
+	else if (auto cache = threadCache(); cache == nullptr)
+	{
+		// The cache of the thread is already destroyed.
+		releaseShared(block, index);
+	}
+	else
+	{
+		auto& blocks = cache->blocks[index];
+
+		blocks.push_back(block);
+
+		// Give a batch of blocks back to the depot when the thread cache is full.
+		if (blocks.size() > CACHE_CAPACITY)
+		{
+			drain(index, blocks, BATCH_SIZE);
+		}
+	}
+}
+
+// Get the counters of the pool.
+MessagePool::Statistics MessagePool::statistics() const
+{
+	std::lock_guard<std::mutex> lock(_mtxCaches);
+	Statistics                  result = _retired;
+
+	for (const auto& current : _caches)
+	{
+		result.hits += current->hits.load(std::memory_order_relaxed);
+		result.misses += current->misses.load(std::memory_order_relaxed);
+		result.oversized += current->oversized.load(std::memory_order_relaxed);
+	}
+
+	return result;
+}
+
+// Get the size class of a request.
+size_t MessagePool::classIndex(
+	size_t size)
+{
+	size_t result = 0;
+
+	if (size > MAX_BLOCK_SIZE)
+	{
+		result = CLASS_COUNT;
+	}
+	else if (size > MIN_BLOCK_SIZE)
+	{
+		result = std::bit_width(size - 1) - std::bit_width(MIN_BLOCK_SIZE - 1);
+	}
+
+	return result;
+}
+
+// Get the cache of the calling thread.
+MessagePool::ThreadCache* MessagePool::threadCache()
+{
+	// A message released by the destructor of another thread_local or static
+	// object may come after the cache of its thread.
+	if (cacheState == CacheState::destroyed)
+	{
+		return nullptr;
+	}
+
+	thread_local ThreadCache cache;
+
+	return &cache;
+}
+
+// Allocate a block without the cache of the thread.
+uint8_t* MessagePool::allocateShared(
+	size_t size)
+{
+	auto     index  = classIndex(size);
+	uint8_t* result = nullptr;
+
+	if (index < CLASS_COUNT)
+	{
+		std::lock_guard<std::mutex> lock(_mtxDepot);
+		auto&                       depot = _depot[index];
+
+		if (!depot.empty())
+		{
+			result = depot.back();
+			depot.pop_back();
+		}
+	}
+
+	// The counters are kept with the ones of the terminated threads.
+	{
+		std::lock_guard<std::mutex> lock(_mtxCaches);
+
+		if (result != nullptr)
+		{
+			++_retired.hits;
+		}
+		else
+		{
+			++_retired.misses;
+			if (index == CLASS_COUNT)
+			{
+				++_retired.oversized;
+			}
+		}
+	}
+
+	if (result == nullptr)
+	{
+		result = static_cast<uint8_t*>(::operator new(index == CLASS_COUNT ? size : MIN_BLOCK_SIZE << index));
+	}
+
+	return result;
+}
+
+// Release a block without the cache of the thread.
+void MessagePool::releaseShared(
+	uint8_t* block,
+	size_t   index)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtxDepot);
+		auto&                       depot = _depot[index];
+
+		if (depot.size() < DEPOT_CAPACITY)
+		{
+			depot.push_back(block);
+			return;
+		}
+	}
+
+	::operator delete(block);
+}
+
+// Register a new thread cache.
+void MessagePool::attach(
+	ThreadCache* cache)
+{
+	std::lock_guard<std::mutex> lock(_mtxCaches);
+
+	_caches.push_back(cache);
+}
+
+// Unregister a thread cache when its thread terminates.
+void MessagePool::detach(
+	ThreadCache* cache)
+{
+	// Give all the free blocks back to the depot.
+	for (size_t index = 0; index < CLASS_COUNT; ++index)
+	{
+		drain(index, cache->blocks[index], cache->blocks[index].size());
+	}
+
+	// Keep the counters of the thread.
+	std::lock_guard<std::mutex> lock(_mtxCaches);
+
+	_retired.hits += cache->hits.load(std::memory_order_relaxed);
+	_retired.misses += cache->misses.load(std::memory_order_relaxed);
+	_retired.oversized += cache->oversized.load(std::memory_order_relaxed);
+	_caches.remove(cache);
+}
+
+// Move a batch of free blocks from the depot to a thread cache.
+void MessagePool::refill(
+	size_t                 index,
+	std::vector<uint8_t*>& blocks)
+{
+	std::lock_guard<std::mutex> lock(_mtxDepot);
+	auto&                       depot = _depot[index];
+	auto                        count = std::min(BATCH_SIZE, depot.size());
+
+	blocks.insert(blocks.end(), depot.end() - count, depot.end());
+	depot.resize(depot.size() - count);
+}
+
+// Move a batch of free blocks from a thread cache to the depot.
+void MessagePool::drain(
+	size_t                 index,
+	std::vector<uint8_t*>& blocks,
+	size_t                 count)
+{
+	auto   first = blocks.end() - std::min(count, blocks.size());
+	size_t kept  = 0;
+
+	// Blocks that do not fit in the depot are given back to the heap.
+	{
+		std::lock_guard<std::mutex> lock(_mtxDepot);
+		auto&                       depot = _depot[index];
+
+		kept = std::min<size_t>(blocks.end() - first, DEPOT_CAPACITY - std::min(DEPOT_CAPACITY, depot.size()));
+		depot.insert(depot.end(), first, first + kept);
+	}
+
+	for (auto itr = first + kept; itr != blocks.end(); ++itr)
+	{
+		::operator delete(*itr);
+	}
+
+	blocks.erase(first, blocks.end());
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,68 @@
+///
+/// @file MessagePtr.cpp
+///
+/// Implementation of the MessagePtr class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include "synapse/framework/MessagePtr.h"
+
+namespace synapse {
+namespace framework {
+
+///
+/// Deleter of the std::shared_ptr obtained with share().
+///
+/// The deleter holds a reference on the message, this reference is released
+/// when the control block of the std::shared_ptr is destroyed.
+///
+struct MessagePtr::Owner
+{
+	/// The reference on the shared message.
+	MessagePtr message;
+
+	/// Nothing to do, the reference is released with the deleter.
+	void operator()(
+		Message*) const noexcept
+	{
+	}
+};
+
+// Constructor from a message shared with a std::shared_ptr (legacy).
+MessagePtr::MessagePtr(
+	const std::shared_ptr<Message>& message)
+{
+	if (message == nullptr)
+	{
+		// Null handle.
+	}
+	else if (auto owner = std::get_deleter<Owner>(message); owner != nullptr)
+	{
+		// The message has been shared with share(), reference it again.
+		*this = owner->message;
+	}
+	else
+	{
+		// Copy the message, a structured payload keeps its schema.
+		*this             = Message::create(message->size(), message->payload(), message->metadata());
+		_message->_schema = message->schema();
+	}
+}
+
+// Share the message with a std::shared_ptr (legacy).
+std::shared_ptr<Message> MessagePtr::share() const
+{
+	std::shared_ptr<Message> result;
+
+	if (_message != nullptr)
+	{
+		result = std::shared_ptr<Message>(_message, Owner{ *this });
+	}
+
+	return result;
+}
+
+} // namespace framework
+} // namespace synapse
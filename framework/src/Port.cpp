@@ -7,6 +7,8 @@
 /// @copyright Copyright (c) 2024, Xavier Caroff
 ///
 
+#include <algorithm>
+
 #include "synapse/framework/Port.h"
 
 namespace synapse {
@@ -15,9 +17,11 @@ namespace framework {
 // Constructor.
 Port::Port(
 	const std::string& name,
-	IBlock*            block)
+	IBlock*            block,
+	uint32_t           id)
 	: _name(name),
-	  _block(block)
+	  _block(block),
+	  _id(id)
 {
 }
 
@@ -28,8 +32,22 @@ Port::~Port()
 
 // Forward a message to destinations attached to this port.
 void Port::dispatch(
-	const std::shared_ptr<Message>& message)
+	const MessagePtr& message)
 {
+	auto& metadata = message->metadata();
+
+	// Stamp the messages issued by the block of this port.
+	if (metadata.origin == 0)
+	{
+		metadata.origin   = _id;
+		metadata.sequence = _sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+
+		if (metadata.timestamp == 0)
+		{
+			metadata.timestamp = Message::Metadata::now();
+		}
+	}
+
 	for (auto& route : _routes)
 	{
 		route->dispatch(message, *this);
@@ -0,0 +1,301 @@
+///
+/// @file ReplicaSet.cpp
+///
+/// Implementation of the ReplicaSet class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include <fmt/format.h>
+
+#include "synapse/framework/ReplicaSet.h"
+
+namespace synapse {
+namespace framework {
+
+// Constructor of a worker.
+ReplicaSet::Worker::Worker(
+	ReplicaSet& set,
+	Fiber&      replica,
+	size_t      capacity)
+	: set(set)
+	, replica(replica)
+	, jobs(capacity)
+{
+	batch.reserve(jobs.capacity());
+}
+
+// Process the queued messages of a replica.
+void ReplicaSet::Worker::execute()
+{
+	batch.clear();
+	jobs.tryPopAll(batch);
+
+	for (auto& job : batch)
+	{
+		ticket.store(job.ticket);
+		replica.consume(job.message);
+		if (set._resequence)
+		{
+			set.complete(job.ticket);
+		}
+	}
+	batch.clear();
+
+	// Submit the worker again if messages arrived meanwhile (the fence pairs
+	// with the one of the ring after a message has been added).
+	scheduled.store(false);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (!set._shutdown.load() && !jobs.empty() && !scheduled.exchange(true))
+	{
+		set._executor->submit(*this);
+	}
+}
+
+// Constructor.
+ReplicaSet::ReplicaSet(
+	const std::string&         name,
+	const std::vector<Fiber*>& replicas,
+	const ShardPolicy&         policy,
+	bool                       resequence,
+	const QueuePolicy&         queuePolicy)
+	: BaseBlock(name)
+	, _replicas(replicas)
+	, _policy(policy)
+	, _resequence(resequence)
+	, _queuePolicy(queuePolicy)
+{
+	if (replicas.empty())
+	{
+		throw std::invalid_argument("a replica set needs at least one replica");
+	}
+	if (queuePolicy.capacity == 0)
+	{
+		throw std::invalid_argument("the queues of the replicas cannot be empty");
+	}
+
+	for (auto replica : _replicas)
+	{
+		_workers.push_back(std::make_unique<Worker>(*this, *replica, queuePolicy.capacity));
+	}
+}
+
+// Destructor.
+ReplicaSet::~ReplicaSet()
+{
+}
+
+// Ask the block to prepare to be deleted.
+void ReplicaSet::shutdown()
+{
+	_shutdown.store(true);
+
+	for (auto& worker : _workers)
+	{
+		worker->jobs.close();
+	}
+}
+
+// Queue a message for its replica.
+void ReplicaSet::consume(
+	const MessagePtr& message)
+{
+	if (_shutdown.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	auto& worker = *_workers[shardOf(message)];
+	Job   job{ message, _nextTicket.fetch_add(1) };
+
+	// The queue is full, apply the overflow policy. The inputs that are
+	// discarded are marked as processed, so that the outputs of the next ones
+	// are released.
+	if (!worker.jobs.tryPush(job))
+	{
+		switch (_queuePolicy.overflow)
+		{
+		default:
+		case OverflowPolicy::block:
+			_overflows.blocked();
+			if (Executor::current() == nullptr)
+			{
+				if (!worker.jobs.push(std::move(job)))
+				{
+					return;
+				}
+				break;
+			}
+
+			// A thread of an executor does not wait for the replica, which is
+			// a task of the same executor: it executes the pending tasks
+			// meanwhile.
+			while (!worker.jobs.tryPush(job))
+			{
+				if (worker.jobs.closed())
+				{
+					return;
+				}
+				if (!Executor::runPending())
+				{
+					std::this_thread::yield();
+				}
+			}
+			break;
+		case OverflowPolicy::dropNewest:
+			_overflows.dropped();
+			if (_resequence)
+			{
+				complete(job.ticket);
+			}
+			return;
+		case OverflowPolicy::dropOldest:
+			do
+			{
+				Job discarded;
+
+				if (worker.jobs.tryPop(discarded))
+				{
+					_overflows.dropped();
+					if (_resequence)
+					{
+						complete(discarded.ticket);
+					}
+				}
+			} while (!worker.jobs.tryPush(job));
+			break;
+		}
+	}
+
+	if (!worker.scheduled.load(std::memory_order_relaxed) && !worker.scheduled.exchange(true))
+	{
+		_executor->submit(worker);
+	}
+}
+
+// Get the number of held outputs.
+size_t ReplicaSet::held() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _held;
+}
+
+// Get the replica that processes a message.
+size_t ReplicaSet::shardOf(
+	const MessagePtr& message)
+{
+	switch (_policy.key)
+	{
+	default:
+	case ShardKey::port:
+		return message->metadata().origin % _replicas.size();
+	case ShardKey::bytes:
+	{
+		size_t offset = std::min(_policy.offset, message->size());
+		size_t length = _policy.length == 0 ? message->size() - offset : std::min(_policy.length, message->size() - offset);
+
+		return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(message->payload()) + offset, length)) % _replicas.size();
+	}
+	case ShardKey::roundRobin:
+		return _nextReplica.fetch_add(1, std::memory_order_relaxed) % _replicas.size();
+	}
+}
+
+// Resequence the outputs of a port of the replicas.
+void ReplicaSet::bind(
+	Port& replicaPort,
+	Port& output)
+{
+	// The outputs are filed under the input consumed by the replica of the
+	// port.
+	auto worker = std::find_if(_workers.begin(), _workers.end(), [&replicaPort](const auto& current) {
+		return static_cast<IBlock*>(&current->replica) == replicaPort.block();
+	});
+
+	if (worker == _workers.end())
+	{
+		throw std::invalid_argument(fmt::format("port '{}' is not a port of a replica of '{}'", replicaPort.name(), name()));
+	}
+
+	auto& consumer = _outputs.emplace_back(std::make_unique<Output>(*this, **worker, output));
+	auto& route    = _routes.emplace_back(std::make_unique<Route>(std::list<Port*>{ &replicaPort }, std::list<IConsumer*>{ consumer.get() }, nullptr));
+
+	replicaPort.attach(route.get());
+}
+
+// Hold an output until the previous inputs are processed.
+void ReplicaSet::hold(
+	Port&             port,
+	uint64_t          ticket,
+	const MessagePtr& message)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (ticket >= _nextRelease)
+		{
+			_pending[ticket].outputs.emplace_back(&port, message);
+			++_held;
+
+			return;
+		}
+	}
+
+	// The input has already been released, the output cannot be ordered.
+	port.dispatch(message);
+}
+
+// Mark an input as processed and release the outputs that are in order.
+void ReplicaSet::complete(
+	uint64_t ticket)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	_pending[ticket].done = true;
+	if (_releasing)
+	{
+		return;
+	}
+
+	// The outputs are dispatched without the lock: the thread may execute
+	// other tasks of its executor meanwhile (a full queue), some of them
+	// completing other inputs, whose outputs are then released by this loop.
+	std::vector<std::pair<Port*, MessagePtr>> outputs;
+
+	_releasing = true;
+	for (;;)
+	{
+		for (auto pending = _pending.find(_nextRelease); pending != _pending.end() && pending->second.done; pending = _pending.find(++_nextRelease))
+		{
+			_held -= pending->second.outputs.size();
+			std::move(pending->second.outputs.begin(), pending->second.outputs.end(), std::back_inserter(outputs));
+			_pending.erase(pending);
+		}
+
+		if (outputs.empty())
+		{
+			break;
+		}
+
+		lock.unlock();
+		for (auto& [port, message] : outputs)
+		{
+			port->dispatch(message);
+		}
+		outputs.clear();
+		lock.lock();
+	}
+	_releasing = false;
+}
+
+} // namespace framework
+} // namespace synapse
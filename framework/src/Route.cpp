@@ -20,7 +20,7 @@ Route::Route(
 	const std::list<IConsumer*>& destinations,
 	Dispatcher*                  dispatcher)
 	: _ports(ports),
-	  _destinations(destinations),
+	  _destinations(destinations.begin(), destinations.end()),
 	  _dispatcher(dispatcher)
 {
 }
@@ -30,12 +30,38 @@ Route::~Route()
 {
 }
 
+// Make the route inline.
+void Route::fuse()
+{
+	if (_dispatcher != nullptr)
+	{
+		_dispatcher = nullptr;
+		_fused      = true;
+	}
+}
+
 // Dispatch a message to destinations.
 void Route::dispatch(
-	const std::shared_ptr<Message>& message,
-	const Port&                     source)
+	const MessagePtr& message,
+	const Port&       source)
 {
-	_dispatcher->dispatch(message, source, *this);
+	if (_filtered && !_filter.accepts(*message))
+	{
+		_rejected.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	if (_dispatcher == nullptr)
+	{
+		for (auto& current : _destinations)
+		{
+			current->consume(message);
+		}
+	}
+	else
+	{
+		_dispatcher->dispatch(message, source, *this);
+	}
 }
 
 } // namespace framework
@@ -9,6 +9,7 @@
 
 #include <fmt/format.h>
 
+#include "synapse/framework/Executor.h"
 #include "synapse/framework/Sink.h"
 
 namespace synapse {
@@ -29,8 +30,40 @@ Sink::~Sink()
 /// Ask the block to prepare to be deleted (terminate all pending operations).
 void Sink::shutdown()
 {
-	_shutdown.store(true);
+	// Set the flag under the lock so that the wake up cannot be missed by a
+	// thread about to wait.
+	{
+		std::lock_guard<std::mutex> lock(_mtxMessages);
+		_shutdown.store(true);
+	}
 	_cvMessages.notify_one();
+	_cvRoom.notify_all();
+}
+
+// Get the limits of the queue of messages.
+QueuePolicy Sink::queuePolicy() const
+{
+	std::lock_guard<std::mutex> lock(_mtxMessages);
+
+	return _queuePolicy;
+}
+
+// Set the limits of the queue of messages.
+void Sink::setQueuePolicy(
+	const QueuePolicy& policy)
+{
+	std::lock_guard<std::mutex> lock(_mtxMessages);
+
+	_queuePolicy = policy;
+}
+
+// Set the executor that schedules the sink.
+void Sink::setExecutor(
+	Executor* executor)
+{
+	std::lock_guard<std::mutex> lock(_mtxMessages);
+
+	_executor = executor;
 }
 
 // Control function of the runnable.
@@ -38,7 +71,10 @@ void Sink::run()
 {
 	while (_shutdown.load() == false)
 	{
-		// Wait for an action to be processed.
+		// Poll the queue if the wait strategy allows it.
+		spinUntil(_waitStrategy, [this] { return _pending.load(std::memory_order_relaxed) || _shutdown.load(std::memory_order_relaxed); });
+
+		// Wait for messages to be processed and take all of them.
 		{
 			std::unique_lock<std::mutex> lock(_mtxMessages);
 
@@ -49,40 +85,150 @@ void Sink::run()
 			{
 				break;
 			}
+
+			_batch.swap(_messages);
+			_pending.store(false, std::memory_order_relaxed);
 		}
 
-		// Process pending messages.
-		while (true)
-		{
-			// Get the next message to process.
-			_mtxMessages.lock();
-			if (_messages.empty())
-			{
-				_mtxMessages.unlock();
-				break;
-			}
-			auto message = _messages.front();
-			_messages.pop_front();
-			_mtxMessages.unlock();
+		// Process the messages without holding the lock.
+		processBatch(_batch);
+	}
+}
+
+// Process the pending messages.
+void Sink::execute()
+{
+	// Take all the pending messages.
+	{
+		std::lock_guard<std::mutex> lock(_mtxMessages);
 
-			// Process the message.
-			process(message);
+		if (_shutdown.load())
+		{
+			_scheduled = false;
+			return;
 		}
+
+		_batch.swap(_messages);
+	}
+
+	// Process the messages without holding the lock.
+	processBatch(_batch);
+
+	// Submit the task again if messages arrived meanwhile.
+	bool resubmit = false;
+	{
+		std::lock_guard<std::mutex> lock(_mtxMessages);
+
+		resubmit   = !_shutdown.load() && !_messages.empty();
+		_scheduled = resubmit;
+	}
+	if (resubmit)
+	{
+		_executor->submit(*this);
+	}
+}
+
+// Process a batch of messages taken from the queue.
+void Sink::processBatch(
+	std::deque<MessagePtr>& batch)
+{
+	_batches.record(batch.size());
+
+	// Wake up the producers waiting for room in the queue.
+	if (_queuePolicy.capacity > 0)
+	{
+		_cvRoom.notify_all();
 	}
+
+	for (auto& message : batch)
+	{
+		process(message);
+	}
+	batch.clear();
 }
 
 // Consume a message.
 void Sink::consume(
-	const std::shared_ptr<Message>& message)
+	const MessagePtr& message)
 {
+	bool submit = false;
+
 	// Enqueue the message.
 	{
-		std::lock_guard<std::mutex> lock(_mtxMessages);
+		std::unique_lock<std::mutex> lock(_mtxMessages);
+
+		// The queue is full, apply the overflow policy.
+		if (_queuePolicy.capacity > 0 && _messages.size() >= _queuePolicy.capacity)
+		{
+			switch (_queuePolicy.overflow)
+			{
+			default:
+			case OverflowPolicy::block:
+				_overflows.blocked();
+				waitForRoom(lock);
+				if (_shutdown.load())
+				{
+					return;
+				}
+				break;
+			case OverflowPolicy::dropNewest:
+				_overflows.dropped();
+				return;
+			case OverflowPolicy::dropOldest:
+				_overflows.dropped();
+				_messages.pop_front();
+				break;
+			}
+		}
+
 		_messages.push_back(message);
+		_pending.store(true, std::memory_order_relaxed);
+
+		// Submit the sink to the executor if it is not already pending.
+		submit = _executor != nullptr && !_scheduled;
+		if (submit)
+		{
+			_scheduled = true;
+		}
 	}
 
 	// Notify the runnable.
-	_cvMessages.notify_one();
+	if (submit)
+	{
+		_executor->submit(*this);
+	}
+	else
+	{
+		_cvMessages.notify_one();
+	}
+}
+
+// Wait until there is room in the queue of messages.
+void Sink::waitForRoom(
+	std::unique_lock<std::mutex>& lock)
+{
+	auto room = [this] { return _shutdown.load() || _messages.size() < _queuePolicy.capacity; };
+
+	// A thread of an executor does not wait for the consumer, which may be a
+	// task of the same executor: it executes the pending tasks meanwhile.
+	if (Executor::current() == nullptr)
+	{
+		_cvRoom.wait(lock, room);
+		return;
+	}
+
+	while (!room())
+	{
+		lock.unlock();
+		auto executed = Executor::runPending();
+		lock.lock();
+
+		// The consumer runs on another thread, wait for it a moment.
+		if (!executed)
+		{
+			_cvRoom.wait_for(lock, ROOM_POLL_PERIOD, room);
+		}
+	}
 }
 
 } // namespace framework
@@ -0,0 +1,121 @@
+///
+/// @file ThreadPolicy.cpp
+///
+/// Implementation of the ThreadPolicy class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <stdexcept>
+#include <system_error>
+
+#include <fmt/format.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "synapse/framework/ThreadPolicy.h"
+
+namespace synapse {
+namespace framework {
+
+// Apply the policy to the calling thread.
+void ThreadPolicy::apply() const
+{
+#if defined(__linux__)
+	if (!cpus.empty())
+	{
+		cpu_set_t set;
+
+		CPU_ZERO(&set);
+		for (auto cpu : cpus)
+		{
+			if (cpu >= CPU_SETSIZE)
+			{
+				throw std::invalid_argument(fmt::format("cpu {} does not exist", cpu));
+			}
+			CPU_SET(cpu, &set);
+		}
+
+		if (auto error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+		{
+			throw std::system_error(error, std::generic_category(), "failed to set the cpu affinity");
+		}
+	}
+
+	if (priority > 0)
+	{
+		sched_param parameters{};
+
+		parameters.sched_priority = priority;
+		if (auto error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters))
+		{
+			throw std::system_error(error, std::generic_category(), "failed to set the SCHED_FIFO priority");
+		}
+	}
+#else
+	if (!empty())
+	{
+		throw std::system_error(std::make_error_code(std::errc::not_supported), "thread policies are only supported on Linux");
+	}
+#endif
+}
+
+// Describe the cores and the scheduling policy of the calling thread.
+std::string ThreadPolicy::describeCurrentThread()
+{
+#if defined(__linux__)
+	std::string result = "cpus ";
+	cpu_set_t   set;
+
+	// List the cores as ranges.
+	if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+	{
+		std::string separator;
+
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (!CPU_ISSET(cpu, &set))
+			{
+				continue;
+			}
+
+			int last = cpu;
+
+			while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &set))
+			{
+				++last;
+			}
+			result += separator + (last == cpu ? fmt::format("{}", cpu) : fmt::format("{}-{}", cpu, last));
+			separator = ",";
+			cpu       = last;
+		}
+	}
+	else
+	{
+		result += "?";
+	}
+
+	int         policy;
+	sched_param parameters{};
+
+	if (pthread_getschedparam(pthread_self(), &policy, &parameters) == 0 && policy == SCHED_FIFO)
+	{
+		result += fmt::format(", SCHED_FIFO {}", parameters.sched_priority);
+	}
+	else
+	{
+		result += ", SCHED_OTHER";
+	}
+
+	return result;
+#else
+	return "default";
+#endif
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,173 @@
+///
+/// @file AsioAwaitables.h
+///
+/// Declaration of the awaitables of the asynchronous operations of boost::asio.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+#include <synapse/framework/Coroutine.h>
+#include <synapse/framework/Message.h>
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+///
+/// Asynchronous operation of boost::asio awaited by a coroutine.
+///
+/// The operation is started when the object is created; the completion
+/// handler (called by the thread that runs the io_context) sets the result
+/// and the coroutine is resumed by its executor:
+///
+///     auto [error, size, timestamp] = co_await asyncReadSome(socket, buffer);
+///
+/// @tparam T The type of the result.
+///
+template <typename T>
+class AsioOperation
+{
+	// Construction, destruction
+
+public:
+
+	/// Constructor.
+	AsioOperation()
+		: _completion(std::make_shared<synapse::framework::Completion<T>>())
+	{
+	}
+
+	// Accessors
+
+public:
+
+	/// Get the completion set by the handler of the operation.
+	///
+	/// @return The completion (shared with the handler).
+	const std::shared_ptr<synapse::framework::Completion<T>>& completion() const { return _completion; }
+
+	// Operations
+
+public:
+
+	/// Await the result (co_await by the coroutine).
+	///
+	/// @return The awaiter that gives the result.
+	auto operator co_await() { return _completion->operator co_await(); }
+
+	// Private attributes
+
+private:
+
+	/// The completion of the operation.
+	std::shared_ptr<synapse::framework::Completion<T>> _completion;
+};
+
+/// Resolve a host name.
+///
+/// @param resolver The resolver.
+/// @param host The host name (or address).
+/// @param service The service name (or port number).
+///
+/// @return The awaitable that gives the error and the end points.
+inline AsioOperation<std::pair<boost::system::error_code, boost::asio::ip::tcp::resolver::results_type>> asyncResolve(
+	boost::asio::ip::tcp::resolver& resolver,
+	const std::string&              host,
+	const std::string&              service)
+{
+	AsioOperation<std::pair<boost::system::error_code, boost::asio::ip::tcp::resolver::results_type>> operation;
+
+	resolver.async_resolve(
+		host,
+		service,
+		[completion = operation.completion()](const boost::system::error_code& error, boost::asio::ip::tcp::resolver::results_type results) {
+			completion->set({ error, std::move(results) });
+		});
+
+	return operation;
+}
+
+/// Connect a socket.
+///
+/// @param socket The socket.
+/// @param endPoint The end point to connect to.
+///
+/// @return The awaitable that gives the error.
+inline AsioOperation<boost::system::error_code> asyncConnect(
+	boost::asio::ip::tcp::socket&         socket,
+	const boost::asio::ip::tcp::endpoint& endPoint)
+{
+	AsioOperation<boost::system::error_code> operation;
+
+	socket.async_connect(
+		endPoint,
+		[completion = operation.completion()](const boost::system::error_code& error) {
+			completion->set(error);
+		});
+
+	return operation;
+}
+
+/// Read some bytes from a stream.
+///
+/// The time of the reception is taken by the completion handler, it does not
+/// include the delay before the coroutine is resumed by its executor.
+///
+/// @tparam Stream The type of the stream (a socket, a serial port).
+///
+/// @param stream The stream.
+/// @param buffer The buffer to read into.
+///
+/// @return The awaitable that gives the error, the number of bytes read and
+/// the time of the reception (see Message::Metadata::now()).
+template <typename Stream>
+AsioOperation<std::tuple<boost::system::error_code, size_t, uint64_t>> asyncReadSome(
+	Stream&                            stream,
+	const boost::asio::mutable_buffer& buffer)
+{
+	AsioOperation<std::tuple<boost::system::error_code, size_t, uint64_t>> operation;
+
+	stream.async_read_some(
+		buffer,
+		[completion = operation.completion()](const boost::system::error_code& error, size_t size) {
+			completion->set({ error, size, synapse::framework::Message::Metadata::now() });
+		});
+
+	return operation;
+}
+
+/// Wait for a delay.
+///
+/// @param timer The timer.
+/// @param delay The delay.
+///
+/// @return The awaitable that gives the error (operation_aborted if the timer is cancelled).
+inline AsioOperation<boost::system::error_code> asyncWait(
+	boost::asio::steady_timer&                 timer,
+	const std::chrono::steady_clock::duration& delay)
+{
+	AsioOperation<boost::system::error_code> operation;
+
+	timer.expires_after(delay);
+	timer.async_wait(
+		[completion = operation.completion()](const boost::system::error_code& error) {
+			completion->set(error);
+		});
+
+	return operation;
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,124 @@
+///
+/// @file BridgeProtocol.h
+///
+/// Declaration of the protocol between a BridgeSink and a BridgeSource.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+namespace synapse {
+namespace modules {
+namespace io {
+namespace bridge {
+
+///
+/// Every frame starts with a header giving the length of its body, the
+/// integers are little endian:
+///
+/// - hello  (sink to source, on connection): session of the sink (u64).
+/// - resume (source to sink): last sequence number received in the session
+///   (u64), the sink sends again the messages that follow it.
+/// - batch  (sink to source): sequence number of the first message (u64),
+///   number of messages (u32), reserved (u32), then the messages, each one
+///   with a record header (size (u32), reserved (u32), timestamp (u64)) and
+///   its payload. The origin and the sequence number of a message are not
+///   sent, they are given by the output port of the source.
+/// - ack    (source to sink): last sequence number received (u64), the sink
+///   releases the messages up to it.
+///
+enum class FrameType : uint32_t
+{
+	hello  = 1,
+	resume = 2,
+	batch  = 3,
+	ack    = 4,
+};
+
+/// Size of the header of a frame (length of the body, type).
+static constexpr size_t   FRAME_HEADER_SIZE = 8;
+
+/// Size of the body of the hello, resume and ack frames.
+static constexpr size_t   CONTROL_BODY_SIZE = 8;
+
+/// Size of the header of a batch (first sequence number, count, reserved).
+static constexpr size_t   BATCH_HEADER_SIZE = 16;
+
+/// Size of the header of a message (size, reserved, timestamp).
+static constexpr size_t   RECORD_HEADER_SIZE = 16;
+
+/// Maximum size of the body of a frame.
+static constexpr uint32_t MAX_FRAME_SIZE = 64 << 20;
+
+/// Write an integer in little endian.
+///
+/// @param buffer The buffer.
+/// @param value The value.
+template <typename T>
+inline void put(
+	uint8_t* buffer,
+	T        value)
+{
+	value = boost::endian::native_to_little(value);
+	std::memcpy(buffer, &value, sizeof(value));
+}
+
+/// Read an integer in little endian.
+///
+/// @param buffer The buffer.
+///
+/// @return The value.
+template <typename T>
+inline T get(
+	const uint8_t* buffer)
+{
+	T value;
+
+	std::memcpy(&value, buffer, sizeof(value));
+
+	return boost::endian::little_to_native(value);
+}
+
+/// Encode the header of a frame.
+///
+/// @param buffer The buffer (FRAME_HEADER_SIZE bytes).
+/// @param type The type of the frame.
+/// @param length The length of the body.
+inline void putFrameHeader(
+	uint8_t*  buffer,
+	FrameType type,
+	size_t    length)
+{
+	put(buffer, static_cast<uint32_t>(length));
+	put(buffer + 4, static_cast<uint32_t>(type));
+}
+
+/// Encode a control frame (hello, resume or ack).
+///
+/// @param type The type of the frame.
+/// @param value The session or the sequence number.
+///
+/// @return The frame.
+inline std::array<uint8_t, FRAME_HEADER_SIZE + CONTROL_BODY_SIZE> controlFrame(
+	FrameType type,
+	uint64_t  value)
+{
+	std::array<uint8_t, FRAME_HEADER_SIZE + CONTROL_BODY_SIZE> result;
+
+	putFrameHeader(result.data(), type, CONTROL_BODY_SIZE);
+	put(result.data() + FRAME_HEADER_SIZE, value);
+
+	return result;
+}
+
+} // namespace bridge
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,549 @@
+///
+/// @file BridgeSink.cpp
+///
+/// Implementation of the BridgeSink class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#include <synapse/framework/Executor.h>
+
+#include "BridgeSink.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+IMPLEMENT_BLOCK(BridgeSink)
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void        from_json(
+		   const nlohmann::json& json,
+		   BridgeSink::Config&   object)
+{
+	// Mandatory attributes.
+	json.at("host").get_to(object.host);
+	json.at("port").get_to(object.port);
+
+	// Optional attributes.
+	object.retryDelay = json.value<uint16_t>("retryDelay", 2);
+	object.batchBytes = json.value<size_t>("batchBytes", 64 * 1024);
+	object.linger     = json.value<uint32_t>("linger", 1000);
+	object.window     = json.value<size_t>("window", 64 * 1024);
+
+	auto overflow = json.value<std::string>("overflow", "block");
+
+	if (overflow == "block")
+	{
+		object.overflow = synapse::framework::OverflowPolicy::block;
+	}
+	else if (overflow == "drop-newest")
+	{
+		object.overflow = synapse::framework::OverflowPolicy::dropNewest;
+	}
+	else if (overflow == "drop-oldest")
+	{
+		object.overflow = synapse::framework::OverflowPolicy::dropOldest;
+	}
+	else
+	{
+		throw std::invalid_argument(fmt::format("unknown overflow policy: {}", overflow));
+	}
+
+	if (object.window == 0)
+	{
+		throw std::invalid_argument("the window shall not be empty");
+	}
+}
+
+// Constructor.
+BridgeSink::BridgeSink(
+	const std::string& name)
+	: BaseBlock(name)
+{
+}
+
+// Destructor.
+BridgeSink::~BridgeSink()
+{
+	shutdown();
+}
+
+// Initialize the block before the execution.
+void BridgeSink::initialize(
+	const ConfigData&             configData,
+	synapse::framework::IManager* manager)
+{
+	// Call the base class implementation.
+	synapse::framework::BaseBlock::initialize(configData, manager);
+
+	// Read configuration data.
+	_config = readConfig<BridgeSink::Config>(configData);
+
+	// A new session tells the source to forget the sequence numbers of the
+	// previous run of the engine.
+	std::random_device device;
+
+	_session = (static_cast<uint64_t>(device()) << 32) | device();
+}
+
+// Ask the component to prepare to be deleted (terminate all pending operations).
+void BridgeSink::shutdown()
+{
+	{
+		std::lock_guard lock(_mutex);
+
+		if (_stopping)
+		{
+			return;
+		}
+		_stopping = true;
+
+		if (_outstanding > 0)
+		{
+			spdlog::warn("Block '{}': {} messages not acknowledged by the source", name(), _outstanding);
+		}
+	}
+	if (_dropped > 0)
+	{
+		spdlog::warn("Block '{}': {} messages dropped, too large for a frame", name(), _dropped.load());
+	}
+
+	auto overflows = _overflows.statistics();
+
+	if (overflows.blocked > 0 || overflows.dropped > 0)
+	{
+		spdlog::warn("Block '{}': window full, {} consumers blocked, {} messages dropped", name(), overflows.blocked, overflows.dropped);
+	}
+	_room.notify_all();
+	_ioc.stop();
+}
+
+// Consume a message.
+void BridgeSink::consume(
+	const synapse::framework::MessagePtr& message)
+{
+	auto recordSize = bridge::RECORD_HEADER_SIZE + message->size();
+
+	if (bridge::BATCH_HEADER_SIZE + recordSize > bridge::MAX_FRAME_SIZE)
+	{
+		++_dropped;
+		return;
+	}
+
+	std::unique_lock lock(_mutex);
+
+	// The window is full, apply the overflow policy.
+	if (_outstanding >= _config.window)
+	{
+		switch (_config.overflow)
+		{
+		default:
+		case synapse::framework::OverflowPolicy::block:
+			_overflows.blocked();
+			waitForRoom(lock);
+			break;
+		case synapse::framework::OverflowPolicy::dropOldest:
+			// Only the messages not sent yet can be discarded.
+			if (!_queue.empty())
+			{
+				_overflows.dropped();
+				_queuedBytes -= bridge::RECORD_HEADER_SIZE + _queue.front()->size();
+				_queue.erase(_queue.begin());
+				--_outstanding;
+				break;
+			}
+			[[fallthrough]];
+		case synapse::framework::OverflowPolicy::dropNewest:
+			_overflows.dropped();
+			return;
+		}
+	}
+	if (_stopping)
+	{
+		return;
+	}
+
+	_queue.push_back(message);
+	_queuedBytes += recordSize;
+	++_outstanding;
+
+	// Send the batch at once when it is large enough, start the linger
+	// delay with its first message otherwise.
+	if (_queuedBytes >= _config.batchBytes || _config.linger == 0)
+	{
+		if (!_flushPosted)
+		{
+			_flushPosted = true;
+			boost::asio::post(_ioc, [this] { doFlush(); });
+		}
+	}
+	else if (!_lingering)
+	{
+		_lingering = true;
+		boost::asio::post(_ioc, [this] {
+			_lingerTimer.expires_after(std::chrono::microseconds(_config.linger));
+			_lingerTimer.async_wait([this](boost::system::error_code error) {
+				if (!error)
+				{
+					doFlush();
+				}
+			});
+		});
+	}
+}
+
+// Wait until there is room in the window.
+void BridgeSink::waitForRoom(
+	std::unique_lock<std::mutex>& lock)
+{
+	auto room = [this] { return _outstanding < _config.window || _stopping; };
+
+	// A thread of an executor does not sleep until the source acknowledges
+	// the messages: it executes the pending tasks meanwhile.
+	if (synapse::framework::Executor::current() == nullptr)
+	{
+		_room.wait(lock, room);
+		return;
+	}
+
+	while (!room())
+	{
+		lock.unlock();
+		auto executed = synapse::framework::Executor::runPending();
+		lock.lock();
+
+		if (!executed)
+		{
+			_room.wait_for(lock, ROOM_POLL_PERIOD, room);
+		}
+	}
+}
+
+// Control function of the runnable.
+void BridgeSink::run()
+{
+	// Try to resolve the address of the end point.
+	{
+		boost::asio::io_context        ioc;
+		boost::asio::ip::tcp::resolver resolver(ioc);
+		auto                           results = resolver.resolve(_config.host, std::to_string(_config.port));
+
+		if (results.empty())
+		{
+			throw std::runtime_error(fmt::format("unable to resolve address: {}", _config.host));
+		}
+		_endPoint = results.begin()->endpoint();
+	}
+
+	// Prepare the connection to the source.
+	doConnect();
+
+	// Start async operations.
+	_ioc.run();
+}
+
+// Start an async connection.
+void BridgeSink::doConnect()
+{
+	_socket.async_connect(
+		_endPoint,
+		[this](boost::system::error_code const& error) {
+			if (error)
+			{
+				spdlog::error("Block '{}': connection failed: {}", name(), error.message());
+				_socket.close();
+				doWait();
+			}
+			else
+			{
+				doHandshake();
+			}
+		});
+}
+
+// Start to wait for a while before attempting to connect again to the source.
+void BridgeSink::doWait()
+{
+	_retryTimer.expires_after(std::chrono::seconds(_config.retryDelay));
+	_retryTimer.async_wait(
+		[this](boost::system::error_code error) {
+			if (!error)
+			{
+				doConnect();
+			}
+		});
+}
+
+// Close the connection and prepare to connect again.
+void BridgeSink::doDisconnect()
+{
+	boost::system::error_code ignored;
+
+	// The handlers of the operations in progress see another connection
+	// number and do nothing.
+	++_connection;
+	_connected = false;
+	_writing   = false;
+	_inWrite.clear();
+	_socket.close(ignored);
+
+	spdlog::error("Block '{}': connection lost, {} messages not acknowledged", name(), _pending.size());
+	doWait();
+}
+
+// Send the session and read the last sequence number received by the source.
+void BridgeSink::doHandshake()
+{
+	auto                      connection = _connection;
+	boost::system::error_code ignored;
+
+	_socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+
+	_hello = bridge::controlFrame(bridge::FrameType::hello, _session);
+	boost::asio::async_write(
+		_socket,
+		boost::asio::buffer(_hello),
+		[this, connection](boost::system::error_code const& error, std::size_t) {
+			if (connection != _connection)
+			{
+				return;
+			}
+			if (error)
+			{
+				doDisconnect();
+				return;
+			}
+
+			boost::asio::async_read(
+				_socket,
+				boost::asio::buffer(_control),
+				[this, connection](boost::system::error_code const& error, std::size_t) {
+					if (connection != _connection)
+					{
+						return;
+					}
+					if (error || bridge::get<uint32_t>(_control.data()) != bridge::CONTROL_BODY_SIZE ||
+						bridge::get<uint32_t>(_control.data() + 4) != static_cast<uint32_t>(bridge::FrameType::resume))
+					{
+						doDisconnect();
+						return;
+					}
+
+					// Send again the messages the source did not receive.
+					acknowledge(bridge::get<uint64_t>(_control.data() + bridge::FRAME_HEADER_SIZE));
+					_resent += _nextToSend - _firstPending;
+					_nextToSend = _firstPending;
+					_connected  = true;
+
+					spdlog::info("Block '{}': connected, {} messages pending", name(), _pending.size());
+					doReadAck(connection);
+					doSend();
+				});
+		});
+}
+
+// Read the acknowledgements of the source.
+void BridgeSink::doReadAck(
+	unsigned connection)
+{
+	boost::asio::async_read(
+		_socket,
+		boost::asio::buffer(_control),
+		[this, connection](boost::system::error_code const& error, std::size_t) {
+			if (connection != _connection)
+			{
+				return;
+			}
+			if (error || bridge::get<uint32_t>(_control.data()) != bridge::CONTROL_BODY_SIZE ||
+				bridge::get<uint32_t>(_control.data() + 4) != static_cast<uint32_t>(bridge::FrameType::ack))
+			{
+				doDisconnect();
+				return;
+			}
+
+			acknowledge(bridge::get<uint64_t>(_control.data() + bridge::FRAME_HEADER_SIZE));
+			doReadAck(connection);
+		});
+}
+
+// Move the queued messages to the pending ones and send them.
+void BridgeSink::doFlush()
+{
+	{
+		std::lock_guard lock(_mutex);
+
+		for (auto& message : _queue)
+		{
+			_pending.push_back(std::move(message));
+		}
+		_queue.clear();
+		_queuedBytes = 0;
+		_flushPosted = false;
+		_lingering   = false;
+	}
+	_lingerTimer.cancel();
+
+	doSend();
+}
+
+// Send the pending messages that are not sent yet.
+void BridgeSink::doSend()
+{
+	if (!_connected || _writing)
+	{
+		return;
+	}
+
+	size_t first = static_cast<size_t>(_nextToSend - _firstPending);
+
+	if (first >= _pending.size())
+	{
+		return;
+	}
+
+	size_t count = std::min(_pending.size() - first, MAX_WRITE_MESSAGES);
+
+	// Reserve the room of the headers and small payloads, the buffers point
+	// into it so it shall not be reallocated.
+	size_t room = count * (bridge::FRAME_HEADER_SIZE + bridge::BATCH_HEADER_SIZE + bridge::RECORD_HEADER_SIZE);
+
+	for (size_t index = first; index < first + count; ++index)
+	{
+		if (_pending[index]->size() <= COPY_THRESHOLD)
+		{
+			room += _pending[index]->size();
+		}
+	}
+	_headers.resize(room);
+	_buffers.clear();
+	_inWrite.clear();
+
+	// Split the messages into frames of at most batchBytes, the contiguous
+	// parts of the buffer are gathered with the large payloads.
+	uint8_t* base     = _headers.data();
+	size_t   offset   = 0;
+	size_t   run      = 0;
+	uint8_t* frame    = nullptr;
+	size_t   length   = 0;
+	uint32_t messages = 0;
+	uint64_t frames   = 0;
+
+	auto closeFrame = [&] {
+		if (frame != nullptr)
+		{
+			bridge::put<uint32_t>(frame + bridge::FRAME_HEADER_SIZE + 8, messages);
+			bridge::putFrameHeader(frame, bridge::FrameType::batch, length);
+		}
+	};
+
+	for (size_t index = first; index < first + count; ++index)
+	{
+		auto&  message    = _pending[index];
+		size_t recordSize = bridge::RECORD_HEADER_SIZE + message->size();
+
+		if (frame == nullptr || length + recordSize > _config.batchBytes)
+		{
+			closeFrame();
+			frame    = base + offset;
+			length   = bridge::BATCH_HEADER_SIZE;
+			messages = 0;
+			++frames;
+			bridge::put<uint64_t>(frame + bridge::FRAME_HEADER_SIZE, _firstPending + index);
+			bridge::put<uint32_t>(frame + bridge::FRAME_HEADER_SIZE + 12, 0);
+			offset += bridge::FRAME_HEADER_SIZE + bridge::BATCH_HEADER_SIZE;
+		}
+
+		auto record = base + offset;
+
+		bridge::put<uint32_t>(record, static_cast<uint32_t>(message->size()));
+		bridge::put<uint32_t>(record + 4, 0);
+		bridge::put<uint64_t>(record + 8, message->metadata().timestamp);
+		offset += bridge::RECORD_HEADER_SIZE;
+
+		if (message->size() <= COPY_THRESHOLD)
+		{
+			std::copy_n(message->payload(), message->size(), base + offset);
+			offset += message->size();
+		}
+		else
+		{
+			_buffers.emplace_back(base + run, offset - run);
+			_buffers.emplace_back(message->payload(), message->size());
+			_inWrite.push_back(message);
+			run = offset;
+		}
+
+		length += recordSize;
+		++messages;
+	}
+	closeFrame();
+	if (offset > run)
+	{
+		_buffers.emplace_back(base + run, offset - run);
+	}
+
+	// Write the frames with a single gathered write.
+	auto connection = _connection;
+	auto last       = _firstPending + first + count;
+
+	_writing = true;
+	boost::asio::async_write(
+		_socket,
+		_buffers,
+		[this, connection, last, frames](boost::system::error_code const& error, std::size_t) {
+			if (connection != _connection)
+			{
+				return;
+			}
+			_writing = false;
+			_inWrite.clear();
+			if (error)
+			{
+				doDisconnect();
+				return;
+			}
+
+			_batches += frames;
+			_nextToSend = std::max(_nextToSend, last);
+			doSend();
+		});
+}
+
+// Release the messages acknowledged by the source.
+void BridgeSink::acknowledge(
+	uint64_t sequence)
+{
+	if (sequence < _firstPending)
+	{
+		return;
+	}
+
+	size_t count = static_cast<size_t>(std::min<uint64_t>(sequence - _firstPending + 1, _pending.size()));
+
+	_pending.erase(_pending.begin(), _pending.begin() + count);
+	_firstPending += count;
+	_nextToSend = std::max(_nextToSend, _firstPending);
+
+	{
+		std::lock_guard lock(_mutex);
+
+		_outstanding -= count;
+	}
+	_room.notify_all();
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,316 @@
+///
+/// @file BridgeSink.h
+///
+/// Declaration of the BridgeSink class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <synapse/framework/BaseBlock.h>
+#include <synapse/framework/IConsumer.h>
+#include <synapse/framework/IRunnable.h>
+#include <synapse/framework/MessagePtr.h>
+#include <synapse/framework/QueuePolicy.h>
+
+#include "BridgeProtocol.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+///
+/// Implement a block that passes the messages to another engine through a
+/// TCP connection (received by a BridgeSource).
+///
+/// The messages are sent with their metadata, in batches: the messages
+/// consumed within the linger delay, or until the batch size is reached, are
+/// written with a single gathered write (the headers are copied in a buffer,
+/// the large payloads are referenced in place).
+///
+/// Each message is given a sequence number and kept until the source
+/// acknowledges it. After a reconnection the source tells the last sequence
+/// number it received and the following messages are sent again: a message
+/// is delivered at least once while the engine runs.
+///
+/// When the window of pending messages is full, the overflow policy tells if
+/// the consumer waits for the acknowledgements of the source or if a message
+/// is discarded (the messages already sent are never discarded). A consumer
+/// running on a thread of an executor does not sleep: it executes the other
+/// pending tasks of the executor meanwhile.
+///
+class BridgeSink :
+	public synapse::framework::BaseBlock,
+	public synapse::framework::IConsumer,
+	public synapse::framework::IRunnable
+{
+	DECLARE_BLOCK(BridgeSink)
+
+	// Définitions
+
+public:
+
+	/// Configuration of the block.
+	struct Config
+	{
+		/// Host of the source (logic address as www.google.com or static address as 192.168.64.32).
+		std::string host;
+
+		/// TCP port of the source.
+		uint16_t    port;
+
+		/// Delay before reconnecting to the source after a communication loss (seconds).
+		uint16_t    retryDelay;
+
+		/// Size of a batch that is sent without waiting for the linger delay (bytes).
+		size_t      batchBytes;
+
+		/// Maximum delay of a message before its batch is sent (microseconds, 0 to send at once).
+		uint32_t    linger;
+
+		/// Maximum number of messages queued or not yet acknowledged.
+		size_t      window;
+
+		/// What to do when the window is full.
+		synapse::framework::OverflowPolicy overflow;
+	};
+
+	// Construction, destruction
+
+private:
+
+	/// Constructor.
+	///
+	/// @param name Name of the block.
+	BridgeSink(
+		const std::string& name);
+
+	/// Destructor.
+	virtual ~BridgeSink();
+
+	// Implementation of IBlock
+
+public:
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData&             configData,
+		synapse::framework::IManager* manager) override;
+
+	/// Ask the block to prepare to be deleted (terminate all pending operations).
+	void shutdown() override final;
+
+	// Implementation of IConsumer
+
+public:
+
+	/// Check if the consumer accepts concurrent calls to consume().
+	///
+	/// @return true, the queue is protected by a mutex.
+	bool isThreadSafe() const override final { return true; }
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const synapse::framework::MessagePtr& message) override final;
+
+	// Implementation of IRunnable
+
+public:
+
+	/// Control function of the runnable.
+	///
+	/// This method is called by the manager in a thread dedicated to the
+	/// execution of the runnable.
+	void run() override final;
+
+	// Accessors
+
+public:
+
+	/// Get the number of batches sent.
+	///
+	/// @return The number of batches.
+	uint64_t batches() const { return _batches.load(std::memory_order_relaxed); }
+
+	/// Get the number of messages sent again after a reconnection.
+	///
+	/// @return The number of messages.
+	uint64_t resent() const { return _resent.load(std::memory_order_relaxed); }
+
+	/// Get the counters of the overflows of the window.
+	///
+	/// @return A snapshot of the counters.
+	synapse::framework::OverflowCounters::Statistics overflows() const { return _overflows.statistics(); }
+
+	// Implementation
+
+private:
+
+	/// Start an async connection.
+	void doConnect();
+
+	/// Start to wait for a while before attempting to connect again to the source.
+	void doWait();
+
+	/// Close the connection and prepare to connect again.
+	void doDisconnect();
+
+	/// Send the session and read the last sequence number received by the source.
+	void doHandshake();
+
+	/// Read the acknowledgements of the source.
+	///
+	/// @param connection The connection the read belongs to.
+	void doReadAck(
+		unsigned connection);
+
+	/// Move the queued messages to the pending ones and send them.
+	void doFlush();
+
+	/// Send the pending messages that are not sent yet.
+	void doSend();
+
+	/// Wait until there is room in the window or the sink is shut down
+	/// (overflow policy block).
+	///
+	/// @param lock The lock of the queue (held on entry and on return).
+	void waitForRoom(
+		std::unique_lock<std::mutex>& lock);
+
+	/// Release the messages acknowledged by the source.
+	///
+	/// @param sequence The last sequence number received by the source.
+	void acknowledge(
+		uint64_t sequence);
+
+	// Private definitions
+
+private:
+
+	/// Maximum number of messages gathered in a single write.
+	static constexpr size_t MAX_WRITE_MESSAGES{ 256 };
+
+	/// Maximum size of a payload copied with the headers (larger ones are
+	/// referenced in place).
+	static constexpr size_t COPY_THRESHOLD{ 256 };
+
+	/// Period of the checks of the window by a consumer that executes the
+	/// pending tasks of its executor.
+	static constexpr std::chrono::microseconds ROOM_POLL_PERIOD{ 100 };
+
+	// Private attributes
+
+private:
+
+	/// Configuration data.
+	Config                                                         _config;
+
+	/// Session of the sink (the source resets its sequence numbers when it changes).
+	uint64_t                                                       _session{ 0 };
+
+	/// The boost::asio context.
+	boost::asio::io_context                                        _ioc;
+
+	/// The end point of the source.
+	boost::asio::ip::tcp::endpoint                                 _endPoint;
+
+	/// The connection to the source.
+	boost::asio::ip::tcp::socket                                   _socket{ _ioc };
+
+	/// The timer to wait for before retrying to connect.
+	boost::asio::steady_timer                                      _retryTimer{ _ioc };
+
+	/// The timer to wait for before sending a batch.
+	boost::asio::steady_timer                                      _lingerTimer{ _ioc };
+
+	/// Protect the queue.
+	std::mutex                                                     _mutex;
+
+	/// Signaled when the window has room again.
+	std::condition_variable                                        _room;
+
+	/// The messages consumed and not yet moved to the pending ones.
+	std::deque<synapse::framework::MessagePtr>                     _queue;
+
+	/// Size of the queued messages on the wire.
+	size_t                                                         _queuedBytes{ 0 };
+
+	/// Number of messages queued or pending.
+	size_t                                                         _outstanding{ 0 };
+
+	/// Indicates that a flush has been posted.
+	bool                                                           _flushPosted{ false };
+
+	/// Indicates that the linger timer is started.
+	bool                                                           _lingering{ false };
+
+	/// Indicates that a shutdown has been requested.
+	bool                                                           _stopping{ false };
+
+	/// The messages not yet acknowledged (handled by the thread of the block).
+	std::deque<synapse::framework::MessagePtr>                     _pending;
+
+	/// Sequence number of the first pending message.
+	uint64_t                                                       _firstPending{ 1 };
+
+	/// Sequence number of the next message to send.
+	uint64_t                                                       _nextToSend{ 1 };
+
+	/// Counter of the connections (the handlers of a closed connection are ignored).
+	unsigned                                                       _connection{ 0 };
+
+	/// Indicates that the handshake is done.
+	bool                                                           _connected{ false };
+
+	/// Indicates that a write is in progress.
+	bool                                                           _writing{ false };
+
+	/// The headers (and small payloads) of the write in progress.
+	std::vector<uint8_t>                                           _headers;
+
+	/// The buffers of the write in progress.
+	std::vector<boost::asio::const_buffer>                         _buffers;
+
+	/// The messages referenced by the write in progress.
+	std::vector<synapse::framework::MessagePtr>                    _inWrite;
+
+	/// The hello frame.
+	std::array<uint8_t, bridge::FRAME_HEADER_SIZE + bridge::CONTROL_BODY_SIZE> _hello;
+
+	/// The buffer of the control frames read.
+	std::array<uint8_t, bridge::FRAME_HEADER_SIZE + bridge::CONTROL_BODY_SIZE> _control;
+
+	/// Number of batches sent.
+	std::atomic<uint64_t>                                          _batches{ 0 };
+
+	/// Number of messages sent again after a reconnection.
+	std::atomic<uint64_t>                                          _resent{ 0 };
+
+	/// The counters of the overflows of the window.
+	synapse::framework::OverflowCounters                           _overflows;
+
+	/// Number of messages too large to be sent.
+	std::atomic<uint64_t>                                          _dropped{ 0 };
+};
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
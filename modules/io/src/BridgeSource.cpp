@@ -0,0 +1,341 @@
+///
+/// @file BridgeSource.cpp
+///
+/// Implementation of the BridgeSource class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#include <synapse/framework/Message.h>
+
+#include "BridgeSource.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+IMPLEMENT_BLOCK(BridgeSource)
+
+const char* BridgeSource::OUTPUT_PORT_NAME = "default";
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void        from_json(
+		   const nlohmann::json& json,
+		   BridgeSource::Config& object)
+{
+	// Mandatory attributes.
+	json.at("port").get_to(object.port);
+
+	// Optional attributes.
+	object.host = json.value<std::string>("host", "0.0.0.0");
+}
+
+// Constructor.
+BridgeSource::BridgeSource(
+	const std::string& name)
+	: Source(name)
+{
+}
+
+// Destructor.
+BridgeSource::~BridgeSource()
+{
+}
+
+// Initialize the block before the execution.
+void BridgeSource::initialize(
+	const ConfigData&             configData,
+	synapse::framework::IManager* manager)
+{
+	// Call the base class implementation.
+	synapse::framework::Source::initialize(configData, manager);
+
+	// Read configuration data.
+	_config = readConfig<BridgeSource::Config>(configData);
+
+	// Find the output port.
+	_outputPort = manager->find(this, OUTPUT_PORT_NAME);
+}
+
+// Ask the component to prepare to be deleted (terminate all pending operations).
+void BridgeSource::shutdown()
+{
+	_ioc.stop();
+}
+
+// Control function of the runnable.
+void BridgeSource::run()
+{
+	// Try to resolve the address to listen on.
+	boost::asio::ip::tcp::endpoint endPoint;
+	{
+		boost::asio::io_context        ioc;
+		boost::asio::ip::tcp::resolver resolver(ioc);
+		auto                           results = resolver.resolve(_config.host, std::to_string(_config.port));
+
+		if (results.empty())
+		{
+			throw std::runtime_error(fmt::format("unable to resolve address: {}", _config.host));
+		}
+		endPoint = results.begin()->endpoint();
+	}
+
+	_acceptor.open(endPoint.protocol());
+	_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+	_acceptor.bind(endPoint);
+	_acceptor.listen();
+
+	spdlog::info("Block '{}': listening on port {}", name(), _config.port);
+
+	// Start async operations.
+	doAccept();
+	_ioc.run();
+}
+
+// Start to accept a connection.
+void BridgeSource::doAccept()
+{
+	_acceptor.async_accept(
+		[this](boost::system::error_code const& error, boost::asio::ip::tcp::socket socket) {
+			if (error)
+			{
+				spdlog::error("Block '{}': accept failed: {}", name(), error.message());
+				return;
+			}
+
+			// A new connection of the sink replaces the previous one (which may
+			// not be seen as lost yet).
+			boost::system::error_code ignored;
+
+			if (_socket.is_open())
+			{
+				doClose("replaced by a new connection");
+			}
+			_socket = std::move(socket);
+			_socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+			_acknowledging = false;
+
+			doHandshake(_connection);
+			doAccept();
+		});
+}
+
+// Read the session of the sink and reply with the last sequence number received.
+void BridgeSource::doHandshake(
+	unsigned connection)
+{
+	boost::asio::async_read(
+		_socket,
+		boost::asio::buffer(_control),
+		[this, connection](boost::system::error_code const& error, std::size_t) {
+			if (connection != _connection)
+			{
+				return;
+			}
+			if (error || bridge::get<uint32_t>(_control.data()) != bridge::CONTROL_BODY_SIZE ||
+				bridge::get<uint32_t>(_control.data() + 4) != static_cast<uint32_t>(bridge::FrameType::hello))
+			{
+				doClose("invalid hello");
+				return;
+			}
+
+			// The sequence numbers restart with a new session of the sink.
+			auto session = bridge::get<uint64_t>(_control.data() + bridge::FRAME_HEADER_SIZE);
+
+			if (session != _session)
+			{
+				_session          = session;
+				_lastSequence     = 0;
+				_lastAcknowledged = 0;
+				_sessionStarting  = true;
+			}
+			spdlog::info("Block '{}': connected, resuming after message {}", name(), _lastSequence);
+
+			_resume = bridge::controlFrame(bridge::FrameType::resume, _lastSequence);
+			boost::asio::async_write(
+				_socket,
+				boost::asio::buffer(_resume),
+				[this, connection](boost::system::error_code const& error, std::size_t) {
+					if (connection != _connection)
+					{
+						return;
+					}
+					if (error)
+					{
+						doClose(error.message());
+						return;
+					}
+					doReadFrame(connection);
+				});
+		});
+}
+
+// Read the header of a frame.
+void BridgeSource::doReadFrame(
+	unsigned connection)
+{
+	boost::asio::async_read(
+		_socket,
+		boost::asio::buffer(_header),
+		[this, connection](boost::system::error_code const& error, std::size_t) {
+			if (connection != _connection)
+			{
+				return;
+			}
+
+			auto length = bridge::get<uint32_t>(_header.data());
+
+			if (error)
+			{
+				doClose(error.message());
+				return;
+			}
+			if (bridge::get<uint32_t>(_header.data() + 4) != static_cast<uint32_t>(bridge::FrameType::batch) ||
+				length < bridge::BATCH_HEADER_SIZE || length > bridge::MAX_FRAME_SIZE)
+			{
+				doClose("invalid frame");
+				return;
+			}
+
+			// The body is read in a message: the payloads are sliced from it
+			// instead of being copied.
+			_body = synapse::framework::Message::create(length);
+			boost::asio::async_read(
+				_socket,
+				boost::asio::buffer(_body->payload(), length),
+				[this, connection](boost::system::error_code const& error, std::size_t) {
+					if (connection != _connection)
+					{
+						return;
+					}
+					if (error)
+					{
+						doClose(error.message());
+						return;
+					}
+					if (!dispatchBatch())
+					{
+						doClose("invalid batch");
+						return;
+					}
+					doAck(connection);
+					doReadFrame(connection);
+				});
+		});
+}
+
+// Acknowledge the messages received.
+void BridgeSource::doAck(
+	unsigned connection)
+{
+	// The acknowledgements of the batches received while a write is in
+	// progress are merged.
+	if (_acknowledging || _lastAcknowledged == _lastSequence)
+	{
+		return;
+	}
+
+	_acknowledging    = true;
+	_lastAcknowledged = _lastSequence;
+	_ack              = bridge::controlFrame(bridge::FrameType::ack, _lastAcknowledged);
+	boost::asio::async_write(
+		_socket,
+		boost::asio::buffer(_ack),
+		[this, connection](boost::system::error_code const& error, std::size_t) {
+			if (connection != _connection)
+			{
+				return;
+			}
+			_acknowledging = false;
+			if (error)
+			{
+				doClose(error.message());
+				return;
+			}
+			doAck(connection);
+		});
+}
+
+// Close the connection.
+void BridgeSource::doClose(
+	const std::string& reason)
+{
+	boost::system::error_code ignored;
+
+	++_connection;
+	_socket.close(ignored);
+	_body = synapse::framework::MessagePtr();
+
+	spdlog::error("Block '{}': connection closed: {}", name(), reason);
+}
+
+// Dispatch the messages of a batch.
+bool BridgeSource::dispatchBatch()
+{
+	const uint8_t* body   = _body->payload();
+	size_t         length = _body->size();
+	auto           first  = bridge::get<uint64_t>(body);
+	auto           count  = bridge::get<uint32_t>(body + 8);
+	size_t         offset = bridge::BATCH_HEADER_SIZE;
+
+	// The messages of a batch follow the last one received: a gap means that
+	// messages are lost.
+	if (_sessionStarting)
+	{
+		_lastSequence    = first > 0 ? first - 1 : 0;
+		_sessionStarting = false;
+	}
+	else if (first > _lastSequence + 1)
+	{
+		spdlog::error("Block '{}': messages {} to {} lost", name(), _lastSequence + 1, first - 1);
+		return false;
+	}
+
+	for (uint32_t index = 0; index < count; ++index)
+	{
+		if (length - offset < bridge::RECORD_HEADER_SIZE)
+		{
+			return false;
+		}
+
+		auto record = body + offset;
+		auto size   = bridge::get<uint32_t>(record);
+
+		offset += bridge::RECORD_HEADER_SIZE;
+		if (length - offset < size)
+		{
+			return false;
+		}
+
+		// The messages sent again after a reconnection are ignored.
+		if (first + index <= _lastSequence)
+		{
+			++_duplicates;
+			offset += size;
+			continue;
+		}
+		_lastSequence = first + index;
+
+		// The payloads reference the batch without copy, the output port
+		// stamps the origin and the sequence number of the message.
+		auto message = synapse::framework::Message::slice(_body, offset, size);
+
+		message->metadata().timestamp = bridge::get<uint64_t>(record + 8);
+		offset += size;
+
+		_outputPort->dispatch(message);
+	}
+
+	return offset == length;
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,223 @@
+///
+/// @file BridgeSource.h
+///
+/// Declaration of the BridgeSource class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <boost/asio.hpp>
+
+#include <synapse/framework/MessagePtr.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Source.h>
+
+#include "BridgeProtocol.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+///
+/// Implement a block that receives the messages passed by another engine
+/// through a TCP connection (sent by a BridgeSink).
+///
+/// The messages are dispatched with the timestamp they had in the other
+/// engine. Their origin and sequence number are given by the output port of
+/// the source: the identifiers of the ports of the other engine would collide
+/// with the local ones. The source remembers the last sequence number received
+/// from the session of the sink: the messages sent again after a reconnection
+/// are dispatched once, a gap in the sequence numbers closes the connection
+/// (the sink sends the missing messages again when it reconnects). The first
+/// batch of a session that the source does not know is the starting point of
+/// the sequence numbers. Each batch is acknowledged.
+///
+class BridgeSource :
+	public synapse::framework::Source
+{
+	DECLARE_BLOCK(BridgeSource)
+
+	// Définitions
+
+public:
+
+	/// Configuration of the block.
+	struct Config
+	{
+		/// Address to listen on (logic address as localhost or static address as 192.168.64.32).
+		std::string host;
+
+		/// TCP port to listen on.
+		uint16_t    port;
+	};
+
+	// Construction, destruction
+
+private:
+
+	/// Constructor.
+	///
+	/// @param name Name of the block.
+	BridgeSource(
+		const std::string& name);
+
+	/// Destructor.
+	virtual ~BridgeSource();
+
+	// Implementation of IBlock
+
+public:
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData&             configData,
+		synapse::framework::IManager* manager) override;
+
+	/// Ask the block to prepare to be deleted (terminate all pending operations).
+	void shutdown() override final;
+
+	// Implementation of IProducer
+
+public:
+
+	/// Get the list of output ports.
+	///
+	/// @param[in] configData The configuration data of the block.
+	///
+	/// @return The list of the names of the output ports.
+	std::list<std::string> ports(const IBlock::ConfigData&) override final { return { OUTPUT_PORT_NAME }; }
+
+	// Implementation of IRunnable
+
+public:
+
+	/// Control function of the runnable.
+	///
+	/// This method is called by the manager in a thread dedicated to the
+	/// execution of the runnable.
+	void run() override final;
+
+	// Accessors
+
+public:
+
+	/// Get the number of messages received twice (and dispatched once).
+	///
+	/// @return The number of messages.
+	uint64_t duplicates() const { return _duplicates.load(std::memory_order_relaxed); }
+
+	// Implementation
+
+private:
+
+	/// Start to accept a connection.
+	void doAccept();
+
+	/// Read the session of the sink and reply with the last sequence number received.
+	///
+	/// @param connection The connection the read belongs to.
+	void doHandshake(
+		unsigned connection);
+
+	/// Read the header of a frame.
+	///
+	/// @param connection The connection the read belongs to.
+	void doReadFrame(
+		unsigned connection);
+
+	/// Acknowledge the messages received.
+	///
+	/// @param connection The connection the write belongs to.
+	void doAck(
+		unsigned connection);
+
+	/// Close the connection.
+	///
+	/// @param reason The reason of the closing.
+	void doClose(
+		const std::string& reason);
+
+	/// Dispatch the messages of a batch.
+	///
+	/// @return false if the batch is malformed or does not follow the last
+	/// message received.
+	bool dispatchBatch();
+
+	// Private definitions
+
+private:
+
+	/// Name of the output port.
+	static const char* OUTPUT_PORT_NAME;
+
+	// Private attributes
+
+private:
+
+	/// Configuration data.
+	Config                                                                      _config;
+
+	/// The boost::asio context.
+	boost::asio::io_context                                                     _ioc;
+
+	/// The acceptor of the connections.
+	boost::asio::ip::tcp::acceptor                                              _acceptor{ _ioc };
+
+	/// The connection to the sink.
+	boost::asio::ip::tcp::socket                                                _socket{ _ioc };
+
+	/// Counter of the connections (the handlers of a closed connection are ignored).
+	unsigned                                                                    _connection{ 0 };
+
+	/// Session of the sink.
+	uint64_t                                                                    _session{ 0 };
+
+	/// Last sequence number received in the session.
+	uint64_t                                                                    _lastSequence{ 0 };
+
+	/// Indicates that no message of the session is received yet (the first
+	/// batch of a session started with another source may follow messages
+	/// acknowledged by it).
+	bool                                                                        _sessionStarting{ true };
+
+	/// Last sequence number acknowledged.
+	uint64_t                                                                    _lastAcknowledged{ 0 };
+
+	/// Indicates that an acknowledgement is being written.
+	bool                                                                        _acknowledging{ false };
+
+	/// The buffer of the control frames read.
+	std::array<uint8_t, bridge::FRAME_HEADER_SIZE + bridge::CONTROL_BODY_SIZE> _control;
+
+	/// The resume frame.
+	std::array<uint8_t, bridge::FRAME_HEADER_SIZE + bridge::CONTROL_BODY_SIZE> _resume;
+
+	/// The ack frame.
+	std::array<uint8_t, bridge::FRAME_HEADER_SIZE + bridge::CONTROL_BODY_SIZE> _ack;
+
+	/// The header of the frame being read.
+	std::array<uint8_t, bridge::FRAME_HEADER_SIZE>                             _header;
+
+	/// The body of the batch being read (the large payloads are sliced from it).
+	synapse::framework::MessagePtr                                              _body;
+
+	/// Number of messages received twice.
+	std::atomic<uint64_t>                                                       _duplicates{ 0 };
+
+	/// The output port.
+	synapse::framework::IPort*                                                  _outputPort{ nullptr };
+};
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -57,7 +57,7 @@ void ConsoleLoggerSink::initialize(
 
 // Process a message in the context of the runnable.
 void ConsoleLoggerSink::process(
-	const std::shared_ptr<synapse::framework::Message>& message)
+	const synapse::framework::MessagePtr& message)
 {
 	std::cout << _config.pattern << " | " << std::string_view(reinterpret_cast<const char*>(message->payload()), message->size()) << std::endl;
 }
@@ -87,7 +87,7 @@ void FileLoggerSink::initialize(
 
 // Process a message in the context of the runnable.
 void FileLoggerSink::process(
-	const std::shared_ptr<synapse::framework::Message>& message)
+	const synapse::framework::MessagePtr& message)
 {
 	// Perform rotation if needed.
 	bool rotate =
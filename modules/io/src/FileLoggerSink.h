@@ -96,7 +96,7 @@ protected:
 	///
 	/// @param message[in] Message to be processed.
 	void process(
-		const std::shared_ptr<synapse::framework::Message>& message) override final;
+		const synapse::framework::MessagePtr& message) override final;
 
 	// Private definition
 
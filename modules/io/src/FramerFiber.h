@@ -92,7 +92,7 @@ public:
 	///
 	/// @param message[in] Message to be consumed.
 	void consume(
-		const std::shared_ptr<synapse::framework::Message>& message) override final;
+		const synapse::framework::MessagePtr& message) override final;
 
 	// Operations
 
@@ -126,6 +126,42 @@ private:
 		size_t&   length,
 		uint8_t*& start) const;
 
+	/// Find the number of bytes of a message that complete the frame held by
+	/// the buffer (up to its first end sequence).
+	///
+	/// @param[in] message The message that follows the bytes of the buffer.
+	///
+	/// @return The number of bytes, the size of the message if it does not
+	/// hold an end sequence.
+	size_t findCompletion(
+		const synapse::framework::MessagePtr& message) const;
+
+	/// Extract the frames of a message without copy (the buffer is empty), the
+	/// incomplete frame at its end is kept in the buffer.
+	///
+	/// @param[in] message The message.
+	/// @param[in] offset The offset of the first byte to process.
+	void slice(
+		const synapse::framework::MessagePtr& message,
+		size_t                                offset);
+
+	/// Add bytes at the end of the buffer (the first bytes of the buffer are
+	/// discarded if it is too small).
+	///
+	/// @param[in] data The bytes to add.
+	/// @param[in] size The number of bytes.
+	void append(
+		const uint8_t* data,
+		size_t         size);
+
+	/// Extract the frames of the buffer (copied in new messages), the
+	/// incomplete frame at its end is kept in the buffer.
+	///
+	/// @param[in] message The message that completes the frames (its metadata
+	/// are inherited).
+	void extract(
+		const synapse::framework::MessagePtr& message);
+
 	// Private definitions
 
 private:
@@ -0,0 +1,225 @@
+///
+/// @file ShmRing.cpp
+///
+/// Implementation of the ShmRing class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fmt/format.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ShmRing.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+namespace {
+
+/// Identifies an initialized segment ("SYNAPSHM").
+constexpr uint64_t MAGIC = 0x53594e415053484dULL;
+
+/// Number of checks before giving up on a segment being initialized.
+constexpr int      INITIALIZATION_CHECKS = 100;
+
+/// Delay between the checks of a segment being initialized.
+constexpr auto     INITIALIZATION_DELAY = std::chrono::milliseconds(10);
+
+} // namespace
+
+// Open a ring, create it if it does not exist.
+ShmRing::ShmRing(
+	const std::string& name,
+	size_t             capacity)
+	: _capacity(capacity),
+	  _mappingSize(sizeof(Header) + capacity)
+{
+	if (capacity < 2 * footprint(0))
+	{
+		throw std::invalid_argument(fmt::format("shared memory '{}': the capacity shall be at least {} bytes", name, 2 * footprint(0)));
+	}
+	if ((capacity & (capacity - 1)) != 0)
+	{
+		throw std::invalid_argument(fmt::format("shared memory '{}': the capacity shall be a power of 2", name));
+	}
+
+#if !defined(_WIN32)
+	auto path    = "/" + name;
+	bool created = true;
+	int  fd      = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+	if (fd < 0 && errno == EEXIST)
+	{
+		created = false;
+		fd      = shm_open(path.c_str(), O_RDWR, 0600);
+	}
+	if (fd < 0)
+	{
+		throw std::runtime_error(fmt::format("shared memory '{}': {}", name, std::strerror(errno)));
+	}
+
+	// The creator sizes the segment, the other process waits for it.
+	bool sized = created ? ftruncate(fd, static_cast<off_t>(_mappingSize)) == 0 : false;
+
+	for (int check = 0; !created && check < INITIALIZATION_CHECKS && !sized; ++check)
+	{
+		struct stat status;
+
+		sized = fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(Header);
+		if (!sized)
+		{
+			std::this_thread::sleep_for(INITIALIZATION_DELAY);
+		}
+	}
+	if (sized)
+	{
+		_mapping = mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+
+	if (!sized || _mapping == MAP_FAILED)
+	{
+		_mapping = nullptr;
+		throw std::runtime_error(fmt::format("shared memory '{}': cannot map the segment", name));
+	}
+
+	_header = static_cast<Header*>(_mapping);
+	_data   = static_cast<uint8_t*>(_mapping) + sizeof(Header);
+
+	if (created)
+	{
+		_header->capacity = capacity;
+		_header->head.store(0, std::memory_order_relaxed);
+		_header->tail.store(0, std::memory_order_relaxed);
+		_header->magic.store(MAGIC, std::memory_order_release);
+	}
+	else
+	{
+		for (int check = 0; check < INITIALIZATION_CHECKS && _header->magic.load(std::memory_order_acquire) != MAGIC; ++check)
+		{
+			std::this_thread::sleep_for(INITIALIZATION_DELAY);
+		}
+		if (_header->magic.load(std::memory_order_acquire) != MAGIC || _header->capacity != capacity)
+		{
+			munmap(_mapping, _mappingSize);
+			_mapping = nullptr;
+			throw std::runtime_error(fmt::format("shared memory '{}': the segment is not a ring of {} bytes", name, capacity));
+		}
+	}
+
+	// Resume where the other side stands (restart of a process).
+	_reserved = _header->head.load(std::memory_order_acquire);
+	_taken    = _header->tail.load(std::memory_order_acquire);
+#else
+	throw std::runtime_error(fmt::format("shared memory '{}': not supported on this platform", name));
+#endif
+}
+
+// Destructor.
+ShmRing::~ShmRing()
+{
+#if !defined(_WIN32)
+	if (_mapping != nullptr)
+	{
+		munmap(_mapping, _mappingSize);
+	}
+#endif
+}
+
+// Reserve a record.
+ShmRing::Record* ShmRing::reserve(
+	size_t size)
+{
+	if (size > maxPayload())
+	{
+		throw std::length_error(fmt::format("a record of {} bytes does not fit in a ring of {} bytes", size, _capacity));
+	}
+
+	uint64_t position   = _header->head.load(std::memory_order_relaxed);
+	size_t   offset     = position & (_capacity - 1);
+	size_t   contiguous = _capacity - offset;
+	size_t   length     = footprint(size);
+	size_t   needed     = contiguous < length ? contiguous + length : length;
+
+	if (position + needed - _header->tail.load(std::memory_order_acquire) > _capacity)
+	{
+		return nullptr;
+	}
+
+	// The end of the ring is skipped when the record does not fit in it (the
+	// filler is published with the record).
+	if (contiguous < length)
+	{
+		reinterpret_cast<Record*>(_data + offset)->size = PADDING;
+		position += contiguous;
+		offset    = 0;
+	}
+
+	auto record = reinterpret_cast<Record*>(_data + offset);
+
+	record->size = static_cast<uint32_t>(size);
+	_reserved    = position + length;
+
+	return record;
+}
+
+// Publish the record reserved last.
+void ShmRing::commit()
+{
+	_header->head.store(_reserved, std::memory_order_release);
+}
+
+// Take the oldest record.
+ShmRing::Record* ShmRing::front()
+{
+	uint64_t position = _header->tail.load(std::memory_order_relaxed);
+
+	if (position == _header->head.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+
+	auto record = reinterpret_cast<Record*>(_data + (position & (_capacity - 1)));
+
+	if (record->size == PADDING)
+	{
+		position += _capacity - (position & (_capacity - 1));
+		record    = reinterpret_cast<Record*>(_data);
+	}
+	_taken = position + footprint(record->size);
+
+	return record;
+}
+
+// Release the record taken with front().
+void ShmRing::pop()
+{
+	_header->tail.store(_taken, std::memory_order_release);
+}
+
+// Delete a segment.
+void ShmRing::remove(
+	const std::string& name)
+{
+#if !defined(_WIN32)
+	shm_unlink(("/" + name).c_str());
+#endif
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,203 @@
+///
+/// @file ShmRing.h
+///
+/// Declaration of the ShmRing class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+///
+/// Single producer, single consumer ring of variable size records stored in
+/// a POSIX shared memory segment.
+///
+/// The ring connects two processes: the writer reserves a record, writes the
+/// payload in place in the segment and commits it; the reader takes the
+/// record in place and releases it. The positions are exchanged with atomic
+/// operations only, no system call is made while records flow.
+///
+/// The segment is created by the first process that opens it and is kept
+/// when the processes terminate, so that either side can be restarted. It is
+/// deleted with remove().
+///
+class ShmRing
+{
+	// Definitions
+
+public:
+
+	///
+	/// Header of a record.
+	///
+	struct Record
+	{
+		/// Size of the payload (PADDING for the filler of the end of the ring).
+		uint32_t size;
+
+		/// Reserved (alignment).
+		uint32_t reserved;
+
+		/// Timestamp of the message (nanoseconds of the steady clock).
+		uint64_t timestamp;
+
+		/// Get the payload of the record.
+		uint8_t* payload() { return reinterpret_cast<uint8_t*>(this + 1); }
+	};
+
+	/// Size of the filler record that skips the end of the ring.
+	static constexpr uint32_t PADDING = UINT32_MAX;
+
+	/// Alignment of the records.
+	static constexpr size_t   ALIGNMENT = 8;
+
+	// Construction, destruction
+
+public:
+
+	/// Open a ring, create it if it does not exist.
+	///
+	/// @param name The name of the segment (without the leading '/').
+	/// @param capacity The capacity of the ring in bytes (power of 2).
+	///
+	/// @throw std::invalid_argument If the capacity is not a power of 2.
+	/// @throw std::runtime_error If the segment cannot be opened or has
+	/// another capacity.
+	ShmRing(
+		const std::string& name,
+		size_t             capacity);
+
+	/// Destructor (unmaps the segment).
+	~ShmRing();
+
+	/// @cond
+	ShmRing(
+		const ShmRing& other) = delete;
+
+	ShmRing& operator=(
+		const ShmRing& other) = delete;
+	/// @endcond
+
+	// Accessors
+
+public:
+
+	/// Get the capacity of the ring.
+	///
+	/// @return The capacity in bytes.
+	size_t capacity() const { return _capacity; }
+
+	/// Get the maximum size of the payload of a record.
+	///
+	/// @return The maximum size in bytes.
+	size_t maxPayload() const { return _capacity / 2 - sizeof(Record); }
+
+	// Operations (writer)
+
+public:
+
+	/// Reserve a record.
+	///
+	/// @param size The size of the payload.
+	///
+	/// @return The record to fill, nullptr if the ring is full.
+	///
+	/// @throw std::length_error If the payload is larger than maxPayload().
+	Record* reserve(
+		size_t size);
+
+	/// Publish the record reserved last.
+	void    commit();
+
+	// Operations (reader)
+
+public:
+
+	/// Take the oldest record.
+	///
+	/// @return The record, nullptr if the ring is empty.
+	Record* front();
+
+	/// Release the record taken with front().
+	void    pop();
+
+	// Operations
+
+public:
+
+	/// Delete a segment.
+	///
+	/// @param name The name of the segment (without the leading '/').
+	static void remove(
+		const std::string& name);
+
+	// Private definitions
+
+private:
+
+	///
+	/// Header of the segment.
+	///
+	struct Header
+	{
+		/// Identifies an initialized segment.
+		std::atomic<uint64_t>             magic;
+
+		/// The capacity of the ring in bytes.
+		uint64_t                          capacity;
+
+		/// The position of the next record to write.
+		alignas(64) std::atomic<uint64_t> head;
+
+		/// The position of the next record to read.
+		alignas(64) std::atomic<uint64_t> tail;
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "the positions are shared between processes");
+
+	/// Get the size of a record in the ring.
+	///
+	/// @param size The size of the payload.
+	///
+	/// @return The size of the record, aligned.
+	static size_t footprint(
+		size_t size) { return (sizeof(Record) + size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+	// Private attributes
+
+private:
+
+	/// The capacity of the ring in bytes.
+	size_t   _capacity;
+
+	/// The size of the mapping.
+	size_t   _mappingSize;
+
+	/// The mapping of the segment.
+	void*    _mapping{ nullptr };
+
+	/// The header of the segment.
+	Header*  _header{ nullptr };
+
+	/// The records.
+	uint8_t* _data{ nullptr };
+
+	/// The position after the record being written (writer).
+	uint64_t _reserved{ 0 };
+
+	/// The position after the record being read (reader).
+	uint64_t _taken{ 0 };
+};
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
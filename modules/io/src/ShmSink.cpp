@@ -0,0 +1,150 @@
+///
+/// @file ShmSink.cpp
+///
+/// Implementation of the ShmSink class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include <synapse/framework/WaitStrategy.h>
+
+#include "ShmSink.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+IMPLEMENT_BLOCK(ShmSink)
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void from_json(
+	const nlohmann::json& json,
+	ShmSink::Config&      object)
+{
+	// Mandatory attributes.
+	json.at("segment").get_to(object.segment);
+
+	// Optional attributes.
+	object.capacity = json.value<size_t>("capacity", 1 << 20);
+	object.drop     = json.value<bool>("drop", false);
+	object.timeout  = json.value<uint32_t>("timeout", 100);
+}
+
+// Constructor.
+ShmSink::ShmSink(
+	const std::string& name)
+	: Sink(name)
+{
+}
+
+// Destructor.
+ShmSink::~ShmSink()
+{
+	shutdown();
+}
+
+// Initialize the block before the execution.
+void ShmSink::initialize(
+	const ConfigData&             configData,
+	synapse::framework::IManager* manager)
+{
+	// Call the base class implementation.
+	synapse::framework::Sink::initialize(configData, manager);
+
+	// Read configuration data.
+	_config = readConfig<ShmSink::Config>(configData);
+
+	// Open the ring (created if the reader is not started yet).
+	_ring = std::make_unique<ShmRing>(_config.segment, _config.capacity);
+}
+
+// Ask the component to prepare to be deleted (terminate all pending operations).
+void ShmSink::shutdown()
+{
+	if (!_stopping.exchange(true))
+	{
+		auto tooLarge = _tooLarge.load(std::memory_order_relaxed);
+
+		if (dropped() > tooLarge)
+		{
+			spdlog::warn("Block '{}': {} messages dropped, shared memory '{}' full", name(), dropped() - tooLarge, _config.segment);
+		}
+		if (tooLarge > 0)
+		{
+			spdlog::warn("Block '{}': {} messages dropped, too large for shared memory '{}'", name(), tooLarge, _config.segment);
+		}
+	}
+	synapse::framework::Sink::shutdown();
+}
+
+// Process a message in the context of the runnable.
+void ShmSink::process(
+	const synapse::framework::MessagePtr& message)
+{
+	static constexpr auto MAX_DELAY = std::chrono::microseconds(1000);
+
+	// A message larger than a record of the ring can never be written.
+	if (message->size() > _ring->maxPayload())
+	{
+		_tooLarge.fetch_add(1, std::memory_order_relaxed);
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// Wait for the reader while the ring is full (polling first, then with
+	// increasing sleeps: no system call while the reader keeps up), up to the
+	// timeout. No wait while the reader is lost.
+	auto record = _ring->reserve(message->size());
+
+	if (record == nullptr && !_config.drop && !_readerLost)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_config.timeout);
+		auto delay    = std::chrono::microseconds(1);
+
+		while (record == nullptr && !_stopping.load(std::memory_order_relaxed) && std::chrono::steady_clock::now() < deadline)
+		{
+			if (!synapse::framework::spinUntil({ synapse::framework::WaitMode::spinThenPark }, [&] { return (record = _ring->reserve(message->size())) != nullptr; }))
+			{
+				std::this_thread::sleep_for(delay);
+				delay = std::min(2 * delay, MAX_DELAY);
+			}
+		}
+
+		if (record == nullptr && !_stopping.load(std::memory_order_relaxed))
+		{
+			_readerLost = true;
+			spdlog::warn("Block '{}': shared memory '{}' full for {} ms, messages dropped until the reader frees room", name(), _config.segment, _config.timeout);
+		}
+	}
+
+	if (record == nullptr)
+	{
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	if (_readerLost)
+	{
+		_readerLost = false;
+		spdlog::info("Block '{}': shared memory '{}' read again", name(), _config.segment);
+	}
+
+	// The payload is written in place in the segment.
+	std::memcpy(record->payload(), message->payload(), message->size());
+	record->timestamp = message->metadata().timestamp;
+	_ring->commit();
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,135 @@
+///
+/// @file ShmSink.h
+///
+/// Declaration of the ShmSink class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <synapse/framework/Sink.h>
+
+#include "ShmRing.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+///
+/// Implement a block that passes the messages to another process through a
+/// ring in shared memory (read by a ShmSource).
+///
+/// When the ring is full, the sink waits for the reader at most for the
+/// configured timeout, so that it never holds its thread (a thread of the
+/// executor, most of the time) while the reader is absent. A reader that does
+/// not free room in time is considered gone: the messages are dropped at once
+/// until it frees room again.
+///
+class ShmSink :
+	public synapse::framework::Sink
+{
+	DECLARE_BLOCK(ShmSink)
+
+	// Définitions
+
+public:
+
+	/// Configuration of the block.
+	struct Config
+	{
+		/// Name of the shared memory segment.
+		std::string segment;
+
+		/// Capacity of the ring in bytes (power of 2).
+		size_t      capacity;
+
+		/// Indicates that the messages are dropped when the ring is full
+		/// (instead of waiting for the reader).
+		bool        drop;
+
+		/// Maximum time to wait for the reader when the ring is full (ms).
+		uint32_t    timeout;
+	};
+
+	// Construction, destruction
+
+private:
+
+	/// Constructor.
+	///
+	/// @param name Name of the block.
+	ShmSink(
+		const std::string& name);
+
+	/// Destructor.
+	virtual ~ShmSink();
+
+	// Accessors
+
+public:
+
+	/// Get the number of messages dropped because the ring was full or
+	/// because they are larger than a record of the ring.
+	///
+	/// @return The number of dropped messages.
+	uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+	// Implementation of IBlock
+
+public:
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData&             configData,
+		synapse::framework::IManager* manager) override;
+
+	/// Ask the block to prepare to be deleted (terminate all pending operations).
+	void shutdown() override final;
+
+	// Overload of Sink
+
+protected:
+
+	/// Process a message in the context of the runnable.
+	///
+	/// @param message[in] Message to be processed.
+	void process(
+		const synapse::framework::MessagePtr& message) override final;
+
+	// Private attributes
+
+private:
+
+	/// Configuration data.
+	Config                   _config;
+
+	/// The ring in shared memory.
+	std::unique_ptr<ShmRing> _ring;
+
+	/// Indicates that a shutdown has been requested.
+	std::atomic<bool>        _stopping{ false };
+
+	/// Indicates that the reader has not freed room in time (the messages
+	/// are dropped without waiting).
+	bool                     _readerLost{ false };
+
+	/// The number of dropped messages.
+	std::atomic<uint64_t>    _dropped{ 0 };
+
+	/// The number of messages dropped because they are larger than a record
+	/// of the ring.
+	std::atomic<uint64_t>    _tooLarge{ 0 };
+};
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
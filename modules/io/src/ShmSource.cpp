@@ -0,0 +1,117 @@
+///
+/// @file ShmSource.cpp
+///
+/// Implementation of the ShmSource class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include <synapse/framework/Message.h>
+#include <synapse/framework/WaitStrategy.h>
+
+#include "ShmSource.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+IMPLEMENT_BLOCK(ShmSource)
+
+const char* ShmSource::OUTPUT_PORT_NAME = "default";
+
+/// Convert a json object to a cpp object.
+/// @param json JSON object.
+/// @param object cpp object.
+void        from_json(
+		   const nlohmann::json& json,
+		   ShmSource::Config&    object)
+{
+	// Mandatory attributes.
+	json.at("segment").get_to(object.segment);
+
+	// Optional attributes.
+	object.capacity = json.value<size_t>("capacity", 1 << 20);
+	object.spins    = json.value<size_t>("spins", synapse::framework::WaitStrategy::DEFAULT_SPINS);
+}
+
+// Constructor.
+ShmSource::ShmSource(
+	const std::string& name)
+	: Source(name)
+{
+}
+
+// Destructor.
+ShmSource::~ShmSource()
+{
+}
+
+// Initialize the block before the execution.
+void ShmSource::initialize(
+	const ConfigData&             configData,
+	synapse::framework::IManager* manager)
+{
+	// Call the base class implementation.
+	synapse::framework::Source::initialize(configData, manager);
+
+	// Read configuration data.
+	_config = readConfig<ShmSource::Config>(configData);
+
+	// Find the output port.
+	_outputPort = manager->find(this, OUTPUT_PORT_NAME);
+
+	// Open the ring (created if the writer is not started yet).
+	_ring = std::make_unique<ShmRing>(_config.segment, _config.capacity);
+}
+
+// Ask the component to prepare to be deleted (terminate all pending operations).
+void ShmSource::shutdown()
+{
+	_stopping.store(true);
+}
+
+// Control function of the runnable.
+void ShmSource::run()
+{
+	static constexpr auto MAX_DELAY = std::chrono::microseconds(1000);
+
+	synapse::framework::WaitStrategy strategy{ synapse::framework::WaitMode::spinThenPark, _config.spins };
+	auto                             delay = std::chrono::microseconds(1);
+
+	spdlog::info("Block '{}': reading shared memory '{}'", name(), _config.segment);
+
+	while (!_stopping.load(std::memory_order_relaxed))
+	{
+		// Poll the ring, then sleep longer and longer while it stays empty: no
+		// system call is made while the writer keeps it fed.
+		ShmRing::Record* record = _ring->front();
+
+		if (record == nullptr && !synapse::framework::spinUntil(strategy, [&] { return (record = _ring->front()) != nullptr; }))
+		{
+			std::this_thread::sleep_for(delay);
+			delay = std::min(2 * delay, MAX_DELAY);
+			continue;
+		}
+		delay = std::chrono::microseconds(1);
+
+		// The record is copied into a message of the pool and released at
+		// once, so that the writer can reuse the room.
+		auto message = synapse::framework::Message::create(record->size, record->payload());
+
+		message->metadata().timestamp = record->timestamp;
+		_ring->pop();
+		_outputPort->dispatch(message);
+	}
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
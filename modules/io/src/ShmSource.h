@@ -0,0 +1,126 @@
+///
+/// @file ShmSource.h
+///
+/// Declaration of the ShmSource class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Source.h>
+
+#include "ShmRing.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+///
+/// Implement a block that reads the messages passed by another process
+/// through a ring in shared memory (written by a ShmSink).
+///
+class ShmSource :
+	public synapse::framework::Source
+{
+	DECLARE_BLOCK(ShmSource)
+
+	// Définitions
+
+public:
+
+	/// Configuration of the block.
+	struct Config
+	{
+		/// Name of the shared memory segment.
+		std::string segment;
+
+		/// Capacity of the ring in bytes (power of 2).
+		size_t      capacity;
+
+		/// Number of polls of the empty ring before sleeping.
+		size_t      spins;
+	};
+
+	// Construction, destruction
+
+private:
+
+	/// Constructor.
+	///
+	/// @param name Name of the block.
+	ShmSource(
+		const std::string& name);
+
+	/// Destructor.
+	virtual ~ShmSource();
+
+	// Implementation of IBlock
+
+public:
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData&             configData,
+		synapse::framework::IManager* manager) override;
+
+	/// Ask the block to prepare to be deleted (terminate all pending operations).
+	void shutdown() override final;
+
+	// Implementation of IProducer
+
+public:
+
+	/// Get the list of output ports.
+	///
+	/// @param[in] configData The configuration data of the block.
+	///
+	/// @return The list of the names of the output ports.
+	std::list<std::string> ports(const IBlock::ConfigData&) override final { return { OUTPUT_PORT_NAME }; }
+
+	// Implementation of IRunnable
+
+public:
+
+	/// Control function of the runnable.
+	///
+	/// This method is called by the manager in a thread dedicated to the
+	/// execution of the runnable.
+	void run() override final;
+
+	// Private definitions
+
+private:
+
+	/// Name of the output port.
+	static const char* OUTPUT_PORT_NAME;
+
+	// Private attributes
+
+private:
+
+	/// Configuration data.
+	Config                     _config;
+
+	/// The ring in shared memory.
+	std::unique_ptr<ShmRing>   _ring;
+
+	/// Indicates that a shutdown has been requested.
+	std::atomic<bool>          _stopping{ false };
+
+	/// The output port.
+	synapse::framework::IPort* _outputPort{ nullptr };
+};
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -11,6 +11,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include "AsioAwaitables.h"
 #include "TcpClientSource.h"
 
 namespace synapse {
@@ -40,7 +41,7 @@ void        from_json(
 // Constructor.
 TcpClientSource::TcpClientSource(
 	const std::string& name)
-	: Source(name)
+	: CoroutineBlock(name)
 {
 }
 
@@ -55,7 +56,7 @@ void TcpClientSource::initialize(
 	synapse::framework::IManager* manager)
 {
 	// Call the base class implementation.
-	synapse::framework::Source::initialize(configData, manager);
+	synapse::framework::CoroutineBlock::initialize(configData, manager);
 
 	// Read configuration data.
 	_config = readConfig<TcpClientSource::Config>(configData);
@@ -67,112 +68,78 @@ void TcpClientSource::initialize(
 // Ask the component to prepare to be deleted (terminate all pending operations).
 void TcpClientSource::shutdown()
 {
+	synapse::framework::CoroutineBlock::shutdown();
 	_ioc.stop();
 }
 
 // Control function of the runnable.
 void TcpClientSource::run()
+{
+	// Keep the io_context running while the coroutine starts the next
+	// operation.
+	auto guard = boost::asio::make_work_guard(_ioc);
+
+	_ioc.run();
+}
+
+// Body of the block.
+synapse::framework::Coroutine TcpClientSource::main()
 {
 	// Try to resolve the address of the end point.
-	boost::asio::ip::tcp::endpoint endPoint;
-	{
-		boost::asio::io_context        ioc;
-		boost::asio::ip::tcp::resolver resolver(ioc);
-		auto                           results = resolver.resolve(_config.host, std::to_string(_config.port));
+	auto resolution = co_await asyncResolve(_resolver, _config.host, std::to_string(_config.port));
 
-		if (results.empty())
-		{
-			throw std::runtime_error(fmt::format("unable to resolve address: {}", _config.host));
-		}
-		endPoint = results.begin()->endpoint();
+	if (resolution.first || resolution.second.empty())
+	{
+		throw std::runtime_error(fmt::format("unable to resolve address: {}", _config.host));
 	}
 
+	auto endPoint = resolution.second.begin()->endpoint();
+
 	// Allocate the buffer to received data in.
 	_buffer = std::make_unique<uint8_t[]>(_config.bufferSize);
 
-	// Prepare async objects.
-	boost::asio::ip::tcp::socket socket(_ioc);
-	boost::asio::steady_timer    retryTimer(_ioc);
-
-	// Prepare the connection to the server.
-	doConnect(socket, endPoint, retryTimer);
-
-	// Start async operations.
-	_ioc.run();
-}
+	while (!stopping())
+	{
+		spdlog::info("Connecting...");
+		if (auto error = co_await asyncConnect(_socket, endPoint))
+		{
+			spdlog::error("Connection failed: {}", error.message());
+			_socket.close();
+		}
+		else
+		{
+			spdlog::info("Connected");
 
-/// Start an async connection.
-void TcpClientSource::doConnect(
-	boost::asio::ip::tcp::socket&         socket,
-	const boost::asio::ip::tcp::endpoint& endPoint,
-	boost::asio::steady_timer&            retryTimer)
-{
-	spdlog::info("Connecting...");
-	socket.async_connect(
-		endPoint,
-		[this, &socket, &endPoint, &retryTimer](boost::system::error_code const& error) {
-			if (error)
+			while (!stopping())
 			{
-				spdlog::error("Connection failed: ", error.message());
-				doWait(socket, endPoint, retryTimer);
-			}
-			else
-			{
-				spdlog::info("Connected");
-				doRead(socket, endPoint, retryTimer);
-			}
-		});
-}
+				auto [error, bytes, timestamp] = co_await asyncReadSome(_socket, boost::asio::buffer(_buffer.get(), _config.bufferSize));
 
-// Start to wait for a while before attempting to connect again to the server.
-void TcpClientSource::doWait(
-	boost::asio::ip::tcp::socket&         socket,
-	const boost::asio::ip::tcp::endpoint& endPoint,
-	boost::asio::steady_timer&            retryTimer)
-{
-	spdlog::info("Wait for a while...");
-	retryTimer.expires_after(std::chrono::seconds(_config.retryDelay));
-	retryTimer.async_wait(
-		[this, &socket, &endPoint, &retryTimer](boost::system::error_code error) {
-			if (error)
-			{
-				spdlog::error("Wait failed: ", error.message());
-			}
-			else
-			{
-				doConnect(socket, endPoint, retryTimer);
-			}
-		});
-}
+				if (error)
+				{
+					spdlog::error("Read failed: {}", error.message());
+					_socket.close();
+					break;
+				}
 
-// Performs an async read operation.
-void TcpClientSource::doRead(
-	boost::asio::ip::tcp::socket&         socket,
-	const boost::asio::ip::tcp::endpoint& endPoint,
-	boost::asio::steady_timer&            retryTimer)
-{
-	socket.async_read_some(
-		boost::asio::buffer(_buffer.get(), _config.bufferSize),
-		[this, &socket, &endPoint, &retryTimer](
-			boost::system::error_code const& error,
-			std::size_t                      bytes) {
-			if (error)
-			{
-				spdlog::error("Read failed: ", error.message());
-				socket.close();
-				doWait(socket, endPoint, retryTimer);
-			}
-			else
-			{
-				// Process the received data.
-				auto message = std::make_shared<synapse::framework::Message>(bytes, _buffer.get());
+				// Process the received data (stamped with the time of the reception,
+				// not the time the coroutine is resumed).
+				auto message = synapse::framework::Message::create(bytes, _buffer.get());
 
+				message->metadata().timestamp = timestamp;
 				_outputPort->dispatch(message);
+			}
+		}
 
-				// Start a new read operation.
-				doRead(socket, endPoint, retryTimer);
+		// Wait for a while before attempting to connect again to the server.
+		if (!stopping())
+		{
+			spdlog::info("Wait for a while...");
+			if (auto error = co_await asyncWait(_retryTimer, std::chrono::seconds(_config.retryDelay)))
+			{
+				spdlog::error("Wait failed: {}", error.message());
 			}
-		});
+		}
+	}
 }
 
 } // namespace io
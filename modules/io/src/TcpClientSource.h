@@ -11,12 +11,13 @@
 #include <cstdint>
 #include <memory>
 #include <string>
-#include <thread>
 
 #include <boost/asio.hpp>
 
+#include <synapse/framework/CoroutineBlock.h>
+#include <synapse/framework/IProducer.h>
+#include <synapse/framework/IRunnable.h>
 #include <synapse/framework/Port.h>
-#include <synapse/framework/Source.h>
 
 namespace synapse {
 namespace modules {
@@ -25,8 +26,15 @@ namespace io {
 ///
 /// Implement a block that read data from a TCP server.
 ///
+/// The connection is handled by a coroutine resumed by the executor each time
+/// an asynchronous operation completes: the messages are created and
+/// dispatched by the threads of the executor. The thread of the block only
+/// runs the io_context that performs the operations.
+///
 class TcpClientSource :
-	public synapse::framework::Source
+	public synapse::framework::CoroutineBlock,
+	public synapse::framework::IProducer,
+	public synapse::framework::IRunnable
 {
 	DECLARE_BLOCK(TcpClientSource)
 
@@ -96,45 +104,20 @@ public:
 
 public:
 
-	/// Control function of the runnable.
+	/// Control function of the runnable (runs the io_context).
 	///
 	/// This method is called by the manager in a thread dedicated to the
 	/// execution of the runnable.
 	void run() override final;
 
-	// Implementation
+	// Implementation of CoroutineBlock
 
-private:
+protected:
 
-	/// Start an async connection.
-	///
-	/// @param socket The socket to connect on.
-	/// @param endPoint The end point to connect on.
-	/// @param retryTimer The timer to wait for before retrying to connect.
-	void doConnect(
-		boost::asio::ip::tcp::socket&         socket,
-		const boost::asio::ip::tcp::endpoint& endPoint,
-		boost::asio::steady_timer&            retryTimer);
-
-	/// Start to wait for a while before attempting to connect again to the server.
-	///
-	/// @param socket The socket to connect on.
-	/// @param endPoint The end point to connect on.
-	/// @param retryTimer The timer to wait for before retrying to connect.
-	void doWait(
-		boost::asio::ip::tcp::socket&         socket,
-		const boost::asio::ip::tcp::endpoint& endPoint,
-		boost::asio::steady_timer&            retryTimer);
-
-	/// Performs an async read operation.
+	/// Body of the block (connect, read and reconnect on error).
 	///
-	/// @param socket The socket to connect on.
-	/// @param endPoint The end point to connect on.
-	/// @param retryTimer The timer to wait for before retrying to connect.
-	void doRead(
-		boost::asio::ip::tcp::socket&         socket,
-		const boost::asio::ip::tcp::endpoint& endPoint,
-		boost::asio::steady_timer&            retryTimer);
+	/// @return The coroutine (created suspended).
+	synapse::framework::Coroutine main() override final;
 
 	// Private definitions
 
@@ -148,16 +131,25 @@ private:
 private:
 
 	/// Configuration data.
-	Config                     _config;
+	Config                         _config;
 
 	/// The buffer to perform readings.
-	std::unique_ptr<uint8_t[]> _buffer;
+	std::unique_ptr<uint8_t[]>     _buffer;
 
 	/// The boost::asio context.
-	boost::asio::io_context    _ioc;
+	boost::asio::io_context        _ioc;
+
+	/// The resolver of the address of the server.
+	boost::asio::ip::tcp::resolver _resolver{ _ioc };
+
+	/// The socket connected to the server.
+	boost::asio::ip::tcp::socket   _socket{ _ioc };
+
+	/// The timer to wait for before retrying to connect.
+	boost::asio::steady_timer      _retryTimer{ _ioc };
 
 	/// The output port.
-	synapse::framework::IPort* _outputPort{ nullptr };
+	synapse::framework::IPort*     _outputPort{ nullptr };
 };
 
 } // namespace io
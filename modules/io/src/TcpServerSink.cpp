@@ -43,7 +43,7 @@ void TcpServerSink::initialize(
 
 // Process a message in the context of the runnable.
 void TcpServerSink::process(
-	const std::shared_ptr<synapse::framework::Message>& message)
+	const synapse::framework::MessagePtr& message)
 {
 	(void) message; // Unused parameter.
 }
@@ -13,10 +13,14 @@
 
 #include <synapse/framework/Registry.h>
 
+#include "BridgeSink.h"
+#include "BridgeSource.h"
 #include "ConsoleLoggerSink.h"
 #include "FileLoggerSink.h"
 #include "FramerFiber.h"
 #include "SerialSource.h"
+#include "ShmSink.h"
+#include "ShmSource.h"
 #include "TcpClientSource.h"
 #include "TcpServerSink.h"
 
@@ -29,10 +33,14 @@
 API void registerBlocks(
 	synapse::framework::Registry& registry)
 {
+	registry.registerDescription(synapse::modules::io::BridgeSink::description());
+	registry.registerDescription(synapse::modules::io::BridgeSource::description());
 	registry.registerDescription(synapse::modules::io::ConsoleLoggerSink::description());
 	registry.registerDescription(synapse::modules::io::FileLoggerSink::description());
 	registry.registerDescription(synapse::modules::io::FramerFiber::description());
 	registry.registerDescription(synapse::modules::io::SerialSource::description());
+	registry.registerDescription(synapse::modules::io::ShmSink::description());
+	registry.registerDescription(synapse::modules::io::ShmSource::description());
 	registry.registerDescription(synapse::modules::io::TcpClientSource::description());
 	registry.registerDescription(synapse::modules::io::TcpServerSink::description());
 }
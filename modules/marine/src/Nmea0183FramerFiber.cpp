@@ -7,8 +7,11 @@
 /// @copyright Copyright (c) 2024, Xavier Caroff
 ///
 
+#include <algorithm>
+#include <array>
 #include <regex>
 #include <string>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -77,169 +80,240 @@ void Nmea0183FramerFiber::shutdown()
 
 // Consume a message.
 void Nmea0183FramerFiber::consume(
-	const std::shared_ptr<synapse::framework::Message>& message)
+	const synapse::framework::MessagePtr& message)
 {
 	// Nothing to do if the content of the message is empty.
-	bool goOn = message->size() > 0;
+	if (message->size() == 0)
+	{
+		return;
+	}
+
+	size_t offset = 0;
 
-	// If the buffer is empty, try to extract frames from the message
-	// and store the rest in the buffer.
-	if (goOn && _bufferCount == 0)
+	// If the buffer is not empty, only the frame it holds is completed with the
+	// first bytes of the message (up to the first end sequence) and copied.
+	if (_bufferCount > 0)
 	{
-		auto     begin = message->payload();
-		auto     end   = message->payload() + message->size();
-		size_t   length{ 0 };
-		uint8_t* start{ nullptr };
+		offset = findCompletion(message);
+		append(message->payload(), offset);
+		extract(message);
+	}
 
-		while (begin < end)
+	// The other frames reference the message without copy. If the buffer
+	// still holds bytes (no frame completed), the rest of the message is added
+	// to it.
+	if (offset < message->size())
+	{
+		if (_bufferCount == 0)
 		{
-			auto found = findFrame(begin, end, length, start);
+			slice(message, offset);
+		}
+		else
+		{
+			append(message->payload() + offset, message->size() - offset);
+			extract(message);
+		}
+	}
+}
 
-			if (found)
-			{
-				// Create a message and forward it.
-				_outputPort->dispatch(std::make_shared<synapse::framework::Message>(length, found));
+// Find the number of bytes of a message that complete the frame of the buffer.
+size_t Nmea0183FramerFiber::findCompletion(
+	const synapse::framework::MessagePtr& message) const
+{
+	static const std::array<uint8_t, 2> endSequence{ '\r', '\n' };
 
-				// Warn if some bytes where skipped.
-				if (found != begin)
-				{
-					spdlog::warn("{}: {} bytes skipped.", name(), found - begin);
-				}
-				// Adjust the new begin position for the search.
-				begin = found + length;
+	auto payload = message->payload();
+	auto size    = message->size();
+
+	// The end sequence may straddle the buffer and the message.
+	auto overlap = std::min(_bufferCount, endSequence.size() - 1);
+
+	if (overlap > 0)
+	{
+		std::vector<uint8_t> joint(_buffer + _bufferCount - overlap, _buffer + _bufferCount);
+
+		joint.insert(joint.end(), payload, payload + std::min(size, endSequence.size() - 1));
+
+		auto found = std::search(joint.begin(), joint.end(), endSequence.begin(), endSequence.end());
+
+		if (found != joint.end())
+		{
+			return static_cast<size_t>(found - joint.begin()) + endSequence.size() - overlap;
+		}
+	}
+
+	// Otherwise the first end sequence of the message completes the frame.
+	auto found = std::search(payload, payload + size, endSequence.begin(), endSequence.end());
+
+	return found != payload + size ? static_cast<size_t>(found - payload) + endSequence.size() : size;
+}
+
+// Extract the frames of a message (the buffer is empty).
+void Nmea0183FramerFiber::slice(
+	const synapse::framework::MessagePtr& message,
+	size_t                                offset)
+{
+	auto     begin = message->payload() + offset;
+	auto     end   = message->payload() + message->size();
+	size_t   length{ 0 };
+	uint8_t* start{ nullptr };
+
+	while (begin < end)
+	{
+		auto found = findFrame(begin, end, length, start);
+
+		if (found)
+		{
+			// Forward the frame, it references the message without copy.
+			_outputPort->dispatch(synapse::framework::Message::slice(message, found - message->payload(), length));
+
+			// Warn if some bytes where skipped.
+			if (found != begin)
+			{
+				spdlog::warn("{}: {} bytes skipped.", name(), found - begin);
 			}
-			else
+			// Adjust the new begin position for the search.
+			begin = found + length;
+		}
+		else
+		{
+			// If a start sequence is found, keep the rest in the buffer.
+			if (start != nullptr)
 			{
-				// If a start sequence is found, keep the rest in the buffer.
-				if (start != nullptr)
+				if (start != begin)
 				{
-					if (start != begin)
-					{
-						spdlog::warn("{}: {} bytes skipped.", name(), start - begin);
-					}
-					// If the buffer is too small to copy all the message the first part of
-					// the message is discarded.
-					if (static_cast<size_t>(end - start) > _bufferSize)
-					{
-						auto lost = (end - start) - _bufferSize;
-						start += lost;
-						spdlog::error("{}: {} bytes discarded since the buffer is too small.", name(), lost);
-					}
-					std::memcpy(_buffer, start, end - start);
-					_bufferCount = end - start;
+					spdlog::warn("{}: {} bytes skipped.", name(), start - begin);
 				}
-				// No start sequence found.
-				else
+				// If the buffer is too small to copy all the message the first part of
+				// the message is discarded.
+				if (static_cast<size_t>(end - start) > _bufferSize)
 				{
-					// Number of bytes left in the message.
-					size_t left = end - begin;
-					spdlog::warn("{}: {} bytes skipped.", name(), left);
-					_bufferCount = 0;
+					auto lost = (end - start) - _bufferSize;
+					start += lost;
+					spdlog::error("{}: {} bytes discarded since the buffer is too small.", name(), lost);
 				}
-				break;
+				std::memcpy(_buffer, start, end - start);
+				_bufferCount = end - start;
+			}
+			// No start sequence found.
+			else
+			{
+				// Number of bytes left in the message.
+				size_t left = end - begin;
+				spdlog::warn("{}: {} bytes skipped.", name(), left);
+				_bufferCount = 0;
 			}
+			break;
 		}
-		goOn = false;
 	}
-	// Otherwise if the buffer is not empty, add the content of the message.
-	else if (goOn)
+}
+
+// Add bytes at the end of the buffer.
+void Nmea0183FramerFiber::append(
+	const uint8_t* data,
+	size_t         size)
+{
+	// If the space that left in the buffer is not large enough to add the message, the
+	// last bytes of buffer + message are kept.
+	if (_bufferCount + size > _bufferSize)
 	{
-		// If the space that left in the buffer is not large enough to add the message, the
-		// last bytes of buffer + message are kept.
-		if (_bufferCount + message->size() > _bufferSize)
+		// Warn the user if message size is too large compared to the size of the buffer.
+		if (size > _bufferSize)
 		{
-			// Warn the user if message size is too large compared to the size of the buffer.
-			if (message->size() > _bufferSize)
-			{
-				spdlog::error("{}: the size of the buffer ({} bytes) is too small compared to the size of the message ({} bytes).", name(), _bufferSize, message->size());
-			}
+			spdlog::error("{}: the size of the buffer ({} bytes) is too small compared to the size of the message ({} bytes).", name(), _bufferSize, size);
+		}
 
-			// When the size of the message is greater or equal to the size of the buffer,
-			// the last part of the message is copied in the buffer. The current content of
-			// the buffer is lost.
-			if (message->size() >= _bufferSize)
-			{
-				auto skipped = _bufferCount + message->size() - _bufferSize;
-				spdlog::warn("{}: {} bytes skipped.", name(), skipped);
-				auto size  = _bufferSize;
-				auto start = message->payload() + message->size() - size;
-				std::memcpy(_buffer, start, size);
-				_bufferCount = size;
-			}
-			// When the size of the message is smaller than the size of the buffer,
-			// the content of the message is copied at the end of the buffer and the
-			// last part of the bytes currently in the buffer are kept.
-			else
-			{
-				auto left = _bufferSize - message->size();
-				auto lost = _bufferCount - left;
-				spdlog::warn("{}: {} bytes skipped.", name(), lost);
-				std::memmove(_buffer, _buffer + lost, left);
-				std::memcpy(_buffer + left, message->payload(), message->size());
-				_bufferCount = left + message->size();
-			}
+		// When the size of the message is greater or equal to the size of the buffer,
+		// the last part of the message is copied in the buffer. The current content of
+		// the buffer is lost.
+		if (size >= _bufferSize)
+		{
+			auto skipped = _bufferCount + size - _bufferSize;
+			spdlog::warn("{}: {} bytes skipped.", name(), skipped);
+			auto start = data + size - _bufferSize;
+			std::memcpy(_buffer, start, _bufferSize);
+			_bufferCount = _bufferSize;
 		}
-		// Otherwise simply add the content of the message.
+		// When the size of the message is smaller than the size of the buffer,
+		// the content of the message is copied at the end of the buffer and the
+		// last part of the bytes currently in the buffer are kept.
 		else
 		{
-			std::memcpy(_buffer + _bufferCount, message->payload(), message->size());
-			_bufferCount += message->size();
+			auto left = _bufferSize - size;
+			auto lost = _bufferCount - left;
+			spdlog::warn("{}: {} bytes skipped.", name(), lost);
+			std::memmove(_buffer, _buffer + lost, left);
+			std::memcpy(_buffer + left, data, size);
+			_bufferCount = left + size;
 		}
 	}
+	// Otherwise simply add the content of the message.
+	else
+	{
+		std::memcpy(_buffer + _bufferCount, data, size);
+		_bufferCount += size;
+	}
+}
 
-	// Try to extract frames from the buffer (if there is at least enough bytes).
-	if (goOn &&
-		_bufferCount > 0 &&
-		_bufferCount >= 1 + 2) // 1 = "$", 2 = "\r\n"
+// Extract the frames of the buffer.
+void Nmea0183FramerFiber::extract(
+	const synapse::framework::MessagePtr& message)
+{
+	// Nothing to do if there are not enough bytes.
+	if (_bufferCount == 0 ||
+		_bufferCount < 1 + 2) // 1 = "$", 2 = "\\r\\n")
 	{
-		auto     begin = _buffer;
-		auto     end   = _buffer + _bufferCount;
-		size_t   length{ 0 };
-		uint8_t* start{ nullptr };
+		return;
+	}
+
+	auto     begin = _buffer;
+	auto     end   = _buffer + _bufferCount;
+	size_t   length{ 0 };
+	uint8_t* start{ nullptr };
 
-		while (begin < end)
+	while (begin < end)
+	{
+		auto found = findFrame(begin, end, length, start);
+
+		if (found)
 		{
-			auto found = findFrame(begin, end, length, start);
+			// Create a message and forward it (the metadata are inherited from the
+			// message that completes the frame).
+			_outputPort->dispatch(synapse::framework::Message::create(length, found, message->metadata()));
 
-			if (found)
+			// Warn if some bytes where skipped.
+			if (found != begin)
 			{
-				// Create a message and forward it.
-				_outputPort->dispatch(std::make_shared<synapse::framework::Message>(length, found));
-
-				// Warn if some bytes where skipped.
-				if (found != begin)
-				{
-					spdlog::warn("{}: {} bytes skipped.", name(), found - begin);
-				}
-				// Adjust the new begin position for the search.
-				begin = found + length;
-				if (begin == end)
+				spdlog::warn("{}: {} bytes skipped.", name(), found - begin);
+			}
+			// Adjust the new begin position for the search.
+			begin = found + length;
+			if (begin == end)
+			{
+				_bufferCount = 0;
+			}
+		}
+		else
+		{
+			// If a start sequence is found, keep the rest in the buffer.
+			if (start != nullptr)
+			{
+				if (start != begin)
 				{
-					_bufferCount = 0;
+					spdlog::warn("{}: {} bytes skipped.", name(), start - begin);
 				}
+				std::memmove(_buffer, start, end - start);
+				_bufferCount = end - start;
 			}
+			// No start sequence found.
 			else
 			{
-				// If a start sequence is found, keep the rest in the buffer.
-				if (start != nullptr)
-				{
-					if (start != begin)
-					{
-						spdlog::warn("{}: {} bytes skipped.", name(), start - begin);
-					}
-					std::memmove(_buffer, start, end - start);
-					_bufferCount = end - start;
-				}
-				// No start sequence found.
-				else
-				{
-					// Number of bytes left in the message.
-					size_t left = end - begin;
-					spdlog::warn("{}: {} bytes skipped.", name(), left);
-					_bufferCount = 0;
-				}
-				break;
+				// Number of bytes left in the message.
+				size_t left = end - begin;
+				spdlog::warn("{}: {} bytes skipped.", name(), left);
+				_bufferCount = 0;
 			}
+			break;
 		}
 	}
 }
@@ -157,7 +157,7 @@ std::list<std::string> Nmea0183RouterFiber::ports(
 
 // Consume a message.
 void Nmea0183RouterFiber::consume(
-	const std::shared_ptr<synapse::framework::Message>& message)
+	const synapse::framework::MessagePtr& message)
 {
 	// Check if the message matches one of the routes.
 	auto port = _root->match(message->payload(), message->size());
@@ -94,11 +94,16 @@ public:
 
 public:
 
+	/// Check if the consumer accepts concurrent calls to consume().
+	///
+	/// @return true, the finding tree is not modified once initialized.
+	bool isThreadSafe() const override final { return true; }
+
 	/// Consume a message.
 	///
 	/// @param message[in] Message to be consumed.
 	void consume(
-		const std::shared_ptr<synapse::framework::Message>& message) override final;
+		const synapse::framework::MessagePtr& message) override final;
 
 	// Private definitions
 
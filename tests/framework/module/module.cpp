@@ -0,0 +1,85 @@
+///
+/// @file module.cpp
+///
+/// Module loaded by the unit testing of the Manager class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <list>
+#include <string>
+
+#include <boost/dll.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <synapse/framework/Fiber.h>
+#include <synapse/framework/Registry.h>
+
+#define API extern "C" BOOST_SYMBOL_EXPORT
+
+namespace synapse {
+namespace tests {
+
+///
+/// Fiber published by the module (discards the messages).
+///
+class ModuleFiber :
+	public synapse::framework::Fiber
+{
+	DECLARE_BLOCK(ModuleFiber)
+
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the fiber.
+	explicit ModuleFiber(
+		const std::string& name)
+		: Fiber(name)
+	{
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData&) override
+	{
+		return {};
+	}
+
+	/// Consume a message.
+	void consume(
+		const synapse::framework::MessagePtr&) override
+	{
+	}
+};
+
+IMPLEMENT_BLOCK(ModuleFiber)
+
+} // namespace tests
+} // namespace synapse
+
+/// Module entry point.
+///
+/// @param registry The registry to store the blocks published by the
+/// module.
+API void registerBlocks(
+	synapse::framework::Registry& registry)
+{
+	registry.registerDescription(synapse::tests::ModuleFiber::description());
+}
+
+/// Perpare the module's logger.
+///
+/// @param level The logger to configure.
+API void prepareLogger(
+	const std::string&        pattern,
+	spdlog::level::level_enum level)
+{
+	spdlog::set_pattern(pattern);
+	spdlog::set_level(level);
+}
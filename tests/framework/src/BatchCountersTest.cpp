@@ -0,0 +1,53 @@
+///
+/// @file BatchCountersTest.cpp
+///
+/// Unit testing of the BatchCounters class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/BatchCounters.h>
+
+namespace synapse {
+namespace framework {
+
+TEST(BatchCounters, bucketIndex)
+{
+	EXPECT_EQ(BatchCounters::bucketIndex(1), 0);
+	EXPECT_EQ(BatchCounters::bucketIndex(2), 1);
+	EXPECT_EQ(BatchCounters::bucketIndex(3), 1);
+	EXPECT_EQ(BatchCounters::bucketIndex(4), 2);
+	EXPECT_EQ(BatchCounters::bucketIndex(1000), 9);
+	EXPECT_EQ(BatchCounters::bucketIndex(size_t{ 1 } << 20), BatchCounters::BUCKET_COUNT - 1);
+}
+
+TEST(BatchCounters, record)
+{
+	BatchCounters counters;
+
+	EXPECT_EQ(counters.statistics().mean(), 0.0);
+	EXPECT_EQ(counters.statistics().toString(), "");
+
+	// Empty batches are not counted.
+	counters.record(0);
+	counters.record(1);
+	counters.record(1);
+	counters.record(3);
+	counters.record(7);
+	counters.record(size_t{ 1 } << 20);
+
+	auto statistics = counters.statistics();
+
+	EXPECT_EQ(statistics.batches, 5);
+	EXPECT_EQ(statistics.elements, 12 + (size_t{ 1 } << 20));
+	EXPECT_EQ(statistics.histogram[0], 2);
+	EXPECT_EQ(statistics.histogram[1], 1);
+	EXPECT_EQ(statistics.histogram[2], 1);
+	EXPECT_EQ(statistics.toString(), "1:2 2-3:1 4-7:1 32768+:1");
+}
+
+} // namespace framework
+} // namespace synapse
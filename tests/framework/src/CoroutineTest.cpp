@@ -0,0 +1,226 @@
+///
+/// @file CoroutineTest.cpp
+///
+/// Unit testing of the Coroutine, Completion, Mailbox and CoroutineSink classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/CoroutineBlock.h>
+#include <synapse/framework/Executor.h>
+#include <synapse/framework/Message.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Coroutine sink that records the first byte of the messages it receives.
+///
+class RecordingSink :
+	public CoroutineSink
+{
+public:
+
+	/// Constructor.
+	RecordingSink()
+		: CoroutineSink("sink")
+	{
+	}
+
+	/// The first bytes of the received messages (valid once finished).
+	std::vector<uint8_t> received;
+
+	/// Indicates that the coroutine has returned.
+	std::atomic<bool>    finished{ false };
+
+protected:
+
+	/// Body of the block.
+	Coroutine main() override
+	{
+		while (auto message = co_await receive())
+		{
+			received.push_back(message->payload()[0]);
+		}
+		finished.store(true);
+		finished.notify_all();
+	}
+};
+
+/// Coroutine that awaits a completion and stores its result.
+///
+/// @param completion The completion to await.
+/// @param result The result of the completion.
+/// @param finished Set when the coroutine returns.
+Coroutine await(
+	std::shared_ptr<Completion<int>> completion,
+	int&                             result,
+	std::atomic<bool>&               finished)
+{
+	result = co_await *completion;
+	finished.store(true);
+	finished.notify_all();
+}
+
+/// Coroutine that throws an exception.
+///
+/// @param finished Set before the exception is thrown.
+Coroutine fail(
+	std::atomic<bool>& finished)
+{
+	finished.store(true);
+	finished.notify_all();
+	throw std::runtime_error("failure");
+	co_return;
+}
+
+} // namespace
+
+TEST(Coroutine, completion)
+{
+	Executor          executor(2);
+	auto              completion = std::make_shared<Completion<int>>();
+	int               result     = 0;
+	std::atomic<bool> finished{ false };
+	auto              coroutine = await(completion, result, finished);
+
+	executor.start();
+	coroutine.start(executor);
+
+	// Complete the operation from a thread that is not in the executor.
+	std::thread([completion] { completion->set(42); }).join();
+
+	finished.wait(false);
+	executor.stop();
+
+	EXPECT_EQ(result, 42);
+	EXPECT_TRUE(coroutine.done());
+	EXPECT_EQ(coroutine.exception(), nullptr);
+}
+
+TEST(Coroutine, exception)
+{
+	Executor          executor(1);
+	std::atomic<bool> finished{ false };
+	auto              coroutine = fail(finished);
+
+	executor.start();
+	coroutine.start(executor);
+	finished.wait(false);
+	executor.stop();
+
+	EXPECT_TRUE(coroutine.done());
+	EXPECT_NE(coroutine.exception(), nullptr);
+}
+
+TEST(CoroutineSink, receive)
+{
+	constexpr uint8_t count = 200;
+
+	Executor      executor(2);
+	RecordingSink sink;
+
+	executor.start();
+	sink.start(executor);
+
+	// Post the messages from two threads, each one in order.
+	std::thread even([&sink] {
+		for (uint8_t index = 0; index < count; index += 2)
+		{
+			sink.consume(Message::create(1, &index));
+		}
+	});
+	for (uint8_t index = 1; index < count; index += 2)
+	{
+		sink.consume(Message::create(1, &index));
+	}
+	even.join();
+
+	// The coroutine returns when the mailbox is closed and drained.
+	sink.shutdown();
+	sink.finished.wait(false);
+	executor.stop();
+
+	ASSERT_EQ(sink.received.size(), count);
+
+	int lastEven = -2;
+	int lastOdd  = -1;
+
+	for (auto value : sink.received)
+	{
+		auto& last = (value % 2 == 0) ? lastEven : lastOdd;
+
+		EXPECT_EQ(value, last + 2);
+		last = value;
+	}
+	EXPECT_EQ(sink.exception(), nullptr);
+}
+
+TEST(Mailbox, overflowDrop)
+{
+	Mailbox mailbox;
+
+	mailbox.setPolicy({ 2, OverflowPolicy::dropNewest });
+	for (uint8_t index = 0; index < 4; ++index)
+	{
+		mailbox.post(Message::create(1, &index));
+	}
+	EXPECT_EQ(mailbox.size(), 2);
+	EXPECT_EQ(mailbox.overflows().dropped, 2);
+
+	// The oldest messages make room for the new ones.
+	Mailbox oldest;
+
+	oldest.setPolicy({ 2, OverflowPolicy::dropOldest });
+	for (uint8_t index = 0; index < 4; ++index)
+	{
+		oldest.post(Message::create(1, &index));
+	}
+	oldest.close();
+	EXPECT_EQ(oldest.size(), 2);
+	EXPECT_EQ(oldest.overflows().dropped, 2);
+	EXPECT_EQ(oldest.overflows().blocked, 0);
+}
+
+TEST(CoroutineSink, overflowBlock)
+{
+	constexpr uint8_t count = 200;
+
+	Executor      executor(1);
+	RecordingSink sink;
+
+	sink.setQueuePolicy({ 4, OverflowPolicy::block });
+	executor.start();
+	sink.start(executor);
+
+	// The producer waits for room: no message is lost.
+	for (uint8_t index = 0; index < count; ++index)
+	{
+		sink.consume(Message::create(1, &index));
+	}
+
+	sink.shutdown();
+	sink.finished.wait(false);
+	executor.stop();
+
+	ASSERT_EQ(sink.received.size(), count);
+	for (uint8_t index = 0; index < count; ++index)
+	{
+		EXPECT_EQ(sink.received[index], index);
+	}
+	EXPECT_EQ(sink.overflows().dropped, 0);
+}
+
+} // namespace framework
+} // namespace synapse
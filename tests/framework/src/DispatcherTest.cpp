@@ -0,0 +1,507 @@
+///
+/// @file DispatcherTest.cpp
+///
+/// Unit testing of the Dispatcher class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Dispatcher.h>
+#include <synapse/framework/Executor.h>
+#include <synapse/framework/IConsumer.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Consumer that records the messages and the threads that consume them.
+///
+class RecordingConsumer :
+	public IConsumer
+{
+public:
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		sequences[message->metadata().origin].push_back(message->metadata().sequence);
+		origins.push_back(message->metadata().origin);
+		threads[message->metadata().origin].insert(std::this_thread::get_id());
+		++count;
+	}
+
+	/// The sequence numbers received from each port.
+	std::map<uint32_t, std::vector<uint32_t>>     sequences;
+
+	/// The ports of the messages, in the order of consumption.
+	std::vector<uint32_t>                         origins;
+
+	/// The threads that consumed the messages of each port.
+	std::map<uint32_t, std::set<std::thread::id>> threads;
+
+	/// The number of messages consumed.
+	std::atomic<size_t>                           count{ 0 };
+
+private:
+
+	/// The mutex to protect the records.
+	std::mutex                                    _mutex;
+};
+
+} // namespace
+
+TEST(Dispatcher, threadCount)
+{
+	EXPECT_EQ(Dispatcher("single").threadCount(), 1);
+	EXPECT_EQ(Dispatcher("multiple", 4).threadCount(), 4);
+	EXPECT_THROW(Dispatcher("none", 0), std::invalid_argument);
+}
+
+TEST(Dispatcher, overflow)
+{
+	Port              port("port", nullptr, 1);
+	RecordingConsumer consumer;
+
+	// The requests are queued but not processed until the dispatcher runs.
+	auto fill = [&](Dispatcher& dispatcher) {
+		Route route({ &port }, { &consumer }, &dispatcher);
+
+		for (size_t index = 0; index < 6; ++index)
+		{
+			dispatcher.dispatch(Message::create(0), port, route);
+		}
+	};
+
+	Dispatcher dropNewest("drop-newest", 1, { 4, OverflowPolicy::dropNewest });
+
+	fill(dropNewest);
+	EXPECT_EQ(dropNewest.overflows().dropped, 2);
+
+	Dispatcher dropOldest("drop-oldest", 1, { 4, OverflowPolicy::dropOldest });
+
+	fill(dropOldest);
+	EXPECT_EQ(dropOldest.overflows().dropped, 2);
+
+	EXPECT_THROW(Dispatcher("empty", 1, { 0, OverflowPolicy::block }), std::invalid_argument);
+}
+
+namespace {
+
+/// Dispatch messages from several ports and check the order of each port.
+///
+/// @param dispatcher The dispatcher to test (3 workers).
+/// @param dedicated Indicates that each worker has its own thread.
+/// @param start Start the processing of the requests.
+/// @param stop Stop the processing of the requests.
+template <typename Start, typename Stop>
+void checkOrdering(
+	Dispatcher& dispatcher,
+	bool        dedicated,
+	Start       start,
+	Stop        stop)
+{
+	static const size_t PORT_COUNT    = 6;
+	static const size_t MESSAGE_COUNT = 1000;
+
+	RecordingConsumer                consumer;
+	std::list<std::unique_ptr<Port>> ports;
+	std::list<Port*>                 sources;
+
+	for (size_t index = 0; index < PORT_COUNT; ++index)
+	{
+		sources.push_back(ports.emplace_back(std::make_unique<Port>("port", nullptr, static_cast<uint32_t>(index + 1))).get());
+	}
+
+	Route route(sources, { &consumer }, &dispatcher);
+
+	for (auto& port : ports)
+	{
+		port->attach(&route);
+	}
+
+	start();
+
+	for (size_t index = 0; index < MESSAGE_COUNT; ++index)
+	{
+		for (auto& port : ports)
+		{
+			port->dispatch(Message::create(0));
+		}
+	}
+	while (consumer.count.load() < PORT_COUNT * MESSAGE_COUNT)
+	{
+		std::this_thread::yield();
+	}
+	stop();
+
+	// The messages of a port are consumed in order. With dedicated threads,
+	// they are consumed by a single thread and the ports are spread over the
+	// threads.
+	std::set<std::thread::id> threads;
+
+	for (uint32_t origin = 1; origin <= PORT_COUNT; ++origin)
+	{
+		ASSERT_EQ(consumer.sequences[origin].size(), MESSAGE_COUNT);
+		for (size_t index = 0; index < MESSAGE_COUNT; ++index)
+		{
+			EXPECT_EQ(consumer.sequences[origin][index], index + 1);
+		}
+		if (dedicated)
+		{
+			EXPECT_EQ(consumer.threads[origin].size(), 1);
+		}
+		threads.insert(consumer.threads[origin].begin(), consumer.threads[origin].end());
+	}
+	if (dedicated)
+	{
+		EXPECT_EQ(threads.size(), 3);
+	}
+	EXPECT_EQ(dispatcher.statistics().elements, PORT_COUNT * MESSAGE_COUNT);
+}
+
+} // namespace
+
+TEST(Dispatcher, ordering)
+{
+	Dispatcher  dispatcher("dispatcher", 3);
+	std::thread runner;
+
+	checkOrdering(
+		dispatcher,
+		true,
+		[&] { runner = std::thread([&dispatcher] { dispatcher.run(); }); },
+		[&] {
+			dispatcher.shutdown();
+			runner.join();
+		});
+}
+
+TEST(Dispatcher, spinThenPark)
+{
+	Dispatcher  dispatcher("dispatcher", 3);
+	std::thread runner;
+
+	// The workers poll their ring before sleeping.
+	dispatcher.setWaitStrategy({ WaitMode::spinThenPark, 100 });
+	checkOrdering(
+		dispatcher,
+		true,
+		[&] { runner = std::thread([&dispatcher] { dispatcher.run(); }); },
+		[&] {
+			dispatcher.shutdown();
+			runner.join();
+		});
+}
+
+namespace {
+
+/// Queue messages on a low, a normal and a high priority route, then run the
+/// dispatcher until they are consumed.
+///
+/// @param dispatcher The dispatcher to test (1 worker).
+/// @param consumer The consumer of the routes.
+/// @param counts The number of messages per priority (high, normal, low).
+void dispatchByPriority(
+	Dispatcher&                  dispatcher,
+	RecordingConsumer&           consumer,
+	const std::array<size_t, 3>& counts)
+{
+	std::list<std::unique_ptr<Port>>  ports;
+	std::list<std::unique_ptr<Route>> routes;
+
+	for (size_t priority = 0; priority < counts.size(); ++priority)
+	{
+		auto& port  = ports.emplace_back(std::make_unique<Port>("port", nullptr, static_cast<uint32_t>(priority + 1)));
+		auto& route = routes.emplace_back(std::make_unique<Route>(std::list<Port*>{ port.get() }, std::list<IConsumer*>{ &consumer }, &dispatcher));
+
+		route->setPriority(static_cast<RoutePriority>(priority));
+		port->attach(route.get());
+	}
+
+	// Queue the lowest priorities first.
+	for (size_t priority = counts.size(); priority-- > 0;)
+	{
+		auto& port = *std::next(ports.begin(), static_cast<ptrdiff_t>(priority));
+
+		for (size_t index = 0; index < counts[priority]; ++index)
+		{
+			port->dispatch(Message::create(0));
+		}
+	}
+
+	std::thread runner([&dispatcher] { dispatcher.run(); });
+
+	while (consumer.count.load() < counts[0] + counts[1] + counts[2])
+	{
+		std::this_thread::yield();
+	}
+	dispatcher.shutdown();
+	runner.join();
+}
+
+} // namespace
+
+TEST(Dispatcher, priority)
+{
+	Dispatcher        dispatcher("dispatcher");
+	RecordingConsumer consumer;
+
+	dispatchByPriority(dispatcher, consumer, { 3, 10, 1000 });
+
+	// The high priority requests are served first, then the normal ones.
+	std::vector<uint32_t> expected(3, 1);
+
+	expected.insert(expected.end(), 10, 2);
+	expected.insert(expected.end(), 1000, 3);
+	EXPECT_EQ(consumer.origins, expected);
+
+	auto lanes = dispatcher.lanes();
+
+	EXPECT_EQ(lanes[0].processed, 3);
+	EXPECT_EQ(lanes[1].processed, 10);
+	EXPECT_EQ(lanes[2].processed, 1000);
+	EXPECT_EQ(lanes[2].depth, 0);
+	EXPECT_GE(lanes[2].maxWait, lanes[0].maxWait);
+}
+
+TEST(Dispatcher, starvation)
+{
+	Dispatcher        dispatcher("dispatcher");
+	RecordingConsumer consumer;
+
+	// The low lane is served after the normal one has been served twice.
+	dispatcher.setStarvationLimit(2);
+	dispatchByPriority(dispatcher, consumer, { 0, 3 * Dispatcher::SLICE_SIZE, 10 });
+
+	std::vector<uint32_t> expected(2 * Dispatcher::SLICE_SIZE, 2);
+
+	expected.insert(expected.end(), 10, 3);
+	expected.insert(expected.end(), Dispatcher::SLICE_SIZE, 2);
+	EXPECT_EQ(consumer.origins, expected);
+	EXPECT_EQ(dispatcher.lanes()[2].promoted, 1);
+}
+
+TEST(Dispatcher, executor)
+{
+	Dispatcher dispatcher("dispatcher", 3);
+	Executor   executor(3);
+
+	// The workers are scheduled by the executor, run() is not called.
+	dispatcher.setExecutor(&executor);
+	checkOrdering(
+		dispatcher,
+		false,
+		[&] { executor.start(); },
+		[&] {
+			dispatcher.shutdown();
+			executor.stop();
+		});
+}
+
+TEST(Dispatcher, blockOnExecutor)
+{
+	///
+	/// Task that dispatches messages from a thread of the executor.
+	///
+	struct Producer :
+		public ITask
+	{
+		explicit Producer(
+			Port& port)
+			: port(port)
+		{
+		}
+
+		void execute() override
+		{
+			for (uint32_t index = 0; index < 100; ++index)
+			{
+				port.dispatch(Message::create(sizeof(index), reinterpret_cast<const uint8_t*>(&index)));
+			}
+		}
+
+		Port& port;
+	};
+
+	Executor          executor(1);
+	Dispatcher        dispatcher("dispatcher", 1, { 1, OverflowPolicy::block });
+	RecordingConsumer consumer;
+	Port              port("port", nullptr, 1);
+	Route             route({ &port }, { &consumer }, &dispatcher);
+	Producer          producer(port);
+
+	// The producer and the worker share the single thread of the executor: the
+	// producer cannot wait for room in the queue of the worker.
+	dispatcher.setExecutor(&executor);
+	port.attach(&route);
+	executor.start();
+	executor.submit(producer);
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (consumer.count < 100 && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+	dispatcher.shutdown();
+	executor.stop();
+
+	EXPECT_EQ(consumer.count, 100);
+	EXPECT_EQ(consumer.sequences[1].size(), 100);
+	EXPECT_GT(dispatcher.overflows().blocked, 0);
+}
+
+
+namespace {
+
+///
+/// Fiber that emits several slices of each message it consumes (like a framer).
+///
+class SlicingFiber :
+	public IConsumer
+{
+public:
+
+	/// Number of slices emitted per message.
+	static constexpr size_t SLICE_COUNT = 10;
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		for (size_t index = 0; index < SLICE_COUNT; ++index)
+		{
+			auto slice = Message::slice(message, index, 1);
+
+			// The slices are stamped by the port of the fiber.
+			slice->metadata().origin = 0;
+			port.dispatch(slice);
+		}
+	}
+
+	/// The port of the slices.
+	Port port{ "output", nullptr, 100 };
+};
+
+/// Run a fiber that emits on a route of the dispatcher that feeds it.
+///
+/// @param dispatcher The dispatcher to test (1 worker, capacity 8).
+/// @param start Start the processing of the requests.
+/// @param stop Stop the processing of the requests.
+///
+/// @return The number of slices consumed.
+template <typename Start, typename Stop>
+size_t dispatchToItself(
+	Dispatcher& dispatcher,
+	Start       start,
+	Stop        stop)
+{
+	static const size_t INPUT_COUNT = 8;
+
+	RecordingConsumer                consumer;
+	SlicingFiber                     fiber;
+	std::list<std::unique_ptr<Port>> ports;
+	std::list<Port*>                 sources;
+
+	for (size_t index = 0; index < INPUT_COUNT; ++index)
+	{
+		sources.push_back(ports.emplace_back(std::make_unique<Port>("input", nullptr, static_cast<uint32_t>(index + 1))).get());
+	}
+
+	Route inputs(sources, { &fiber }, &dispatcher);
+	Route outputs({ &fiber.port }, { &consumer }, &dispatcher);
+
+	for (auto& port : ports)
+	{
+		port->attach(&inputs);
+	}
+	fiber.port.attach(&outputs);
+
+	// Fill the ring before the worker runs.
+	for (auto& port : ports)
+	{
+		port->dispatch(Message::create(SlicingFiber::SLICE_COUNT));
+	}
+	start();
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (consumer.count < INPUT_COUNT * SlicingFiber::SLICE_COUNT && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+	stop();
+
+	// The slices are consumed in the order of emission.
+	auto& sequences = consumer.sequences[fiber.port.id()];
+
+	for (size_t index = 0; index < sequences.size(); ++index)
+	{
+		EXPECT_EQ(sequences[index], index + 1);
+	}
+
+	return consumer.count;
+}
+
+} // namespace
+
+TEST(Dispatcher, reentrant)
+{
+	// A worker that finds its own ring full does not wait for itself.
+	Dispatcher  dedicated("dedicated", 1, { 8, OverflowPolicy::block });
+	std::thread runner;
+
+	EXPECT_EQ(dispatchToItself(
+				  dedicated,
+				  [&] { runner = std::thread([&dedicated] { dedicated.run(); }); },
+				  [&] {
+					  dedicated.shutdown();
+					  runner.join();
+				  }),
+			  80);
+	EXPECT_EQ(dedicated.lanes()[1].depth, 0);
+
+	// Nor does a worker scheduled by an executor.
+	Dispatcher scheduled("scheduled", 1, { 8, OverflowPolicy::block });
+	Executor   executor(1);
+
+	scheduled.setExecutor(&executor);
+	EXPECT_EQ(dispatchToItself(
+				  scheduled,
+				  [&] { executor.start(); },
+				  [&] {
+					  scheduled.shutdown();
+					  executor.stop();
+				  }),
+			  80);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,104 @@
+///
+/// @file ExecutorTest.cpp
+///
+/// Unit testing of the Executor class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Executor.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Task that submits itself again until it has been executed a given number
+/// of times.
+///
+class CountingTask :
+	public ITask
+{
+public:
+
+	/// Constructor.
+	///
+	/// @param executor The executor of the task.
+	/// @param count The number of executions.
+	CountingTask(
+		Executor& executor,
+		size_t    count)
+		: _executor(executor),
+		  _remaining(count)
+	{
+	}
+
+	/// Process the pending work of the task.
+	void execute() override
+	{
+		++executed;
+		if (--_remaining > 0)
+		{
+			_executor.submit(*this);
+		}
+	}
+
+	/// The number of executions.
+	std::atomic<size_t> executed{ 0 };
+
+private:
+
+	/// The executor of the task.
+	Executor& _executor;
+
+	/// The number of executions still to be performed.
+	size_t    _remaining;
+};
+
+} // namespace
+
+TEST(Executor, threadCount)
+{
+	EXPECT_EQ(Executor(3).threadCount(), 3);
+	EXPECT_GE(Executor().threadCount(), 1);
+}
+
+TEST(Executor, execute)
+{
+	static const size_t TASK_COUNT      = 50;
+	static const size_t EXECUTION_COUNT = 100;
+
+	Executor                                   executor(4);
+	std::vector<std::unique_ptr<CountingTask>> tasks;
+
+	executor.start();
+
+	// The tasks are submitted from outside and from the threads of the pool.
+	for (size_t index = 0; index < TASK_COUNT; ++index)
+	{
+		tasks.push_back(std::make_unique<CountingTask>(executor, EXECUTION_COUNT));
+		executor.submit(*tasks.back());
+	}
+	for (auto& task : tasks)
+	{
+		while (task->executed.load() < EXECUTION_COUNT)
+		{
+			std::this_thread::yield();
+		}
+	}
+	executor.stop();
+
+	EXPECT_EQ(executor.statistics().executed, TASK_COUNT * EXECUTION_COUNT);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,636 @@
+///
+/// @file ManagerTest.cpp
+///
+/// Unit testing of the Manager class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <synapse/framework/Fiber.h>
+#include <synapse/framework/Manager.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Registry.h>
+#include <synapse/framework/Route.h>
+#include <synapse/framework/Sink.h>
+#include <synapse/framework/Source.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Fiber that forwards the messages on its port (not thread-safe).
+///
+class ForwardFiber :
+	public Fiber
+{
+	DECLARE_BLOCK(ForwardFiber)
+
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the fiber.
+	explicit ForwardFiber(
+		const std::string& name)
+		: Fiber(name)
+	{
+	}
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData& configData,
+		IManager*         manager) override
+	{
+		Fiber::initialize(configData, manager);
+		_output = manager->find(this, "out");
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData& configData) override
+	{
+		(void) configData; // Unused parameter.
+
+		return { "out" };
+	}
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		_output->dispatch(message);
+	}
+
+private:
+
+	/// The output port.
+	IPort* _output{ nullptr };
+};
+
+IMPLEMENT_BLOCK(ForwardFiber)
+
+///
+/// Fiber that forwards the messages on its port (thread-safe).
+///
+class SharedFiber :
+	public ForwardFiber
+{
+	DECLARE_BLOCK(SharedFiber)
+
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the fiber.
+	explicit SharedFiber(
+		const std::string& name)
+		: ForwardFiber(name)
+	{
+	}
+
+	/// Check if the consumer accepts concurrent calls to consume().
+	bool isThreadSafe() const override { return true; }
+};
+
+IMPLEMENT_BLOCK(SharedFiber)
+
+///
+/// Fiber that records its initialization.
+///
+class InitFiber :
+	public ForwardFiber
+{
+	DECLARE_BLOCK(InitFiber)
+
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the fiber.
+	explicit InitFiber(
+		const std::string& name)
+		: ForwardFiber(name)
+	{
+	}
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData& configData,
+		IManager*         manager) override
+	{
+		ForwardFiber::initialize(configData, manager);
+
+		std::lock_guard lock(mutex);
+
+		initialized.push_back(name());
+		threads.insert(std::this_thread::get_id());
+	}
+
+	/// Protect the records.
+	static inline std::mutex                mutex;
+
+	/// The names of the fibers in the order of their initialization.
+	static inline std::vector<std::string>  initialized;
+
+	/// The threads that initialized the fibers.
+	static inline std::set<std::thread::id> threads;
+};
+
+IMPLEMENT_BLOCK(InitFiber)
+
+///
+/// Source that emits a fixed number of messages on its port.
+///
+class CountingSource :
+	public Source
+{
+	DECLARE_BLOCK(CountingSource)
+
+public:
+
+	/// Number of messages emitted by the source.
+	static constexpr size_t COUNT{ 100 };
+
+	/// Constructor.
+	///
+	/// @param name The name of the source.
+	explicit CountingSource(
+		const std::string& name)
+		: Source(name)
+	{
+	}
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData& configData,
+		IManager*         manager) override
+	{
+		Source::initialize(configData, manager);
+		_output = manager->find(this, "out");
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData& configData) override
+	{
+		(void) configData; // Unused parameter.
+
+		return { "out" };
+	}
+
+	/// Emit the messages.
+	void run() override
+	{
+		for (size_t index = 0; index < COUNT; ++index)
+		{
+			uint8_t value = static_cast<uint8_t>(index);
+
+			_output->dispatch(Message::create(1, &value));
+		}
+	}
+
+private:
+
+	/// The output port.
+	IPort* _output{ nullptr };
+};
+
+IMPLEMENT_BLOCK(CountingSource)
+
+///
+/// Sink that records the threads that process its messages.
+///
+class ThreadSink :
+	public Sink
+{
+	DECLARE_BLOCK(ThreadSink)
+
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the sink.
+	explicit ThreadSink(
+		const std::string& name)
+		: Sink(name)
+	{
+	}
+
+	/// Get the threads that have processed the messages.
+	std::set<std::thread::id> threads()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		return _threads;
+	}
+
+	/// The number of processed messages.
+	std::atomic<size_t> processed{ 0 };
+
+protected:
+
+	/// Process a message.
+	///
+	/// @param message[in] Message to be processed.
+	void process(
+		const MessagePtr& message) override
+	{
+		(void) message; // Unused parameter.
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			_threads.insert(std::this_thread::get_id());
+		}
+		processed.fetch_add(1);
+	}
+
+private:
+
+	/// The mutex to protect the threads.
+	std::mutex                _mutex;
+
+	/// The threads that have processed the messages.
+	std::set<std::thread::id> _threads;
+};
+
+IMPLEMENT_BLOCK(ThreadSink)
+
+/// Get the description of a block in a configuration.
+///
+/// @param name The name of the block.
+/// @param className The class of the block.
+///
+/// @return The description of the block.
+nlohmann::json block(
+	const std::string& name,
+	const std::string& className)
+{
+	return { { "name", name }, { "className", className }, { "config", nlohmann::json::object() } };
+}
+
+/// Get the description of a route in a configuration.
+///
+/// @param sources The source ports.
+/// @param destinations The destination blocks.
+/// @param dispatch The dispatch mode.
+///
+/// @return The description of the route.
+nlohmann::json route(
+	const std::list<std::string>& sources,
+	const std::list<std::string>& destinations,
+	const std::string&            dispatch = "queued")
+{
+	return { { "sources", sources }, { "destinations", destinations }, { "dispatch", dispatch } };
+}
+
+/// Initialize a manager with the test blocks registered.
+///
+/// @param manager The manager.
+/// @param config The configuration data.
+void initialize(
+	Manager&              manager,
+	const nlohmann::json& config)
+{
+	manager.registry().registerDescription(ForwardFiber::description());
+	manager.registry().registerDescription(SharedFiber::description());
+	manager.registry().registerDescription(InitFiber::description());
+	manager.registry().registerDescription(CountingSource::description());
+	manager.registry().registerDescription(ThreadSink::description());
+	manager.initialize(config);
+}
+
+/// Get the reason why a configuration is rejected.
+///
+/// @param config The configuration data.
+///
+/// @return The message of the error, empty if the configuration is accepted.
+std::string rejection(
+	const nlohmann::json& config)
+{
+	Manager manager;
+
+	try
+	{
+		initialize(manager, config);
+	}
+	catch (const std::runtime_error& e)
+	{
+		return e.what();
+	}
+
+	return std::string();
+}
+
+/// Check if the route of a port has been fused by the execution plan.
+///
+/// @param config The configuration data.
+/// @param block The name of the block of the port.
+///
+/// @return true if the (single) route of the port "out" of the block is fused.
+bool fused(
+	const nlohmann::json& config,
+	const std::string&    block)
+{
+	Manager manager;
+
+	initialize(manager, config);
+
+	auto port = dynamic_cast<Port*>(manager.find(manager.find(block), "out"));
+
+	return port->routes().front()->isFused();
+}
+
+/// Class name of the fiber that is not thread-safe.
+const std::string FORWARD = ForwardFiber::description()._className;
+
+/// Class name of the thread-safe fiber.
+const std::string SHARED = SharedFiber::description()._className;
+
+/// Class name of the fiber that records its initialization.
+const std::string INIT = InitFiber::description()._className;
+
+/// Class name of the fiber of the test module.
+const std::string MODULE_FIBER = "synapse::tests::ModuleFiber";
+
+/// Class name of the source.
+const std::string SOURCE = CountingSource::description()._className;
+
+/// Class name of the sink.
+const std::string SINK = ThreadSink::description()._className;
+
+/// Copy the test module into a folder of its own, with a manifest.
+///
+/// @param test The name of the test.
+/// @param blocks The classes listed by the manifest (no manifest if null).
+///
+/// @return The folder of the module.
+std::filesystem::path installModule(
+	const std::string&    test,
+	const nlohmann::json& blocks)
+{
+	std::filesystem::path module{ SYNAPSE_TEST_MODULE };
+	auto                  folder = std::filesystem::temp_directory_path() / ("synapse-test-" + test);
+
+	std::filesystem::remove_all(folder);
+	std::filesystem::create_directories(folder);
+	std::filesystem::copy_file(module, folder / module.filename());
+
+	if (!blocks.is_null())
+	{
+		auto manifest = folder / module.filename();
+
+		manifest.replace_extension(Registry::MANIFEST_EXTENSION);
+		std::ofstream(manifest) << nlohmann::json{ { "blocks", blocks } }.dump();
+	}
+
+	return folder;
+}
+
+/// Check if the test module is loaded by a configuration.
+///
+/// @param folder The folder of the module.
+/// @param className The class of the block of the configuration.
+///
+/// @return true if the class of the test module is registered.
+bool moduleLoaded(
+	const std::filesystem::path& folder,
+	const std::string&           className)
+{
+	Manager manager;
+
+	initialize(manager, { { "additionalPackageFolders", { folder.string() } },
+						  { "blocks", { block("block", className) } },
+						  { "routes", nlohmann::json::array() } });
+
+	return manager.registry().contains(MODULE_FIBER);
+}
+
+} // namespace
+
+TEST(Manager, inlineCycle)
+{
+	// The inline routes shall not form a cycle.
+	EXPECT_NE(rejection({ { "blocks", { block("a", FORWARD), block("b", FORWARD) } },
+						  { "routes", { route({ "a" }, { "b" }, "inline"), route({ "b" }, { "a" }, "inline") } } })
+				  .find("cycle"),
+			  std::string::npos);
+	EXPECT_NE(rejection({ { "blocks", { block("a", FORWARD), block("b", SHARED), block("c", FORWARD) } },
+						  { "routes", { route({ "a" }, { "b" }, "inline"), route({ "b" }, { "c" }, "inline"), route({ "c" }, { "b" }, "inline") } } })
+				  .find("cycle"),
+			  std::string::npos);
+
+	// A cycle broken by a queued route and an inline chain are accepted.
+	EXPECT_EQ(rejection({ { "blocks", { block("a", FORWARD), block("b", FORWARD) } },
+						  { "routes", { route({ "a" }, { "b" }, "inline"), route({ "b" }, { "a" }) } } }),
+			  "");
+	EXPECT_EQ(rejection({ { "blocks", { block("a", FORWARD), block("b", FORWARD), block("c", FORWARD) } },
+						  { "routes", { route({ "a" }, { "b" }, "inline"), route({ "b" }, { "c" }, "inline") } } }),
+			  "");
+}
+
+TEST(Manager, inlineThreadSafety)
+{
+	// A consumer that is not thread-safe cannot be fed by several ports when
+	// one of its routes is inline.
+	EXPECT_NE(rejection({ { "blocks", { block("a", FORWARD), block("b", FORWARD), block("c", FORWARD) } },
+						  { "routes", { route({ "a" }, { "c" }, "inline"), route({ "b" }, { "c" }) } } })
+				  .find("not thread-safe"),
+			  std::string::npos);
+	EXPECT_NE(rejection({ { "blocks", { block("a", FORWARD), block("b", FORWARD), block("c", FORWARD) } },
+						  { "routes", { route({ "a", "b" }, { "c" }, "inline") } } })
+				  .find("not thread-safe"),
+			  std::string::npos);
+
+	// A thread-safe consumer can, a consumer fed by a single port too.
+	EXPECT_EQ(rejection({ { "blocks", { block("a", FORWARD), block("b", FORWARD), block("c", SHARED) } },
+						  { "routes", { route({ "a", "b" }, { "c" }, "inline") } } }),
+			  "");
+	EXPECT_EQ(rejection({ { "blocks", { block("a", FORWARD), block("c", FORWARD) } },
+						  { "routes", { route({ "a" }, { "c" }, "inline"), route({ "c" }, { "a" }) } } }),
+			  "");
+}
+
+TEST(Manager, fuse)
+{
+	// A chain of fibers fed by a source, the route between the fibers has no
+	// option.
+	nlohmann::json chain{ { "blocks", { block("source", SOURCE), block("a", FORWARD), block("b", FORWARD) } },
+						  { "routes", { route({ "source" }, { "a" }), route({ "a" }, { "b" }) } } };
+
+	chain["routes"][1].erase("dispatch");
+
+	// The route is fused only when the configuration asks for it.
+	EXPECT_FALSE(fused(chain, "a"));
+	chain["plan"] = { { "fuse", false } };
+	EXPECT_FALSE(fused(chain, "a"));
+	chain["plan"] = { { "fuse", true } };
+	EXPECT_TRUE(fused(chain, "a"));
+}
+
+TEST(Manager, doNotFuse)
+{
+	nlohmann::json chain{ { "plan", { { "fuse", true } } },
+						  { "blocks", { block("source", SOURCE), block("a", FORWARD), block("b", FORWARD) } },
+						  { "routes", { route({ "source" }, { "a" }), route({ "a" }, { "b" }) } } };
+
+	// A route with an option of its dispatcher is kept.
+	EXPECT_FALSE(fused(chain, "a"));
+
+	// A fiber fed by two ports is kept behind its queue.
+	chain["blocks"].push_back(block("c", FORWARD));
+	chain["routes"].push_back(route({ "source" }, { "c" }));
+	chain["routes"].push_back(route({ "c" }, { "b" }));
+	chain["routes"][1].erase("dispatch");
+	chain["routes"][3].erase("dispatch");
+	EXPECT_FALSE(fused(chain, "a"));
+	EXPECT_FALSE(fused(chain, "c"));
+}
+
+TEST(Manager, executorGroups)
+{
+	// Two sinks in the group "one", one sink in the group "two".
+	auto first  = block("first", SINK);
+	auto second = block("second", SINK);
+	auto third  = block("third", SINK);
+
+	first["executor"]  = "one";
+	second["executor"] = "one";
+	third["executor"]  = "two";
+
+	Manager manager;
+
+	initialize(manager, { { "blocks", { block("source", SOURCE), first, second, third } },
+						  { "routes", { route({ "source" }, { "first", "second", "third" }) } } });
+
+	std::thread runner([&manager] { manager.run(); });
+	auto        deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	auto        sink     = [&manager](const std::string& name) { return dynamic_cast<ThreadSink*>(manager.find(name)); };
+
+	for (auto name : { "first", "second", "third" })
+	{
+		while (sink(name)->processed.load() < CountingSource::COUNT && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	// The blocks are destroyed when the manager stops.
+	auto one    = sink("first")->threads();
+	auto oneBis = sink("second")->threads();
+	auto two    = sink("third")->threads();
+
+	manager.shutdown();
+	runner.join();
+
+	// The blocks of a group share the single thread of the group, the groups
+	// do not share their threads.
+	ASSERT_EQ(one.size(), 1);
+	ASSERT_EQ(two.size(), 1);
+	EXPECT_EQ(oneBis, one);
+	EXPECT_NE(*one.begin(), *two.begin());
+}
+
+TEST(Manager, startupThreads)
+{
+	nlohmann::json config{ { "blocks", { block("a", INIT), block("b", INIT), block("c", INIT), block("d", INIT) } },
+						   { "routes", { route({ "a" }, { "b", "c", "d" }) } } };
+
+	// The blocks are initialized one after the other, in the order of the
+	// configuration, by the thread of the manager.
+	{
+		Manager manager;
+
+		InitFiber::initialized.clear();
+		InitFiber::threads.clear();
+		initialize(manager, config);
+		EXPECT_EQ(InitFiber::initialized, std::vector<std::string>({ "a", "b", "c", "d" }));
+		EXPECT_EQ(InitFiber::threads, std::set<std::thread::id>({ std::this_thread::get_id() }));
+	}
+
+	// More startup threads initialize them concurrently.
+	{
+		Manager manager;
+
+		config["startup"] = { { "threads", 4 } };
+		InitFiber::initialized.clear();
+		initialize(manager, config);
+		EXPECT_EQ(std::set<std::string>(InitFiber::initialized.begin(), InitFiber::initialized.end()), std::set<std::string>({ "a", "b", "c", "d" }));
+	}
+
+	config["startup"] = { { "threads", -1 } };
+	EXPECT_NE(rejection(config).find("startup threads"), std::string::npos);
+}
+
+TEST(Manager, manifest)
+{
+	auto folder = installModule("manifest", { MODULE_FIBER });
+
+	// The module is loaded only when the configuration uses one of its classes.
+	EXPECT_TRUE(moduleLoaded(folder, MODULE_FIBER));
+	EXPECT_FALSE(moduleLoaded(folder, FORWARD));
+
+	std::filesystem::remove_all(folder);
+}
+
+TEST(Manager, missingManifest)
+{
+	auto folder = installModule("missing-manifest", nullptr);
+
+	// A module without manifest is always loaded.
+	EXPECT_TRUE(moduleLoaded(folder, MODULE_FIBER));
+	EXPECT_TRUE(moduleLoaded(folder, FORWARD));
+
+	std::filesystem::remove_all(folder);
+}
+
+TEST(Manager, staleManifest)
+{
+	auto folder = installModule("stale-manifest", { "synapse::tests::RemovedFiber" });
+
+	// The class is not in the manifest: the module is skipped, then loaded
+	// when the class is not found in the other modules.
+	EXPECT_TRUE(moduleLoaded(folder, MODULE_FIBER));
+	EXPECT_FALSE(moduleLoaded(folder, FORWARD));
+
+	std::filesystem::remove_all(folder);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,144 @@
+///
+/// @file MessagePoolTest.cpp
+///
+/// Unit testing of the MessagePool class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Message.h>
+#include <synapse/framework/MessagePool.h>
+
+namespace synapse {
+namespace framework {
+
+TEST(MessagePool, classIndex)
+{
+	EXPECT_EQ(MessagePool::classIndex(0), 0);
+	EXPECT_EQ(MessagePool::classIndex(1), 0);
+	EXPECT_EQ(MessagePool::classIndex(64), 0);
+	EXPECT_EQ(MessagePool::classIndex(65), 1);
+	EXPECT_EQ(MessagePool::classIndex(128), 1);
+	EXPECT_EQ(MessagePool::classIndex(129), 2);
+	EXPECT_EQ(MessagePool::classIndex(1024), 4);
+	EXPECT_EQ(MessagePool::classIndex(MessagePool::MAX_BLOCK_SIZE), MessagePool::CLASS_COUNT - 1);
+	EXPECT_EQ(MessagePool::classIndex(MessagePool::MAX_BLOCK_SIZE + 1), MessagePool::CLASS_COUNT);
+}
+
+TEST(MessagePool, reuse)
+{
+	auto& pool  = MessagePool::instance();
+	auto  first = pool.allocate(82);
+
+	pool.release(first, 82);
+
+	// A block of the same size class is served by the thread cache.
+	auto before = pool.statistics();
+	auto second = pool.allocate(100);
+	auto after  = pool.statistics();
+
+	EXPECT_EQ(second, first);
+	EXPECT_EQ(after.hits, before.hits + 1);
+	EXPECT_EQ(after.misses, before.misses);
+
+	pool.release(second, 100);
+
+	// Requests larger than the largest size class are served by the heap.
+	before     = pool.statistics();
+	auto large = pool.allocate(MessagePool::MAX_BLOCK_SIZE + 1);
+	after      = pool.statistics();
+
+	EXPECT_EQ(after.misses, before.misses + 1);
+	EXPECT_EQ(after.oversized, before.oversized + 1);
+
+	pool.release(large, MessagePool::MAX_BLOCK_SIZE + 1);
+}
+
+TEST(MessagePool, threads)
+{
+	auto&                 pool = MessagePool::instance();
+	std::vector<uint8_t*> blocks;
+
+	// Blocks released by a terminated thread are given back to the depot.
+	std::thread producer([&pool, &blocks] {
+		for (size_t index = 0; index < MessagePool::CACHE_CAPACITY; ++index)
+		{
+			blocks.push_back(pool.allocate(MessagePool::MAX_BLOCK_SIZE));
+		}
+		for (auto block : blocks)
+		{
+			pool.release(block, MessagePool::MAX_BLOCK_SIZE);
+		}
+	});
+	producer.join();
+
+	auto before = pool.statistics();
+	auto block  = pool.allocate(MessagePool::MAX_BLOCK_SIZE);
+	auto after  = pool.statistics();
+
+	EXPECT_NE(std::find(blocks.begin(), blocks.end(), block), blocks.end());
+	EXPECT_EQ(after.hits, before.hits + 1);
+
+	pool.release(block, MessagePool::MAX_BLOCK_SIZE);
+}
+
+TEST(MessagePool, threadTeardown)
+{
+	///
+	/// Holder of a block released when its thread terminates.
+	///
+	struct Holder
+	{
+		~Holder()
+		{
+			MessagePool::instance().release(block, MessagePool::MIN_BLOCK_SIZE);
+			MessagePool::instance().release(MessagePool::instance().allocate(MessagePool::MIN_BLOCK_SIZE), MessagePool::MIN_BLOCK_SIZE);
+		}
+
+		uint8_t* block{ nullptr };
+	};
+
+	auto before = MessagePool::instance().statistics();
+
+	// The holder is created before the cache of the thread, it is destroyed
+	// after it: the blocks go through the depot.
+	std::thread thread([] {
+		thread_local Holder holder;
+
+		holder.block = MessagePool::instance().allocate(MessagePool::MIN_BLOCK_SIZE);
+	});
+	thread.join();
+
+	auto after = MessagePool::instance().statistics();
+
+	EXPECT_EQ((after.hits + after.misses) - (before.hits + before.misses), 2);
+}
+
+TEST(MessagePool, message)
+{
+	auto&       pool   = MessagePool::instance();
+	std::string data   = std::string(82, '$');
+	auto        before = pool.statistics();
+
+	// The payloads of the messages built with the constructors are obtained
+	// from the pool.
+	for (size_t index = 0; index < 100; ++index)
+	{
+		Message message(data.size(), reinterpret_cast<const uint8_t*>(data.data()));
+
+		EXPECT_EQ(message.size(), data.size());
+	}
+
+	auto after = pool.statistics();
+
+	EXPECT_LE(after.misses - before.misses, 1);
+	EXPECT_GE(after.hits - before.hits, 99);
+}
+
+} // namespace framework
+} // namespace synapse
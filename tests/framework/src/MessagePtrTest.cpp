@@ -0,0 +1,265 @@
+///
+/// @file MessagePtrTest.cpp
+///
+/// Unit testing of the MessagePtr class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <cstring>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/LegacyConsumer.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/MessagePool.h>
+#include <synapse/framework/MessagePtr.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Fiber written for the previous versions of the framework.
+///
+class LegacyFiber :
+	public LegacyConsumer<Fiber>
+{
+public:
+
+	/// Constructor.
+	LegacyFiber()
+		: LegacyConsumer<Fiber>("legacy")
+	{
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData&) override
+	{
+		return {};
+	}
+
+	/// Consume a message (legacy).
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const std::shared_ptr<Message>& message) override
+	{
+		messages.push_back(message);
+	}
+
+	/// The consumed messages.
+	std::vector<std::shared_ptr<Message>> messages;
+};
+
+} // namespace
+
+TEST(MessagePtr, create)
+{
+	std::string sentence("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+	auto        message = Message::create(sentence.size(), reinterpret_cast<const uint8_t*>(sentence.data()));
+
+	ASSERT_TRUE(message);
+	EXPECT_EQ(message->size(), sentence.size());
+	EXPECT_EQ(std::memcmp(message->payload(), sentence.data(), sentence.size()), 0);
+
+	// The payload is stored in the block of the message.
+	auto begin = reinterpret_cast<const uint8_t*>(message.get());
+
+	EXPECT_GE(message->payload(), begin);
+	EXPECT_LE(message->payload() + message->size(), begin + sizeof(Message) + message->size());
+
+	// The block of the message is given back to the pool with the last reference.
+	auto block = reinterpret_cast<uint8_t*>(message.get());
+	auto copy  = message;
+
+	message.reset();
+	EXPECT_FALSE(message);
+	EXPECT_EQ(copy->size(), sentence.size());
+
+	copy.reset();
+
+	auto& pool   = MessagePool::instance();
+	auto  before = pool.statistics();
+	auto  other  = Message::create(sentence.size());
+
+	EXPECT_EQ(reinterpret_cast<uint8_t*>(other.get()), block);
+	EXPECT_EQ(pool.statistics().hits, before.hits + 1);
+}
+
+TEST(MessagePtr, share)
+{
+	std::string sentence("$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n");
+	auto        message = Message::create(sentence.size(), reinterpret_cast<const uint8_t*>(sentence.data()));
+
+	// A message shared with a std::shared_ptr is not copied.
+	auto shared = message.share();
+
+	EXPECT_EQ(shared.get(), message.get());
+
+	message.reset();
+	EXPECT_EQ(std::memcmp(shared->payload(), sentence.data(), sentence.size()), 0);
+
+	// The conversion back to a MessagePtr does not copy the message either.
+	MessagePtr converted(shared);
+
+	EXPECT_EQ(converted.get(), shared.get());
+
+	// A message created with std::make_shared is copied.
+	auto       legacy = std::make_shared<Message>(sentence.size(), reinterpret_cast<const uint8_t*>(sentence.data()));
+	MessagePtr copied(legacy);
+
+	EXPECT_NE(copied.get(), legacy.get());
+	EXPECT_EQ(copied->size(), legacy->size());
+	EXPECT_EQ(std::memcmp(copied->payload(), legacy->payload(), legacy->size()), 0);
+}
+
+TEST(MessagePtr, legacyConsumer)
+{
+	std::string sentence("$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n");
+	auto        message = Message::create(sentence.size(), reinterpret_cast<const uint8_t*>(sentence.data()));
+	LegacyFiber fiber;
+
+	// The message is forwarded to the legacy overload without copy.
+	static_cast<IConsumer&>(fiber).consume(message);
+
+	ASSERT_EQ(fiber.messages.size(), 1);
+	EXPECT_EQ(fiber.messages[0].get(), message.get());
+}
+
+TEST(MessagePtr, slice)
+{
+	std::string sentences("$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n");
+	auto        message = Message::create(sentences.size(), reinterpret_cast<const uint8_t*>(sentences.data()));
+	auto        payload = message->payload();
+
+	// The payload of a slice is shared with its parent.
+	auto first  = Message::slice(message, 0, 43);
+	auto second = Message::slice(message, 43, sentences.size() - 43);
+
+	EXPECT_EQ(first->payload(), message->payload());
+	EXPECT_EQ(first->size(), 43);
+	EXPECT_EQ(second->payload(), message->payload() + 43);
+	EXPECT_EQ(second->size(), sentences.size() - 43);
+
+	// A slice of a slice references the same payload.
+	auto checksum = Message::slice(second, second->size() - 4, 2);
+
+	EXPECT_EQ(std::memcmp(checksum->payload(), "48", 2), 0);
+
+	// The slices keep the parent alive.
+	message.reset();
+	first.reset();
+	second.reset();
+
+	EXPECT_EQ(checksum->payload(), payload + sentences.size() - 4);
+	EXPECT_EQ(std::memcmp(checksum->payload(), "48", 2), 0);
+}
+
+TEST(MessagePtr, layout)
+{
+	std::string small(64, 'S');
+
+	// The header takes a single cache line, it carries no room for a payload.
+	if constexpr (sizeof(void*) == 8)
+	{
+		EXPECT_LE(sizeof(Message), 64);
+	}
+
+	// The payload of a message built with the constructors is stored in a
+	// separate block.
+	Message separate(small.size(), reinterpret_cast<const uint8_t*>(small.data()));
+
+	EXPECT_TRUE(separate.payload() < reinterpret_cast<const uint8_t*>(&separate) ||
+				separate.payload() >= reinterpret_cast<const uint8_t*>(&separate) + sizeof(Message));
+
+	// Moving it acquires the payload without copy.
+	auto    payload = separate.payload();
+	Message moved(std::move(separate));
+
+	EXPECT_EQ(moved.payload(), payload);
+	EXPECT_EQ(std::memcmp(moved.payload(), small.data(), small.size()), 0);
+
+	// Messages created with create() use a single block: the header followed
+	// by the payload.
+	auto& pool    = MessagePool::instance();
+	auto  message = Message::create(small.size(), reinterpret_cast<const uint8_t*>(small.data()));
+	auto  block   = reinterpret_cast<uint8_t*>(message.get());
+
+	EXPECT_EQ(message->payload(), block + sizeof(Message));
+
+	message.reset();
+	EXPECT_EQ(pool.allocate(sizeof(Message) + small.size()), block);
+	pool.release(block, sizeof(Message) + small.size());
+
+	// A slice carries no payload, it takes a block of the size of the header.
+	auto parent = Message::create(small.size(), reinterpret_cast<const uint8_t*>(small.data()));
+	auto slice  = Message::slice(parent, 1, 2);
+
+	block = reinterpret_cast<uint8_t*>(slice.get());
+	slice.reset();
+	EXPECT_EQ(pool.allocate(sizeof(Message)), block);
+	pool.release(block, sizeof(Message));
+}
+
+TEST(MessagePtr, move)
+{
+	std::string sentence(82, '$');
+	auto        message = Message::create(sentence.size(), reinterpret_cast<const uint8_t*>(sentence.data()));
+
+	// Moving a message created with create() copies its payload.
+	Message moved(std::move(*message));
+
+	EXPECT_NE(moved.payload(), message->payload());
+	EXPECT_EQ(moved.size(), sentence.size());
+	EXPECT_EQ(std::memcmp(moved.payload(), sentence.data(), sentence.size()), 0);
+
+	// Moving it back in the message acquires the payload without copy.
+	auto payload = moved.payload();
+
+	*message = std::move(moved);
+
+	EXPECT_EQ(message->payload(), payload);
+	EXPECT_EQ(moved.payload(), nullptr);
+	EXPECT_EQ(message->size(), sentence.size());
+	EXPECT_EQ(std::memcmp(message->payload(), sentence.data(), sentence.size()), 0);
+}
+
+TEST(MessagePtr, metadata)
+{
+	std::string sentences("$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n");
+	auto        message = Message::create(sentences.size(), reinterpret_cast<const uint8_t*>(sentences.data()));
+
+	EXPECT_EQ(message->metadata().timestamp, 0);
+	EXPECT_EQ(message->metadata().sequence, 0);
+	EXPECT_EQ(message->metadata().origin, 0);
+
+	message->metadata() = { Message::Metadata::now(), 12, 3 };
+
+	// The metadata are inherited by the messages derived from the message.
+	auto slice   = Message::slice(message, 43, sentences.size() - 43);
+	auto derived = Message::create(43, message->payload(), message->metadata());
+	auto legacy  = std::make_shared<Message>(43, message->payload());
+
+	legacy->metadata() = message->metadata();
+
+	for (const auto& current : { slice, derived, MessagePtr(legacy) })
+	{
+		EXPECT_EQ(current->metadata().timestamp, message->metadata().timestamp);
+		EXPECT_EQ(current->metadata().sequence, 12);
+		EXPECT_EQ(current->metadata().origin, 3);
+	}
+}
+
+} // namespace framework
+} // namespace synapse
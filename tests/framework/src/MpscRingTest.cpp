@@ -0,0 +1,205 @@
+///
+/// @file MpscRingTest.cpp
+///
+/// Unit testing of the MpscRing class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/MpscRing.h>
+
+namespace synapse {
+namespace framework {
+
+TEST(MpscRing, capacity)
+{
+	EXPECT_EQ(MpscRing<int>(0).capacity(), 2);
+	EXPECT_EQ(MpscRing<int>(4).capacity(), 4);
+	EXPECT_EQ(MpscRing<int>(1000).capacity(), 1024);
+}
+
+TEST(MpscRing, pushPop)
+{
+	MpscRing<int> ring(4);
+	int           value = 0;
+
+	EXPECT_TRUE(ring.empty());
+	EXPECT_FALSE(ring.tryPop(value));
+
+	// The ring stores up to its capacity.
+	for (int index = 1; index <= 4; ++index)
+	{
+		value = index;
+		EXPECT_TRUE(ring.tryPush(value));
+	}
+	value = 5;
+	EXPECT_FALSE(ring.tryPush(value));
+	EXPECT_FALSE(ring.empty());
+
+	// The elements are removed in order, the cells are reused.
+	for (int index = 1; index <= 4; ++index)
+	{
+		EXPECT_TRUE(ring.tryPop(value));
+		EXPECT_EQ(value, index);
+
+		value = index + 4;
+		EXPECT_TRUE(ring.tryPush(value));
+	}
+	for (int index = 5; index <= 8; ++index)
+	{
+		EXPECT_TRUE(ring.tryPop(value));
+		EXPECT_EQ(value, index);
+	}
+	EXPECT_TRUE(ring.empty());
+}
+
+TEST(MpscRing, tryPopAll)
+{
+	MpscRing<int>    ring(4);
+	std::vector<int> values;
+
+	EXPECT_EQ(ring.tryPopAll(values), 0);
+
+	// All the pending elements are appended in order.
+	for (int index = 1; index <= 3; ++index)
+	{
+		EXPECT_TRUE(ring.push(int{ index }));
+	}
+	values.push_back(0);
+	EXPECT_EQ(ring.tryPopAll(values), 3);
+	EXPECT_EQ(values, std::vector<int>({ 0, 1, 2, 3 }));
+	EXPECT_TRUE(ring.empty());
+}
+
+TEST(MpscRing, producers)
+{
+	static const int PRODUCER_COUNT = 4;
+	static const int VALUE_COUNT    = 10000;
+
+	MpscRing<int>            ring(16);
+	std::vector<std::thread> producers;
+
+	// Each producer pushes increasing values, the ring is small so that the
+	// producers and the consumer have to park.
+	for (int producer = 0; producer < PRODUCER_COUNT; ++producer)
+	{
+		producers.emplace_back([&ring, producer] {
+			for (int index = 0; index < VALUE_COUNT; ++index)
+			{
+				EXPECT_TRUE(ring.push(producer * VALUE_COUNT + index));
+			}
+		});
+	}
+
+	// The order of the values of a producer is kept.
+	std::vector<int> last(PRODUCER_COUNT, -1);
+	int              value = 0;
+
+	for (int count = 0; count < PRODUCER_COUNT * VALUE_COUNT; ++count)
+	{
+		while (!ring.tryPop(value))
+		{
+			ring.wait();
+		}
+
+		auto producer = value / VALUE_COUNT;
+
+		EXPECT_GT(value % VALUE_COUNT, last[producer]);
+		last[producer] = value % VALUE_COUNT;
+	}
+
+	for (auto& producer : producers)
+	{
+		producer.join();
+	}
+	EXPECT_TRUE(ring.empty());
+}
+
+TEST(MpscRing, discard)
+{
+	static const int PRODUCER_COUNT = 4;
+	static const int VALUE_COUNT    = 10000;
+
+	MpscRing<int>            ring(8);
+	std::vector<std::thread> producers;
+	std::atomic<int>         done{ 0 };
+
+	// The producers discard the oldest element when the ring is full.
+	for (int producer = 0; producer < PRODUCER_COUNT; ++producer)
+	{
+		producers.emplace_back([&ring, &done, producer] {
+			for (int index = 0; index < VALUE_COUNT; ++index)
+			{
+				int value = producer * VALUE_COUNT + index;
+				int discarded;
+
+				while (!ring.tryPush(value))
+				{
+					ring.tryPop(discarded);
+				}
+			}
+			++done;
+		});
+	}
+
+	// The order of the values of a producer is kept, even if some are missing.
+	std::vector<int> last(PRODUCER_COUNT, -1);
+	int              value = 0;
+
+	while (done.load() < PRODUCER_COUNT || !ring.empty())
+	{
+		if (!ring.tryPop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		auto producer = value / VALUE_COUNT;
+
+		EXPECT_GT(value % VALUE_COUNT, last[producer]);
+		last[producer] = value % VALUE_COUNT;
+	}
+
+	for (auto& producer : producers)
+	{
+		producer.join();
+	}
+}
+
+TEST(MpscRing, close)
+{
+	MpscRing<int> ring(2);
+
+	// Closing the ring wakes up the parked consumer.
+	std::thread consumer([&ring] {
+		ring.wait();
+	});
+
+	// Closing the ring also wakes up the producers parked on a full ring.
+	int value = 0;
+
+	EXPECT_TRUE(ring.tryPush(value));
+	EXPECT_TRUE(ring.tryPush(value));
+
+	std::thread producer([&ring] {
+		EXPECT_FALSE(ring.push(3));
+	});
+
+	ring.close();
+	consumer.join();
+	producer.join();
+
+	// No more element can be pushed once the ring is closed.
+	EXPECT_TRUE(ring.closed());
+	EXPECT_FALSE(ring.push(1));
+}
+
+} // namespace framework
+} // namespace synapse
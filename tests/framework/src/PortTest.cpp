@@ -0,0 +1,56 @@
+///
+/// @file PortTest.cpp
+///
+/// Unit testing of the Port class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Message.h>
+#include <synapse/framework/MessagePtr.h>
+#include <synapse/framework/Port.h>
+
+namespace synapse {
+namespace framework {
+
+TEST(Port, stamp)
+{
+	Port first("first", nullptr, 1);
+	Port second("second", nullptr, 2);
+
+	// The messages issued by a port are stamped with its identifier and its
+	// sequence number.
+	auto before  = Message::Metadata::now();
+	auto message = Message::create(0);
+
+	first.dispatch(message);
+
+	EXPECT_EQ(message->metadata().origin, 1);
+	EXPECT_EQ(message->metadata().sequence, 1);
+	EXPECT_GE(message->metadata().timestamp, before);
+
+	// A message forwarded by another port keeps its metadata.
+	auto timestamp = message->metadata().timestamp;
+
+	second.dispatch(message);
+
+	EXPECT_EQ(message->metadata().origin, 1);
+	EXPECT_EQ(message->metadata().sequence, 1);
+	EXPECT_EQ(message->metadata().timestamp, timestamp);
+
+	// The timestamp set by a source is kept.
+	auto other = Message::create(0);
+
+	other->metadata().timestamp = 42;
+	first.dispatch(other);
+
+	EXPECT_EQ(other->metadata().origin, 1);
+	EXPECT_EQ(other->metadata().sequence, 2);
+	EXPECT_EQ(other->metadata().timestamp, 42);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,457 @@
+///
+/// @file ReplicaSetTest.cpp
+///
+/// Unit testing of the ReplicaSet class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Executor.h>
+#include <synapse/framework/Fiber.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/ReplicaSet.h>
+#include <synapse/framework/Route.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Fiber that records the messages it consumes and echoes them on its port.
+///
+class EchoFiber :
+	public Fiber
+{
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the fiber.
+	explicit EchoFiber(
+		const std::string& name)
+		: Fiber(name)
+	{
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData& configData) override
+	{
+		(void) configData; // Unused parameter.
+
+		return { "out" };
+	}
+
+	/// Consume a message (the odd values are slower to process).
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		uint32_t value = 0;
+
+		std::memcpy(&value, message->payload(), sizeof(value));
+		if (value % 2 != 0)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			sequences[message->metadata().origin].push_back(message->metadata().sequence);
+			++count;
+		}
+
+		if (output != nullptr && emitFromThread)
+		{
+			std::thread([this, value] { output->dispatch(Message::create(sizeof(value), reinterpret_cast<const uint8_t*>(&value))); }).join();
+		}
+		else if (output != nullptr)
+		{
+			output->dispatch(Message::create(sizeof(value), reinterpret_cast<const uint8_t*>(&value)));
+		}
+	}
+
+	/// The port of the echoed messages.
+	Port*                                     output{ nullptr };
+
+	/// Indicates that the echoes are dispatched by another thread (while the
+	/// message is consumed).
+	bool                                      emitFromThread{ false };
+
+	/// The sequence numbers received from each port.
+	std::map<uint32_t, std::vector<uint32_t>> sequences;
+
+	/// The number of messages consumed.
+	std::atomic<size_t>                       count{ 0 };
+
+	/// The mutex to protect the records.
+	std::mutex                                mutex;
+};
+
+///
+/// Consumer that records the values of the messages.
+///
+class ValueConsumer :
+	public IConsumer
+{
+public:
+
+	/// Check if the consumer accepts concurrent calls to consume().
+	bool isThreadSafe() const override { return true; }
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		uint32_t                    value = 0;
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		std::memcpy(&value, message->payload(), sizeof(value));
+		values.push_back(value);
+		++count;
+	}
+
+	/// The values, in the order of consumption.
+	std::vector<uint32_t> values;
+
+	/// The number of messages consumed.
+	std::atomic<size_t>   count{ 0 };
+
+private:
+
+	/// The mutex to protect the values.
+	std::mutex            _mutex;
+};
+
+/// Create a message holding a value.
+///
+/// @param value The value.
+///
+/// @return The message.
+MessagePtr valueMessage(
+	uint32_t value)
+{
+	return Message::create(sizeof(value), reinterpret_cast<const uint8_t*>(&value));
+}
+
+} // namespace
+
+TEST(ReplicaSet, shardByPort)
+{
+	static const size_t PORT_COUNT    = 6;
+	static const size_t MESSAGE_COUNT = 200;
+
+	EchoFiber  first("fiber-1");
+	EchoFiber  second("fiber-2");
+	EchoFiber  third("fiber-3");
+	ReplicaSet set("fiber", { &first, &second, &third }, {}, false);
+	Executor   executor(3);
+
+	std::list<std::unique_ptr<Port>> ports;
+	std::list<Port*>                 sources;
+
+	for (size_t index = 0; index < PORT_COUNT; ++index)
+	{
+		sources.push_back(ports.emplace_back(std::make_unique<Port>("port", nullptr, static_cast<uint32_t>(index + 1))).get());
+	}
+
+	Route route(sources, { &set }, nullptr);
+
+	for (auto& port : ports)
+	{
+		port->attach(&route);
+	}
+
+	set.setExecutor(&executor);
+	executor.start();
+	for (size_t index = 0; index < MESSAGE_COUNT; ++index)
+	{
+		for (auto& port : ports)
+		{
+			port->dispatch(valueMessage(0));
+		}
+	}
+	while (first.count + second.count + third.count < PORT_COUNT * MESSAGE_COUNT)
+	{
+		std::this_thread::yield();
+	}
+	set.shutdown();
+	executor.stop();
+
+	// Each port is served by a single replica, in order, and every replica
+	// gets its share of the ports.
+	std::set<uint32_t> origins;
+
+	for (auto replica : { &first, &second, &third })
+	{
+		EXPECT_EQ(replica->sequences.size(), PORT_COUNT / 3);
+		for (auto& [origin, sequences] : replica->sequences)
+		{
+			EXPECT_TRUE(origins.insert(origin).second);
+			ASSERT_EQ(sequences.size(), MESSAGE_COUNT);
+			for (size_t index = 0; index < MESSAGE_COUNT; ++index)
+			{
+				EXPECT_EQ(sequences[index], index + 1);
+			}
+		}
+	}
+}
+
+TEST(ReplicaSet, shardByBytes)
+{
+	EchoFiber  first("fiber-1");
+	EchoFiber  second("fiber-2");
+	ReplicaSet set("fiber", { &first, &second }, { ShardKey::bytes, 1, 2 }, false);
+
+	// Only the bytes of the range select the replica.
+	uint8_t key[]   = { 1, 2, 3, 4 };
+	uint8_t other[] = { 9, 2, 3, 8 };
+
+	EXPECT_EQ(set.shardOf(Message::create(sizeof(key), key)), set.shardOf(Message::create(sizeof(other), other)));
+
+	// A payload shorter than the range is hashed up to its end.
+	EXPECT_LT(set.shardOf(Message::create(0)), 2);
+}
+
+TEST(ReplicaSet, resequence)
+{
+	static const uint32_t MESSAGE_COUNT = 500;
+
+	EchoFiber     first("fiber-1");
+	EchoFiber     second("fiber-2");
+	EchoFiber     third("fiber-3");
+	ReplicaSet    set("fiber", { &first, &second, &third }, { ShardKey::roundRobin }, true);
+	Executor      executor(3);
+	ValueConsumer consumer;
+
+	// The echoes of the replicas are released in order on the port of the set.
+	Port  output("out", &set, 1);
+	Route route({ &output }, { &consumer }, nullptr);
+
+	output.attach(&route);
+
+	std::list<std::unique_ptr<Port>> ports;
+
+	for (auto replica : { &first, &second, &third })
+	{
+		auto& port = ports.emplace_back(std::make_unique<Port>("out", replica, static_cast<uint32_t>(ports.size() + 2)));
+
+		replica->output = port.get();
+		set.bind(*port, output);
+	}
+
+	set.setExecutor(&executor);
+	executor.start();
+	for (uint32_t value = 0; value < MESSAGE_COUNT; ++value)
+	{
+		set.consume(valueMessage(value));
+	}
+	while (consumer.count < MESSAGE_COUNT)
+	{
+		std::this_thread::yield();
+	}
+	set.shutdown();
+	executor.stop();
+
+	std::vector<uint32_t> expected;
+
+	for (uint32_t value = 0; value < MESSAGE_COUNT; ++value)
+	{
+		expected.push_back(value);
+	}
+	EXPECT_EQ(consumer.values, expected);
+	EXPECT_EQ(set.held(), 0);
+	EXPECT_GT(first.count, 0);
+	EXPECT_GT(second.count, 0);
+	EXPECT_GT(third.count, 0);
+}
+
+TEST(ReplicaSet, resequenceFromThread)
+{
+	static const uint32_t MESSAGE_COUNT = 200;
+
+	EchoFiber     first("fiber-1");
+	EchoFiber     second("fiber-2");
+	ReplicaSet    set("fiber", { &first, &second }, { ShardKey::roundRobin }, true);
+	Executor      executor(2);
+	ValueConsumer consumer;
+	Port          output("out", &set, 1);
+	Route         route({ &output }, { &consumer }, nullptr);
+
+	output.attach(&route);
+
+	// The replicas emit their echoes from threads of their own: the echoes
+	// are filed under the input consumed by the replica.
+	std::list<std::unique_ptr<Port>> ports;
+
+	for (auto replica : { &first, &second })
+	{
+		auto& port = ports.emplace_back(std::make_unique<Port>("out", replica, static_cast<uint32_t>(ports.size() + 2)));
+
+		replica->output         = port.get();
+		replica->emitFromThread = true;
+		set.bind(*port, output);
+	}
+
+	set.setExecutor(&executor);
+	executor.start();
+	for (uint32_t value = 0; value < MESSAGE_COUNT; ++value)
+	{
+		set.consume(valueMessage(value));
+	}
+	while (consumer.count < MESSAGE_COUNT)
+	{
+		std::this_thread::yield();
+	}
+	set.shutdown();
+	executor.stop();
+
+	std::vector<uint32_t> expected;
+
+	for (uint32_t value = 0; value < MESSAGE_COUNT; ++value)
+	{
+		expected.push_back(value);
+	}
+	EXPECT_EQ(consumer.values, expected);
+	EXPECT_EQ(set.held(), 0);
+}
+
+TEST(ReplicaSet, dropNewest)
+{
+	EchoFiber     fiber("fiber-1");
+	ReplicaSet    set("fiber", { &fiber }, {}, true, { 2, OverflowPolicy::dropNewest });
+	Executor      executor(1);
+	ValueConsumer consumer;
+	Port          output("out", &set, 1);
+	Route         route({ &output }, { &consumer }, nullptr);
+	Port          port("out", &fiber, 2);
+
+	output.attach(&route);
+	fiber.output = &port;
+	set.bind(port, output);
+	set.setExecutor(&executor);
+
+	// The executor is not started: only the first two messages find room,
+	// the discarded ones do not hold the release of the next outputs.
+	for (uint32_t value = 0; value < 5; ++value)
+	{
+		set.consume(valueMessage(value));
+	}
+	executor.start();
+	while (consumer.count < 2)
+	{
+		std::this_thread::yield();
+	}
+	set.consume(valueMessage(5));
+	while (consumer.count < 3)
+	{
+		std::this_thread::yield();
+	}
+	set.shutdown();
+	executor.stop();
+
+	EXPECT_EQ(consumer.values, std::vector<uint32_t>({ 0, 1, 5 }));
+	EXPECT_EQ(set.overflows().dropped, 3);
+	EXPECT_EQ(set.held(), 0);
+}
+
+TEST(ReplicaSet, blockOnExecutor)
+{
+	///
+	/// Task that feeds the set from a thread of the executor.
+	///
+	struct Producer :
+		public ITask
+	{
+		explicit Producer(
+			ReplicaSet& set)
+			: set(set)
+		{
+		}
+
+		void execute() override
+		{
+			for (uint32_t value = 0; value < 100; ++value)
+			{
+				set.consume(valueMessage(value));
+			}
+		}
+
+		ReplicaSet& set;
+	};
+
+	EchoFiber     fiber("fiber-1");
+	ReplicaSet    set("fiber", { &fiber }, {}, true, { 1, OverflowPolicy::block });
+	Executor      executor(1);
+	ValueConsumer consumer;
+	Port          output("out", &set, 1);
+	Route         route({ &output }, { &consumer }, nullptr);
+	Port          port("out", &fiber, 2);
+	Producer      producer(set);
+
+	output.attach(&route);
+	fiber.output = &port;
+	set.bind(port, output);
+
+	// The producer and the replica share the single thread of the executor:
+	// the producer cannot wait for room in the queue of the replica.
+	set.setExecutor(&executor);
+	executor.start();
+	executor.submit(producer);
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (consumer.count < 100 && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+	set.shutdown();
+	executor.stop();
+
+	ASSERT_EQ(consumer.count, 100);
+	for (uint32_t value = 0; value < 100; ++value)
+	{
+		EXPECT_EQ(consumer.values[value], value);
+	}
+	EXPECT_GT(set.overflows().blocked, 0);
+}
+
+TEST(ReplicaSet, invalid)
+{
+	EchoFiber fiber("fiber-1");
+
+	EXPECT_THROW(ReplicaSet("fiber", {}, {}, false), std::invalid_argument);
+	EXPECT_THROW(ReplicaSet("fiber", { &fiber }, {}, false, { 0, OverflowPolicy::block }), std::invalid_argument);
+
+	// Only the ports of the replicas can be bound.
+	ReplicaSet set("fiber", { &fiber }, {}, true);
+	Port       foreign("out", nullptr, 1);
+
+	EXPECT_THROW(set.bind(foreign, foreign), std::invalid_argument);
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,148 @@
+///
+/// @file RouteTest.cpp
+///
+/// Unit testing of the Route class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Dispatcher.h>
+#include <synapse/framework/IConsumer.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+#include <synapse/framework/RouteFilter.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Consumer that records the threads that consume the messages.
+///
+class ThreadConsumer :
+	public IConsumer
+{
+public:
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		(void) message; // Unused parameter.
+
+		threads.push_back(std::this_thread::get_id());
+	}
+
+	/// The threads that consumed the messages.
+	std::vector<std::thread::id> threads;
+};
+
+} // namespace
+
+TEST(Route, inlineDispatch)
+{
+	Port           port("port", nullptr, 1);
+	ThreadConsumer first;
+	ThreadConsumer second;
+	Route          route({ &port }, { &first, &second }, nullptr);
+
+	EXPECT_TRUE(route.isInline());
+	port.attach(&route);
+
+	// The destinations consume the message in the thread of the port.
+	port.dispatch(Message::create(0));
+
+	ASSERT_EQ(first.threads.size(), 1);
+	ASSERT_EQ(second.threads.size(), 1);
+	EXPECT_EQ(first.threads.front(), std::this_thread::get_id());
+	EXPECT_EQ(second.threads.front(), std::this_thread::get_id());
+}
+
+TEST(Route, fuse)
+{
+	Dispatcher     dispatcher("dispatcher");
+	Port           port("port", nullptr, 1);
+	ThreadConsumer consumer;
+	Route          route({ &port }, { &consumer }, &dispatcher);
+
+	EXPECT_FALSE(route.isInline());
+	EXPECT_EQ(route.dispatcher(), &dispatcher);
+
+	// A fused route no longer goes through the dispatcher (which does not run).
+	route.fuse();
+	port.attach(&route);
+	port.dispatch(Message::create(0));
+
+	EXPECT_TRUE(route.isInline());
+	EXPECT_TRUE(route.isFused());
+	ASSERT_EQ(consumer.threads.size(), 1);
+	EXPECT_EQ(consumer.threads.front(), std::this_thread::get_id());
+	EXPECT_EQ(dispatcher.lanes()[1].depth, 0);
+}
+
+TEST(Route, filter)
+{
+	Port           port("port", nullptr, 1);
+	ThreadConsumer consumer;
+	Route          route({ &port }, { &consumer }, nullptr);
+	RouteFilter    filter;
+
+	// GPS or GNSS sentences of at least 6 bytes with a 'G' at offset 3.
+	filter.prefixes = { "$GP", "$GN" };
+	filter.minSize  = 6;
+	filter.bytes    = { { 3, 'G' } };
+	route.setFilter(filter);
+	port.attach(&route);
+
+	auto sentence = [](const std::string& text) {
+		return Message::create(text.size(), reinterpret_cast<const uint8_t*>(text.data()));
+	};
+
+	port.dispatch(sentence("$GPGGA,"));
+	port.dispatch(sentence("$GNGSA,"));
+	port.dispatch(sentence("$GPRMC,"));
+	port.dispatch(sentence("$IIMWV,"));
+	port.dispatch(sentence("$GPG"));
+
+	EXPECT_EQ(consumer.threads.size(), 2);
+	EXPECT_EQ(route.rejected(), 3);
+}
+
+TEST(Route, filterBeforeEnqueue)
+{
+	Dispatcher     dispatcher("dispatcher", 1, { 2, OverflowPolicy::dropNewest });
+	Port           port("port", nullptr, 1);
+	ThreadConsumer consumer;
+	Route          route({ &port }, { &consumer }, &dispatcher);
+	RouteFilter    filter;
+
+	// The rejected messages do not take a slot of the queue (the dispatcher
+	// does not run).
+	filter.maxSize = 1;
+	route.setFilter(filter);
+	port.attach(&route);
+	for (size_t index = 0; index < 10; ++index)
+	{
+		port.dispatch(Message::create(2));
+	}
+	port.dispatch(Message::create(1));
+	port.dispatch(Message::create(0));
+
+	EXPECT_EQ(route.rejected(), 10);
+	EXPECT_EQ(dispatcher.lanes()[1].depth, 2);
+	EXPECT_EQ(dispatcher.overflows().dropped, 0);
+}
+
+} // namespace framework
+} // namespace synapse
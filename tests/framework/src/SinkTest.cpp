@@ -0,0 +1,318 @@
+///
+/// @file SinkTest.cpp
+///
+/// Unit testing of the Sink class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Dispatcher.h>
+#include <synapse/framework/Executor.h>
+#include <synapse/framework/LegacyConsumer.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+#include <synapse/framework/Sink.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Sink that records the first byte of the messages it processes.
+///
+class RecordingSink :
+	public Sink
+{
+public:
+
+	/// Constructor.
+	RecordingSink()
+		: Sink("sink")
+	{
+	}
+
+	/// Get the first bytes of the processed messages.
+	std::vector<uint8_t> processed()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		return _processed;
+	}
+
+	/// Get the number of processed messages.
+	size_t count() const { return _count.load(); }
+
+protected:
+
+	/// Process a message in the context of the runnable.
+	///
+	/// @param message[in] Message to be processed.
+	void process(
+		const MessagePtr& message) override
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_processed.push_back(message->payload()[0]);
+		++_count;
+	}
+
+private:
+
+	/// The mutex to protect the processed messages.
+	std::mutex           _mutex;
+
+	/// The first bytes of the processed messages.
+	std::vector<uint8_t> _processed;
+
+	/// The number of processed messages.
+	std::atomic<size_t>  _count{ 0 };
+};
+
+///
+/// Sink written for the previous versions of the framework.
+///
+class LegacyRecordingSink :
+	public LegacySink
+{
+public:
+
+	/// Constructor.
+	LegacyRecordingSink()
+		: LegacySink("legacy")
+	{
+	}
+
+	/// The processed messages.
+	std::vector<std::shared_ptr<Message>> processed;
+
+	/// The number of processed messages.
+	std::atomic<size_t>                   count{ 0 };
+
+protected:
+
+	/// Process a message in the context of the runnable (legacy).
+	///
+	/// @param message[in] Message to be processed.
+	void process(
+		const std::shared_ptr<Message>& message) override
+	{
+		processed.push_back(message);
+		++count;
+	}
+};
+
+/// Feed a sink with messages then run it until all the queued messages are processed.
+///
+/// @param sink The sink to feed.
+/// @param count The number of messages.
+/// @param expected The number of messages expected to be processed.
+void feed(
+	RecordingSink& sink,
+	uint8_t        count,
+	size_t         expected)
+{
+	for (uint8_t index = 0; index < count; ++index)
+	{
+		sink.consume(Message::create(1, &index));
+	}
+
+	std::thread runner([&sink] { sink.run(); });
+
+	while (sink.count() < expected)
+	{
+		std::this_thread::yield();
+	}
+	sink.shutdown();
+	runner.join();
+}
+
+} // namespace
+
+TEST(Sink, dropNewest)
+{
+	RecordingSink sink;
+
+	sink.setQueuePolicy({ 3, OverflowPolicy::dropNewest });
+	feed(sink, 5, 3);
+
+	EXPECT_EQ(sink.processed(), std::vector<uint8_t>({ 0, 1, 2 }));
+	EXPECT_EQ(sink.overflows().dropped, 2);
+	EXPECT_EQ(sink.overflows().blocked, 0);
+}
+
+TEST(Sink, dropOldest)
+{
+	RecordingSink sink;
+
+	sink.setQueuePolicy({ 3, OverflowPolicy::dropOldest });
+	feed(sink, 5, 3);
+
+	EXPECT_EQ(sink.processed(), std::vector<uint8_t>({ 2, 3, 4 }));
+	EXPECT_EQ(sink.overflows().dropped, 2);
+}
+
+TEST(Sink, block)
+{
+	RecordingSink sink;
+
+	sink.setQueuePolicy({ 2, OverflowPolicy::block });
+
+	// The producer waits for the sink to make room in its queue.
+	std::thread producer([&sink] {
+		for (uint8_t index = 0; index < 100; ++index)
+		{
+			sink.consume(Message::create(1, &index));
+		}
+	});
+	std::thread runner([&sink] { sink.run(); });
+
+	producer.join();
+	while (sink.count() < 100)
+	{
+		std::this_thread::yield();
+	}
+	sink.shutdown();
+	runner.join();
+
+	auto processed = sink.processed();
+
+	for (size_t index = 0; index < processed.size(); ++index)
+	{
+		EXPECT_EQ(processed[index], index);
+	}
+	EXPECT_EQ(sink.overflows().dropped, 0);
+}
+
+TEST(Sink, busyPoll)
+{
+	RecordingSink sink;
+
+	// The runnable polls the queue and never sleeps.
+	sink.setWaitStrategy({ WaitMode::busyPoll });
+
+	std::thread runner([&sink] { sink.run(); });
+
+	for (uint8_t index = 0; index < 100; ++index)
+	{
+		sink.consume(Message::create(1, &index));
+	}
+	while (sink.count() < 100)
+	{
+		std::this_thread::yield();
+	}
+	sink.shutdown();
+	runner.join();
+
+	auto processed = sink.processed();
+
+	for (size_t index = 0; index < processed.size(); ++index)
+	{
+		EXPECT_EQ(processed[index], index);
+	}
+}
+
+TEST(Sink, executor)
+{
+	Executor      executor(2);
+	RecordingSink sink;
+
+	// The sink is scheduled by the executor, run() is not called.
+	sink.setExecutor(&executor);
+	executor.start();
+
+	for (uint8_t index = 0; index < 200; ++index)
+	{
+		sink.consume(Message::create(1, &index));
+	}
+	while (sink.count() < 200)
+	{
+		std::this_thread::yield();
+	}
+	sink.shutdown();
+	executor.stop();
+
+	auto processed = sink.processed();
+
+	for (size_t index = 0; index < processed.size(); ++index)
+	{
+		EXPECT_EQ(processed[index], index);
+	}
+}
+
+TEST(Sink, blockOnExecutor)
+{
+	Executor      executor(1);
+	Dispatcher    dispatcher("dispatcher");
+	RecordingSink sink;
+	Port          port("port", nullptr, 1);
+	Route         route({ &port }, { &sink }, &dispatcher);
+
+	// The dispatcher and the sink share the single thread of the executor: the
+	// dispatcher cannot wait for room in the queue of the sink.
+	sink.setQueuePolicy({ 1, OverflowPolicy::block });
+	sink.setExecutor(&executor);
+	dispatcher.setExecutor(&executor);
+	port.attach(&route);
+	executor.start();
+
+	for (uint8_t index = 0; index < 100; ++index)
+	{
+		port.dispatch(Message::create(1, &index));
+	}
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (sink.count() < 100 && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+	sink.shutdown();
+	dispatcher.shutdown();
+	executor.stop();
+
+	auto processed = sink.processed();
+
+	ASSERT_EQ(processed.size(), 100);
+	for (size_t index = 0; index < processed.size(); ++index)
+	{
+		EXPECT_EQ(processed[index], index);
+	}
+	EXPECT_GT(sink.overflows().blocked, 0);
+}
+
+TEST(Sink, legacy)
+{
+	LegacyRecordingSink sink;
+	uint8_t             value{ 7 };
+	auto                message = Message::create(1, &value);
+
+	// The queued message is forwarded to the legacy overload without copy.
+	sink.consume(message);
+
+	std::thread runner([&sink] { sink.run(); });
+
+	while (sink.count.load() < 1)
+	{
+		std::this_thread::yield();
+	}
+	sink.shutdown();
+	runner.join();
+
+	ASSERT_EQ(sink.processed.size(), 1);
+	EXPECT_EQ(sink.processed[0].get(), message.get());
+}
+
+} // namespace framework
+} // namespace synapse
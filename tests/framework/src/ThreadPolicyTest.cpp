@@ -0,0 +1,53 @@
+///
+/// @file ThreadPolicyTest.cpp
+///
+/// Unit testing of the ThreadPolicy class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/ThreadPolicy.h>
+
+namespace synapse {
+namespace framework {
+
+#if defined(__linux__)
+
+TEST(ThreadPolicy, affinity)
+{
+	std::string description;
+
+	// The policy is applied to a thread of its own to keep the test runner unchanged.
+	std::thread([&description] {
+		ThreadPolicy{ { 0 }, 0 }.apply();
+		description = ThreadPolicy::describeCurrentThread();
+	}).join();
+
+	EXPECT_EQ(description, "cpus 0, SCHED_OTHER");
+}
+
+TEST(ThreadPolicy, invalidCpu)
+{
+	ThreadPolicy policy{ { 100000 }, 0 };
+
+	std::thread([&policy] { EXPECT_THROW(policy.apply(), std::invalid_argument); }).join();
+}
+
+#endif
+
+TEST(ThreadPolicy, empty)
+{
+	EXPECT_TRUE(ThreadPolicy{}.empty());
+	EXPECT_FALSE((ThreadPolicy{ {}, 10 }.empty()));
+	EXPECT_NO_THROW(ThreadPolicy{}.apply());
+}
+
+} // namespace framework
+} // namespace synapse
@@ -0,0 +1,162 @@
+///
+/// @file TypedMessageTest.cpp
+///
+/// Unit testing of the structured messages.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Message.h>
+#include <synapse/framework/MessagePtr.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+#include <synapse/framework/TypedFiber.h>
+#include <synapse/framework/TypedPort.h>
+
+namespace synapse {
+namespace framework {
+
+namespace {
+
+///
+/// Position parsed from a sentence.
+///
+struct Position
+{
+	static constexpr SchemaId SCHEMA_ID = 1;
+
+	double   latitude;
+	double   longitude;
+	uint32_t quality;
+};
+
+///
+/// Heading parsed from a sentence.
+///
+struct Heading
+{
+	static constexpr SchemaId SCHEMA_ID = 2;
+
+	double heading;
+};
+
+///
+/// Fiber that records the positions it consumes.
+///
+class PositionFiber :
+	public TypedFiber<Position>
+{
+public:
+
+	/// Constructor.
+	PositionFiber()
+		: TypedFiber<Position>("positions")
+	{
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData& configData) override
+	{
+		(void) configData; // Unused parameter.
+
+		return {};
+	}
+
+	/// The positions consumed.
+	std::vector<Position> positions;
+
+	/// The origins of the messages consumed.
+	std::vector<uint32_t> origins;
+
+protected:
+
+	/// Consume a position.
+	///
+	/// @param value[in] The position.
+	/// @param message[in] The message.
+	void consume(
+		const Position&   value,
+		const MessagePtr& message) override
+	{
+		positions.push_back(value);
+		origins.push_back(message->metadata().origin);
+	}
+};
+
+} // namespace
+
+TEST(TypedMessage, create)
+{
+	auto message = Message::create(Position{ 48.5, -4.5, 2 });
+
+	EXPECT_EQ(message->schema(), Position::SCHEMA_ID);
+	EXPECT_EQ(message->size(), sizeof(Position));
+	ASSERT_NE(message->as<Position>(), nullptr);
+	EXPECT_EQ(message->as<Position>()->latitude, 48.5);
+	EXPECT_EQ(message->as<Position>()->quality, 2);
+
+	// Another schema, a raw message or a slice do not give the struct.
+	EXPECT_EQ(message->as<Heading>(), nullptr);
+	EXPECT_EQ(Message::create(sizeof(Position))->as<Position>(), nullptr);
+	EXPECT_EQ(Message::slice(message, 0, sizeof(Position))->schema(), RAW_SCHEMA);
+}
+
+TEST(TypedMessage, typedFiber)
+{
+	Port          port("positions", nullptr, 7);
+	PositionFiber fiber;
+	Route         route({ &port }, { &fiber }, nullptr);
+
+	port.setSchema(schemaOf<Position>());
+	port.attach(&route);
+	EXPECT_EQ(fiber.schema(), Position::SCHEMA_ID);
+
+	// The struct is read in place by the consumer.
+	TypedPort<Position> positions(&port);
+
+	positions.dispatch({ 47.0, -3.0, 1 });
+	positions.dispatch({ 47.5, -3.5, 1 });
+
+	ASSERT_EQ(fiber.positions.size(), 2);
+	EXPECT_EQ(fiber.positions[1].longitude, -3.5);
+	EXPECT_EQ(fiber.origins, std::vector<uint32_t>({ 7, 7 }));
+
+	// A message of another schema is a programming error.
+	auto raw = Message::create(sizeof(Position));
+
+	EXPECT_THROW(static_cast<IConsumer&>(fiber).consume(raw), std::logic_error);
+}
+
+TEST(TypedMessage, legacyRoundTrip)
+{
+	PositionFiber fiber;
+
+	// A structured message held by a std::shared_ptr that does not come from
+	// share() is copied with its schema.
+	auto legacy  = std::make_shared<Message>(std::move(*Message::create(Position{ 46.0, -2.0, 3 })));
+	auto message = MessagePtr(legacy);
+
+	EXPECT_EQ(message->schema(), Position::SCHEMA_ID);
+	ASSERT_NE(message->as<Position>(), nullptr);
+	EXPECT_EQ(message->as<Position>()->latitude, 46.0);
+
+	// The typed consumer accepts it.
+	EXPECT_NO_THROW(static_cast<IConsumer&>(fiber).consume(legacy));
+	ASSERT_EQ(fiber.positions.size(), 1);
+	EXPECT_EQ(fiber.positions[0].quality, 3);
+}
+
+} // namespace framework
+} // namespace synapse
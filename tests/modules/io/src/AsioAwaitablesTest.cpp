@@ -0,0 +1,198 @@
+///
+/// @file AsioAwaitablesTest.cpp
+///
+/// Unit testing of the awaitables of the asynchronous operations of boost::asio.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Executor.h>
+
+#include "AsioAwaitables.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+namespace {
+
+/// Coroutine that connects to a server and reads its greeting.
+///
+/// @param socket The socket to connect.
+/// @param endPoint The end point of the server.
+/// @param received The received bytes.
+/// @param finished Set when the coroutine returns.
+synapse::framework::Coroutine readGreeting(
+	boost::asio::ip::tcp::socket&         socket,
+	const boost::asio::ip::tcp::endpoint& endPoint,
+	std::string&                          received,
+	std::atomic<bool>&                    finished)
+{
+	if (!co_await asyncConnect(socket, endPoint))
+	{
+		char buffer[16];
+
+		for (;;)
+		{
+			auto [error, size, timestamp] = co_await asyncReadSome(socket, boost::asio::buffer(buffer));
+
+			if (error)
+			{
+				break;
+			}
+			received.append(buffer, size);
+		}
+	}
+	finished.store(true);
+	finished.notify_all();
+}
+
+/// Coroutine that awaits a read already started.
+///
+/// @param read The read.
+/// @param timestamp The time of the reception given by the read.
+/// @param resumed The time the coroutine gets the result.
+/// @param finished Set when the coroutine returns.
+synapse::framework::Coroutine awaitRead(
+	AsioOperation<std::tuple<boost::system::error_code, size_t, uint64_t>>& read,
+	uint64_t&                                                               timestamp,
+	uint64_t&                                                               resumed,
+	std::atomic<bool>&                                                      finished)
+{
+	timestamp = std::get<2>(co_await read);
+	resumed   = synapse::framework::Message::Metadata::now();
+	finished.store(true);
+	finished.notify_all();
+}
+
+/// Coroutine that waits for a delay.
+///
+/// @param timer The timer.
+/// @param elapsed The time actually waited.
+/// @param finished Set when the coroutine returns.
+synapse::framework::Coroutine sleep(
+	boost::asio::steady_timer&           timer,
+	std::chrono::steady_clock::duration& elapsed,
+	std::atomic<bool>&                   finished)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	co_await asyncWait(timer, std::chrono::milliseconds(20));
+	elapsed = std::chrono::steady_clock::now() - start;
+	finished.store(true);
+	finished.notify_all();
+}
+
+} // namespace
+
+TEST(AsioAwaitables, readSome)
+{
+	boost::asio::io_context        ioc;
+	boost::asio::ip::tcp::acceptor acceptor(ioc, { boost::asio::ip::address_v4::loopback(), 0 });
+	boost::asio::ip::tcp::socket   socket(ioc);
+	synapse::framework::Executor   executor(1);
+	std::string                    received;
+	std::atomic<bool>              finished{ false };
+	auto                           coroutine = readGreeting(socket, acceptor.local_endpoint(), received, finished);
+
+	// The server sends its greeting in two parts then closes the connection.
+	std::thread server([&acceptor] {
+		auto peer = acceptor.accept();
+
+		boost::asio::write(peer, boost::asio::buffer(std::string("hello ")));
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		boost::asio::write(peer, boost::asio::buffer(std::string("world")));
+	});
+
+	// The operations are performed by a thread that is not in the executor.
+	auto        guard = boost::asio::make_work_guard(ioc);
+	std::thread io([&ioc] { ioc.run(); });
+
+	executor.start();
+	coroutine.start(executor);
+	finished.wait(false);
+	executor.stop();
+	guard.reset();
+	ioc.stop();
+	io.join();
+	server.join();
+
+	EXPECT_EQ(received, "hello world");
+	EXPECT_TRUE(coroutine.done());
+	EXPECT_EQ(coroutine.exception(), nullptr);
+}
+
+TEST(AsioAwaitables, readTimestamp)
+{
+	boost::asio::io_context        ioc;
+	boost::asio::ip::tcp::acceptor acceptor(ioc, { boost::asio::ip::address_v4::loopback(), 0 });
+	boost::asio::ip::tcp::socket   socket(ioc);
+
+	socket.connect(acceptor.local_endpoint());
+
+	auto peer = acceptor.accept();
+	char buffer[16];
+	auto read = asyncReadSome(socket, boost::asio::buffer(buffer));
+
+	// The completion handler runs well before the coroutine gets the result.
+	boost::asio::write(peer, boost::asio::buffer(std::string("hello")));
+	ioc.run_one();
+
+	auto completed = synapse::framework::Message::Metadata::now();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	synapse::framework::Executor executor(1);
+	uint64_t                     timestamp{ 0 };
+	uint64_t                     resumed{ 0 };
+	std::atomic<bool>            finished{ false };
+	auto                         coroutine = awaitRead(read, timestamp, resumed, finished);
+
+	executor.start();
+	coroutine.start(executor);
+	finished.wait(false);
+	executor.stop();
+
+	// The time of the reception is the one of the completion, not of the
+	// resumption.
+	EXPECT_GT(timestamp, 0);
+	EXPECT_LE(timestamp, completed);
+	EXPECT_GE(resumed - timestamp, 20'000'000);
+}
+
+TEST(AsioAwaitables, wait)
+{
+	boost::asio::io_context             ioc;
+	boost::asio::steady_timer           timer(ioc);
+	synapse::framework::Executor        executor(1);
+	std::chrono::steady_clock::duration elapsed{};
+	std::atomic<bool>                   finished{ false };
+	auto                                coroutine = sleep(timer, elapsed, finished);
+
+	auto        guard = boost::asio::make_work_guard(ioc);
+	std::thread io([&ioc] { ioc.run(); });
+
+	executor.start();
+	coroutine.start(executor);
+	finished.wait(false);
+	executor.stop();
+	guard.reset();
+	ioc.stop();
+	io.join();
+
+	EXPECT_GE(elapsed, std::chrono::milliseconds(20));
+	EXPECT_TRUE(coroutine.done());
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,483 @@
+///
+/// @file BridgeTest.cpp
+///
+/// Unit testing of the BridgeSink and BridgeSource classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <synapse/framework/Fiber.h>
+#include <synapse/framework/Manager.h>
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+#include <synapse/framework/Source.h>
+
+#include "BridgeSink.h"
+#include "BridgeSource.h"
+#include "TestBlocks.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+namespace {
+
+using synapse::framework::IBlock;
+using synapse::framework::IManager;
+using synapse::framework::IPort;
+using synapse::framework::Manager;
+using synapse::framework::Message;
+using synapse::framework::MessagePtr;
+using synapse::framework::Port;
+using synapse::framework::Route;
+
+///
+/// A source running in its own thread, with its port routed to a collector.
+///
+struct RunningSource
+{
+	/// Constructor.
+	///
+	/// @param tcpPort The TCP port to listen on.
+	RunningSource(
+		uint16_t tcpPort)
+		: source(static_cast<BridgeSource*>(BridgeSource::create("source"))),
+		  port("default", source, 1),
+		  route({ &port }, { &collector }, nullptr)
+	{
+		port.attach(&route);
+		manager.port = &port;
+		source->initialize({ { "host", "127.0.0.1" }, { "port", tcpPort } }, &manager);
+		thread = std::thread([this] { source->run(); });
+	}
+
+	/// Destructor.
+	~RunningSource()
+	{
+		source->shutdown();
+		thread.join();
+		source->destroy();
+	}
+
+	TestManager   manager;
+	BridgeSource* source;
+	Port          port;
+	Collector     collector;
+	Route         route;
+	std::thread   thread;
+};
+
+/// Create a message with a recognizable payload and metadata.
+///
+/// @param index The index of the message.
+///
+/// @return The message.
+MessagePtr makeMessage(
+	size_t index)
+{
+	auto message = Message::create(index % 700);
+
+	std::memset(message->payload(), static_cast<int>(index & 0xFF), message->size());
+	message->metadata().origin    = 7;
+	message->metadata().sequence  = static_cast<uint32_t>(index + 1);
+	message->metadata().timestamp = 1000 + index;
+
+	return message;
+}
+
+/// Check a message received from the bridge.
+///
+/// @param message The message.
+/// @param index The index of the message.
+void checkMessage(
+	const MessagePtr& message,
+	size_t            index)
+{
+	// The message is stamped by the output port of the source (identifier 1),
+	// not with the origin it had in the other engine.
+	ASSERT_EQ(message->size(), index % 700);
+	EXPECT_EQ(message->metadata().origin, 1);
+	EXPECT_EQ(message->metadata().timestamp, 1000 + index);
+	for (size_t offset = 0; offset < message->size(); ++offset)
+	{
+		ASSERT_EQ(message->payload()[offset], index & 0xFF);
+	}
+}
+
+///
+/// Source that emits the messages built by makeMessage() on its port.
+///
+class EmitterSource :
+	public synapse::framework::Source
+{
+	DECLARE_BLOCK(EmitterSource)
+
+public:
+
+	/// Number of messages emitted by the source.
+	static constexpr size_t COUNT{ 500 };
+
+	/// Constructor.
+	///
+	/// @param name The name of the source.
+	explicit EmitterSource(
+		const std::string& name)
+		: Source(name)
+	{
+	}
+
+	/// Initialize the block before the execution.
+	///
+	/// @param[in] configData The configuration data of the block.
+	/// @param[in] manager The manager of the block.
+	void initialize(
+		const ConfigData& configData,
+		IManager*         manager) override
+	{
+		Source::initialize(configData, manager);
+		_output = manager->find(this, "out");
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData&) override
+	{
+		return { "out" };
+	}
+
+	/// Emit the messages.
+	void run() override
+	{
+		for (size_t index = 0; index < COUNT; ++index)
+		{
+			_output->dispatch(makeMessage(index));
+		}
+	}
+
+private:
+
+	/// The output port.
+	IPort* _output{ nullptr };
+};
+
+IMPLEMENT_BLOCK(EmitterSource)
+
+///
+/// Fiber that records the messages it consumes.
+///
+class CollectorFiber :
+	public synapse::framework::Fiber
+{
+	DECLARE_BLOCK(CollectorFiber)
+
+public:
+
+	/// Constructor.
+	///
+	/// @param name The name of the fiber.
+	explicit CollectorFiber(
+		const std::string& name)
+		: Fiber(name)
+	{
+	}
+
+	/// Ask the block to prepare to be deleted.
+	void shutdown() override {}
+
+	/// Get the list of output ports.
+	std::list<std::string> ports(
+		const IBlock::ConfigData&) override
+	{
+		return {};
+	}
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const MessagePtr& message) override
+	{
+		collector.consume(message);
+	}
+
+	/// The messages consumed.
+	Collector collector;
+};
+
+IMPLEMENT_BLOCK(CollectorFiber)
+
+///
+/// An engine running in its own thread.
+///
+struct RunningEngine
+{
+	/// Constructor.
+	///
+	/// @param config The configuration of the engine.
+	RunningEngine(
+		const nlohmann::json& config)
+	{
+		manager.registry().registerDescription(BridgeSink::description());
+		manager.registry().registerDescription(BridgeSource::description());
+		manager.registry().registerDescription(EmitterSource::description());
+		manager.registry().registerDescription(CollectorFiber::description());
+		manager.initialize(config);
+		thread = std::thread([this] { manager.run(); });
+	}
+
+	/// Destructor.
+	~RunningEngine()
+	{
+		manager.shutdown();
+		thread.join();
+	}
+
+	Manager     manager;
+	std::thread thread;
+};
+
+/// Get the description of a block in a configuration.
+///
+/// @param name The name of the block.
+/// @param className The class of the block.
+/// @param config The configuration of the block.
+///
+/// @return The description of the block.
+nlohmann::json block(
+	const std::string&    name,
+	const std::string&    className,
+	const nlohmann::json& config = nlohmann::json::object())
+{
+	return { { "name", name }, { "className", className }, { "config", config } };
+}
+
+/// Get the description of a route in a configuration.
+///
+/// @param source The source block.
+/// @param destination The destination block.
+///
+/// @return The description of the route.
+nlohmann::json route(
+	const std::string& source,
+	const std::string& destination)
+{
+	return { { "sources", { source } }, { "destinations", { destination } }, { "dispatch", "inline" } };
+}
+
+} // namespace
+
+TEST(Bridge, loopback)
+{
+	static const uint16_t TCP_PORT = 47311;
+	static const size_t   COUNT    = 2000;
+
+	RunningSource source(TCP_PORT);
+	TestManager   manager;
+	auto          sink = static_cast<BridgeSink*>(BridgeSink::create("sink"));
+
+	sink->initialize({ { "host", "127.0.0.1" }, { "port", TCP_PORT }, { "retryDelay", 1 }, { "batchBytes", 8192 }, { "linger", 200 } }, &manager);
+
+	std::thread thread([sink] { sink->run(); });
+
+	for (size_t index = 0; index < COUNT; ++index)
+	{
+		sink->consume(makeMessage(index));
+	}
+
+	// The messages are received in order with their metadata, in batches.
+	ASSERT_TRUE(source.collector.waitFor(COUNT));
+	for (size_t index = 0; index < COUNT; ++index)
+	{
+		checkMessage(source.collector.messages[index], index);
+	}
+	EXPECT_LT(sink->batches(), COUNT / 4);
+	EXPECT_EQ(source.source->duplicates(), 0);
+
+	sink->shutdown();
+	thread.join();
+	sink->destroy();
+}
+
+TEST(Bridge, resume)
+{
+	static const uint16_t TCP_PORT = 47312;
+	static const size_t   COUNT    = 200;
+
+	TestManager manager;
+	auto        sink = static_cast<BridgeSink*>(BridgeSink::create("sink"));
+
+	sink->initialize({ { "host", "127.0.0.1" }, { "port", TCP_PORT }, { "retryDelay", 1 }, { "linger", 0 } }, &manager);
+
+	std::thread thread([sink] { sink->run(); });
+
+	// The messages consumed before the source is started are kept.
+	for (size_t index = 0; index < COUNT / 2; ++index)
+	{
+		sink->consume(makeMessage(index));
+	}
+	{
+		RunningSource source(TCP_PORT);
+
+		ASSERT_TRUE(source.collector.waitFor(COUNT / 2));
+		for (size_t index = 0; index < COUNT / 2; ++index)
+		{
+			checkMessage(source.collector.messages[index], index);
+		}
+	}
+
+	// The messages consumed while the source is restarted are sent again to
+	// the new one.
+	for (size_t index = COUNT / 2; index < COUNT; ++index)
+	{
+		sink->consume(makeMessage(index));
+	}
+	{
+		RunningSource    source(TCP_PORT);
+		std::set<size_t> indexes;
+
+		ASSERT_TRUE(source.collector.waitFor(COUNT / 2));
+		for (auto& message : source.collector.messages)
+		{
+			indexes.insert(message->metadata().timestamp - 1000);
+		}
+		for (size_t index = COUNT / 2; index < COUNT; ++index)
+		{
+			EXPECT_TRUE(indexes.contains(index));
+		}
+	}
+
+	sink->shutdown();
+	thread.join();
+	sink->destroy();
+}
+
+TEST(Bridge, overflow)
+{
+	static const uint16_t TCP_PORT = 47313;
+	static const size_t   WINDOW   = 4;
+	static const size_t   COUNT    = 10;
+
+	TestManager manager;
+	auto        sink = static_cast<BridgeSink*>(BridgeSink::create("sink"));
+
+	sink->initialize({ { "host", "127.0.0.1" }, { "port", TCP_PORT }, { "window", WINDOW }, { "overflow", "drop-newest" } }, &manager);
+
+	// Without a source nothing is acknowledged: the messages that do not fit
+	// in the window are dropped instead of blocking the consumer.
+	for (size_t index = 0; index < COUNT; ++index)
+	{
+		sink->consume(makeMessage(index));
+	}
+	EXPECT_EQ(sink->overflows().dropped, COUNT - WINDOW);
+	EXPECT_EQ(sink->overflows().blocked, 0);
+
+	sink->destroy();
+
+	// An unknown policy is rejected.
+	auto invalid = BridgeSink::create("invalid");
+
+	EXPECT_THROW(invalid->initialize({ { "host", "127.0.0.1" }, { "port", TCP_PORT }, { "overflow", "wait" } }, &manager), std::runtime_error);
+	invalid->destroy();
+}
+
+TEST(Bridge, gap)
+{
+	static const uint16_t TCP_PORT = 47314;
+
+	RunningSource                  source(TCP_PORT);
+	boost::asio::io_context        ioc;
+	boost::asio::ip::tcp::socket   socket(ioc);
+	boost::system::error_code      error;
+
+	for (int attempt = 0; attempt < 100; ++attempt)
+	{
+		socket.connect({ boost::asio::ip::address_v4::loopback(), TCP_PORT }, error);
+		if (!error)
+		{
+			break;
+		}
+		socket.close();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	ASSERT_FALSE(error);
+
+	// Handshake of a new session.
+	std::array<uint8_t, bridge::FRAME_HEADER_SIZE + bridge::CONTROL_BODY_SIZE> control = bridge::controlFrame(bridge::FrameType::hello, 42);
+
+	boost::asio::write(socket, boost::asio::buffer(control));
+	boost::asio::read(socket, boost::asio::buffer(control));
+	EXPECT_EQ(bridge::get<uint64_t>(control.data() + bridge::FRAME_HEADER_SIZE), 0);
+
+	// A batch that starts after the next expected message closes the connection.
+	std::vector<uint8_t> frame(bridge::FRAME_HEADER_SIZE + bridge::BATCH_HEADER_SIZE + bridge::RECORD_HEADER_SIZE);
+
+	bridge::putFrameHeader(frame.data(), bridge::FrameType::batch, frame.size() - bridge::FRAME_HEADER_SIZE);
+	bridge::put<uint32_t>(frame.data() + bridge::FRAME_HEADER_SIZE + 8, 1);
+	for (uint64_t first : { 1, 5 })
+	{
+		bridge::put<uint64_t>(frame.data() + bridge::FRAME_HEADER_SIZE, first);
+		boost::asio::write(socket, boost::asio::buffer(frame));
+	}
+
+	// The acknowledgement of the first batch, then the end of the connection.
+	boost::asio::read(socket, boost::asio::buffer(control));
+	EXPECT_EQ(bridge::get<uint64_t>(control.data() + bridge::FRAME_HEADER_SIZE), 1);
+	boost::asio::read(socket, boost::asio::buffer(control), error);
+	EXPECT_EQ(error, boost::asio::error::eof);
+	EXPECT_EQ(source.collector.messages.size(), 1);
+}
+
+TEST(Bridge, engines)
+{
+	static const uint16_t TCP_PORT = 47315;
+
+	// The receiving engine: a bridge source routed to a collector.
+	RunningEngine receiver({ { "blocks", { block("bridge", BridgeSource::description()._className, { { "host", "127.0.0.1" }, { "port", TCP_PORT } }),
+										   block("collector", CollectorFiber::description()._className) } },
+							 { "routes", { route("bridge", "collector") } } });
+
+	// The sending engine: an emitter routed to a bridge sink.
+	RunningEngine sender({ { "blocks", { block("emitter", EmitterSource::description()._className),
+										 block("bridge", BridgeSink::description()._className, { { "host", "127.0.0.1" }, { "port", TCP_PORT }, { "retryDelay", 1 } }) } },
+						   { "routes", { route("emitter", "bridge") } } });
+
+	// The messages cross from one engine to the other in order, stamped by
+	// the output port of the bridge source.
+	auto  collector = dynamic_cast<CollectorFiber*>(receiver.manager.find("collector"));
+	auto  output    = dynamic_cast<Port*>(receiver.manager.find(receiver.manager.find("bridge"), "default"));
+	auto& received  = collector->collector;
+
+	ASSERT_EQ(output->id(), 1);
+	ASSERT_TRUE(received.waitFor(EmitterSource::COUNT));
+
+	std::lock_guard lock(received.mutex);
+
+	ASSERT_EQ(received.messages.size(), EmitterSource::COUNT);
+	for (size_t index = 0; index < EmitterSource::COUNT; ++index)
+	{
+		checkMessage(received.messages[index], index);
+	}
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
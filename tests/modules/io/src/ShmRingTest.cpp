@@ -0,0 +1,163 @@
+///
+/// @file ShmRingTest.cpp
+///
+/// Unit testing of the ShmRing class.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "ShmRing.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+namespace {
+
+/// Get a segment name of its own to the test process.
+///
+/// @param test The name of the test.
+///
+/// @return The name of the segment.
+std::string segmentName(
+	const std::string& test)
+{
+	return "synapse-test-" + test + "-" + std::to_string(getpid());
+}
+
+} // namespace
+
+TEST(ShmRing, writeRead)
+{
+	auto name = segmentName("write-read");
+
+	{
+		ShmRing writer(name, 256);
+		ShmRing reader(name, 256);
+
+		EXPECT_EQ(reader.front(), nullptr);
+
+		// The record is written in place then published.
+		auto record = writer.reserve(5);
+
+		ASSERT_NE(record, nullptr);
+		std::memcpy(record->payload(), "hello", 5);
+		record->timestamp = 42;
+		EXPECT_EQ(reader.front(), nullptr);
+		writer.commit();
+
+		auto received = reader.front();
+
+		ASSERT_NE(received, nullptr);
+		EXPECT_EQ(received->size, 5);
+		EXPECT_EQ(received->timestamp, 42);
+		EXPECT_EQ(std::string(reinterpret_cast<const char*>(received->payload()), 5), "hello");
+		reader.pop();
+		EXPECT_EQ(reader.front(), nullptr);
+
+		// Another capacity is rejected.
+		EXPECT_THROW(ShmRing(name, 512), std::runtime_error);
+		EXPECT_THROW(writer.reserve(writer.maxPayload() + 1), std::length_error);
+	}
+	ShmRing::remove(name);
+
+	EXPECT_THROW(ShmRing(name, 100), std::invalid_argument);
+
+	// A capacity too small is not reported as a capacity that is not a power of 2.
+	try
+	{
+		ShmRing(name, 16);
+		FAIL();
+	}
+	catch (const std::invalid_argument& error)
+	{
+		EXPECT_NE(std::string(error.what()).find("at least"), std::string::npos);
+	}
+}
+
+TEST(ShmRing, full)
+{
+	auto name = segmentName("full");
+
+	{
+		ShmRing writer(name, 128);
+		ShmRing reader(name, 128);
+		size_t  count = 0;
+
+		// Records of 24 bytes (16 + 8): the ring holds 5 of them.
+		while (auto record = writer.reserve(8))
+		{
+			std::memcpy(record->payload(), &count, sizeof(count));
+			writer.commit();
+			++count;
+		}
+		EXPECT_EQ(count, 5);
+
+		// The room is given back when the reader releases a record.
+		reader.front();
+		reader.pop();
+		EXPECT_NE(writer.reserve(8), nullptr);
+	}
+	ShmRing::remove(name);
+}
+
+TEST(ShmRing, wrapAround)
+{
+	static const size_t COUNT = 20000;
+
+	auto name = segmentName("wrap-around");
+
+	{
+		ShmRing writer(name, 1024);
+		ShmRing reader(name, 1024);
+
+		// Records of various sizes cross the end of the ring many times.
+		std::thread producer([&writer] {
+			for (size_t index = 0; index < COUNT; ++index)
+			{
+				size_t           size = 1 + index % 97;
+				ShmRing::Record* record;
+
+				while ((record = writer.reserve(size)) == nullptr)
+				{
+					std::this_thread::yield();
+				}
+				std::memset(record->payload(), static_cast<int>(index & 0xFF), size);
+				record->timestamp = index;
+				writer.commit();
+			}
+		});
+
+		for (size_t index = 0; index < COUNT; ++index)
+		{
+			ShmRing::Record* record;
+
+			while ((record = reader.front()) == nullptr)
+			{
+				std::this_thread::yield();
+			}
+			ASSERT_EQ(record->timestamp, index);
+			ASSERT_EQ(record->size, 1 + index % 97);
+			for (size_t offset = 0; offset < record->size; ++offset)
+			{
+				ASSERT_EQ(record->payload()[offset], index & 0xFF);
+			}
+			reader.pop();
+		}
+		producer.join();
+	}
+	ShmRing::remove(name);
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
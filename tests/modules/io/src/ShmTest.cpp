@@ -0,0 +1,210 @@
+///
+/// @file ShmTest.cpp
+///
+/// Unit testing of the ShmSink and ShmSource classes.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <synapse/framework/Message.h>
+#include <synapse/framework/Port.h>
+#include <synapse/framework/Route.h>
+
+#include "ShmRing.h"
+#include "ShmSink.h"
+#include "ShmSource.h"
+#include "TestBlocks.h"
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+namespace {
+
+using synapse::framework::Message;
+using synapse::framework::MessagePtr;
+using synapse::framework::Port;
+using synapse::framework::Route;
+
+/// Get a segment name of its own to the test process.
+///
+/// @param test The name of the test.
+///
+/// @return The name of the segment.
+std::string segmentName(
+	const std::string& test)
+{
+	return "synapse-test-" + test + "-" + std::to_string(getpid());
+}
+
+/// Create a message with a recognizable payload.
+///
+/// @param index The index of the message.
+///
+/// @return The message.
+MessagePtr makeMessage(
+	size_t index)
+{
+	auto message = Message::create(8);
+
+	std::memcpy(message->payload(), &index, sizeof(index));
+	message->metadata().timestamp = 1000 + index;
+
+	return message;
+}
+
+/// Wait until a condition is met.
+///
+/// @param condition The condition.
+///
+/// @return true if the condition is met in time.
+template <typename Condition>
+bool waitUntil(
+	Condition condition)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (!condition())
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+		{
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+} // namespace
+
+TEST(Shm, loopback)
+{
+	static const size_t COUNT = 2000;
+
+	auto        segment = segmentName("loopback");
+	TestManager manager;
+	Collector   collector;
+	auto        source = static_cast<ShmSource*>(ShmSource::create("source"));
+	Port        port("default", source, 1);
+	Route       route({ &port }, { &collector }, nullptr);
+	auto        sink = static_cast<ShmSink*>(ShmSink::create("sink"));
+
+	port.attach(&route);
+	manager.port = &port;
+	source->initialize({ { "segment", segment }, { "capacity", 1024 } }, &manager);
+	sink->initialize({ { "segment", segment }, { "capacity", 1024 } }, &manager);
+
+	std::thread reader([source] { source->run(); });
+	std::thread writer([sink] { sink->run(); });
+
+	// The ring is much smaller than the messages: the sink waits for the source.
+	for (size_t index = 0; index < COUNT; ++index)
+	{
+		sink->consume(makeMessage(index));
+	}
+
+	// The messages are received in order with their timestamp.
+	ASSERT_TRUE(collector.waitFor(COUNT));
+	for (size_t index = 0; index < COUNT; ++index)
+	{
+		auto& message = collector.messages[index];
+
+		ASSERT_EQ(message->size(), sizeof(index));
+		EXPECT_EQ(*reinterpret_cast<const size_t*>(message->payload()), index);
+		EXPECT_EQ(message->metadata().timestamp, 1000 + index);
+	}
+	EXPECT_EQ(sink->dropped(), 0);
+
+	sink->shutdown();
+	writer.join();
+	source->shutdown();
+	reader.join();
+	sink->destroy();
+	source->destroy();
+	ShmRing::remove(segment);
+}
+
+TEST(Shm, readerAbsent)
+{
+	static const size_t COUNT = 20;
+
+	auto        segment = segmentName("reader-absent");
+	TestManager manager;
+	auto        sink = static_cast<ShmSink*>(ShmSink::create("sink"));
+
+	// The ring holds 5 records of 8 bytes.
+	sink->initialize({ { "segment", segment }, { "capacity", 128 }, { "timeout", 50 } }, &manager);
+
+	std::thread writer([sink] { sink->run(); });
+	auto        start = std::chrono::steady_clock::now();
+
+	for (size_t index = 0; index < COUNT; ++index)
+	{
+		sink->consume(makeMessage(index));
+	}
+
+	// Without a reader the sink waits once for the timeout, then drops the
+	// messages at once.
+	ASSERT_TRUE(waitUntil([sink] { return sink->dropped() == COUNT - 5; }));
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+	// The messages are written again as soon as the reader frees room.
+	{
+		ShmRing reader(segment, 128);
+
+		for (size_t index = 0; index < 5; ++index)
+		{
+			ASSERT_NE(reader.front(), nullptr);
+			EXPECT_EQ(reader.front()->timestamp, 1000 + index);
+			reader.pop();
+		}
+		sink->consume(makeMessage(COUNT));
+		ASSERT_TRUE(waitUntil([&reader] { return reader.front() != nullptr; }));
+		EXPECT_EQ(reader.front()->timestamp, 1000 + COUNT);
+	}
+	EXPECT_EQ(sink->dropped(), COUNT - 5);
+
+	sink->shutdown();
+	writer.join();
+	sink->destroy();
+	ShmRing::remove(segment);
+}
+
+TEST(Shm, tooLarge)
+{
+	auto        segment = segmentName("too-large");
+	TestManager manager;
+	auto        sink = static_cast<ShmSink*>(ShmSink::create("sink"));
+
+	sink->initialize({ { "segment", segment }, { "capacity", 128 } }, &manager);
+
+	std::thread writer([sink] { sink->run(); });
+	ShmRing     reader(segment, 128);
+
+	// A message larger than a record of the ring is dropped, the next ones
+	// are written.
+	sink->consume(Message::create(reader.maxPayload() + 1));
+	sink->consume(makeMessage(1));
+
+	ASSERT_TRUE(waitUntil([&reader] { return reader.front() != nullptr; }));
+	EXPECT_EQ(reader.front()->timestamp, 1001);
+	EXPECT_EQ(sink->dropped(), 1);
+
+	sink->shutdown();
+	writer.join();
+	sink->destroy();
+	ShmRing::remove(segment);
+}
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
@@ -0,0 +1,108 @@
+///
+/// @file TestBlocks.h
+///
+/// Declaration of the manager and the consumer shared by the unit tests of the
+/// IO module.
+///
+/// @author Xavier Caroff <xavier.caroff@free.fr>
+/// @copyright Copyright (c) 2024, Xavier Caroff
+///
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <synapse/framework/IConsumer.h>
+#include <synapse/framework/IManager.h>
+#include <synapse/framework/MessagePtr.h>
+#include <synapse/framework/Port.h>
+
+namespace synapse {
+namespace modules {
+namespace io {
+
+///
+/// Manager that only knows the output port of a source.
+///
+class TestManager :
+	public synapse::framework::IManager
+{
+public:
+
+	/// Create a block from its class name.
+	synapse::framework::IBlock* create(
+		const std::string&,
+		const std::string&) override
+	{
+		throw std::logic_error("not supported");
+	}
+
+	/// Find a block from its name.
+	synapse::framework::IBlock* find(
+		const std::string&) const override
+	{
+		return nullptr;
+	}
+
+	/// Find a port from its block and class name.
+	synapse::framework::IPort* find(
+		synapse::framework::IBlock*,
+		const std::string&) const override
+	{
+		return port;
+	}
+
+	/// The output port of the source.
+	synapse::framework::Port* port{ nullptr };
+};
+
+///
+/// Consumer that records the messages.
+///
+class Collector :
+	public synapse::framework::IConsumer
+{
+public:
+
+	/// Consume a message.
+	///
+	/// @param message[in] Message to be consumed.
+	void consume(
+		const synapse::framework::MessagePtr& message) override
+	{
+		std::lock_guard lock(mutex);
+
+		messages.push_back(message);
+		received.notify_all();
+	}
+
+	/// Wait for a number of messages.
+	///
+	/// @param count The number of messages.
+	///
+	/// @return true if the messages are received in time.
+	bool waitFor(
+		size_t count)
+	{
+		std::unique_lock lock(mutex);
+
+		return received.wait_for(lock, std::chrono::seconds(10), [&] { return messages.size() >= count; });
+	}
+
+	/// Protect the messages.
+	std::mutex                                  mutex;
+
+	/// Signaled when a message is received.
+	std::condition_variable                     received;
+
+	/// The messages received.
+	std::vector<synapse::framework::MessagePtr> messages;
+};
+
+} // namespace io
+} // namespace modules
+} // namespace synapse
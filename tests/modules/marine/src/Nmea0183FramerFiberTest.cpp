@@ -17,6 +17,58 @@ namespace synapse {
 namespace modules {
 namespace marine {
 
+namespace {
+
+///
+/// Port that records the messages dispatched.
+///
+class FakePort :
+	public synapse::framework::IPort
+{
+public:
+
+	void dispatch(
+		const synapse::framework::MessagePtr& message) override final
+	{
+		messages.push_back(message);
+	}
+
+	std::list<synapse::framework::MessagePtr> messages;
+};
+
+///
+/// Manager that gives the fake port to the block.
+///
+class FakeManager :
+	public synapse::framework::IManager
+{
+public:
+
+	synapse::framework::IBlock* create(
+		const std::string&,
+		const std::string&) override final
+	{
+		return nullptr;
+	}
+
+	synapse::framework::IBlock* find(
+		const std::string&) const override final
+	{
+		return nullptr;
+	}
+
+	synapse::framework::IPort* find(
+		synapse::framework::IBlock*,
+		const std::string&) const override final
+	{
+		return std::addressof(port);
+	}
+
+	mutable FakePort port;
+};
+
+} // namespace
+
 TEST(Nmea0183FramerFiber, findFrame)
 {
 	// clang-format off
@@ -133,48 +185,6 @@ TEST(Nmea0183FramerFiber, findFrame)
 
 TEST(Nmea0183FramerFiber, consume)
 {
-	class FakePort :
-		public synapse::framework::IPort
-	{
-	public:
-
-		void dispatch(
-			const std::shared_ptr<synapse::framework::Message>& message) override final
-		{
-			messages.push_back(message);
-		}
-
-		std::list<std::shared_ptr<synapse::framework::Message>> messages;
-	};
-
-	class FakeManager :
-		public synapse::framework::IManager
-	{
-	public:
-
-		synapse::framework::IBlock* create(
-			const std::string&,
-			const std::string&) override final
-		{
-			return nullptr;
-		}
-
-		synapse::framework::IBlock* find(
-			const std::string&) const override final
-		{
-			return nullptr;
-		}
-
-		synapse::framework::IPort* find(
-			synapse::framework::IBlock*,
-			const std::string&) const override final
-		{
-			return std::addressof(port);
-		}
-
-		mutable FakePort port;
-	};
-
 	static const size_t                   BLOCK_SIZE = 20;
 	static const std::vector<std::string> DATA       = {
         "$SDDBT,38.0,f,11.6,M,06.3,F*3E\r\n",                                               // 1
@@ -226,10 +236,81 @@ TEST(Nmea0183FramerFiber, consume)
 		object->consume(msg);
 	}
 
+	ASSERT_EQ(manager.port.messages.size(), DATA.size());
+
+	// The frames are complete, whether they are copied or sliced.
+	auto frame = manager.port.messages.begin();
+
+	for (const auto& sentence : DATA)
+	{
+		EXPECT_EQ(std::string((*frame)->payload(), (*frame)->payload() + (*frame)->size()), sentence);
+		++frame;
+	}
+
+	// Frames that lie inside a message are forwarded without copy.
+	auto pair  = DATA[0] + DATA[5];
+	auto whole = synapse::framework::Message::create(pair.size(), (uint8_t*) pair.data());
+
+	object->consume(whole);
+
+	ASSERT_EQ(manager.port.messages.size(), DATA.size() + 2);
+
+	auto second = manager.port.messages.back();
+	manager.port.messages.pop_back();
+	auto first = manager.port.messages.back();
+
+	EXPECT_EQ(first->size(), DATA[0].size());
+	EXPECT_EQ(first->payload(), whole->payload());
+	EXPECT_EQ(second->size(), DATA[5].size());
+	EXPECT_EQ(second->payload(), whole->payload() + DATA[0].size());
+
 	object->destroy();
 	object = nullptr;
+}
+
+
+TEST(Nmea0183FramerFiber, straddle)
+{
+	static const std::vector<std::string> DATA = {
+		"$SDDBT,38.0,f,11.6,M,06.3,F*3E\r\n",
+		"$SDDPT,11.6,-1.0,99.0*7F\r\n",
+		"$HCHDG,331.3,00.0,E,00.0,E*40\r\n",
+	};
+
+	Nmea0183FramerFiber* object = dynamic_cast<Nmea0183FramerFiber*>(Nmea0183FramerFiber::create("object"));
+	FakeManager          manager;
+
+	object->initialize(nlohmann::json::object(), std::addressof(manager));
+
+	// The reads split the sentences, the second one between \r and \n.
+	auto all   = std::accumulate(DATA.begin(), DATA.end(), std::string{});
+	auto split = { size_t{ 10 }, DATA[0].size() + DATA[1].size() - 1, all.size() };
+	auto begin = size_t{ 0 };
+
+	std::vector<synapse::framework::MessagePtr> reads;
+
+	for (auto end : split)
+	{
+		reads.push_back(synapse::framework::Message::create(end - begin, (uint8_t*) all.data() + begin));
+		object->consume(reads.back());
+		begin = end;
+	}
 
-	EXPECT_EQ(manager.port.messages.size(), DATA.size());
+	ASSERT_EQ(manager.port.messages.size(), DATA.size());
+
+	std::vector<synapse::framework::MessagePtr> frames(manager.port.messages.begin(), manager.port.messages.end());
+
+	for (size_t index = 0; index < DATA.size(); ++index)
+	{
+		EXPECT_EQ(std::string(frames[index]->payload(), frames[index]->payload() + frames[index]->size()), DATA[index]);
+	}
+
+	// Only the frames that straddle two reads are copied, the one that lies
+	// after the straddling frame shares the payload of its read.
+	EXPECT_EQ(frames[2]->payload(), reads[2]->payload() + 1);
+
+	object->destroy();
+	object = nullptr;
 }
 
 } // namespace marine